@@ -32,6 +32,8 @@
 #include "main/thread.h"
 #include "utils/util.h"
 
+#include "inflate_pool.h"
+
 #ifdef UNIT_TEST
 #include "catch/catch.hpp"
 #endif
@@ -913,24 +915,19 @@ static fd_status_t Init_Stream(fd_session_p_t SessionPtr)
     {
     case FILE_COMPRESSION_TYPE_DEFLATE:
     {
-        int z_ret;
+        /* Window bits 47 selects automatic zlib or gzip header detection */
+        z_stream* z_s = InflatePool::acquire(47);
 
-        z_stream* z_s = &(StPtr->PDF_Decomp_State.Deflate.StreamDeflate);
+        StPtr->PDF_Decomp_State.Deflate.StreamDeflate = z_s;
 
-        memset( (char*)z_s, 0, sizeof(z_stream));
-
-        z_s->zalloc = (alloc_func)NULL;
-        z_s->zfree = (free_func)NULL;
-        SYNC_IN(z_s)
-
-        z_ret = inflateInit2(z_s, 47);
-
-        if ( z_ret != Z_OK )
+        if ( z_s == NULL )
         {
             File_Decomp_Alert(SessionPtr, FILE_DECOMP_ERR_PDF_DEFL_FAILURE);
             return( File_Decomp_Error );
         }
 
+        SYNC_IN(z_s)
+
         break;
     }
     default:
@@ -956,7 +953,7 @@ static fd_status_t Decomp_Stream(fd_session_p_t SessionPtr)
     case FILE_COMPRESSION_TYPE_DEFLATE:
     {
         int z_ret;
-        z_stream* z_s = &(StPtr->PDF_Decomp_State.Deflate.StreamDeflate);
+        z_stream* z_s = StPtr->PDF_Decomp_State.Deflate.StreamDeflate;
 
         SYNC_IN(z_s)
 
@@ -1015,17 +1012,18 @@ fd_status_t File_Decomp_End_PDF(fd_session_p_t SessionPtr)
     {
     case FILE_COMPRESSION_TYPE_DEFLATE:
     {
-        int z_ret;
-        z_stream* z_s = &(StPtr->PDF_Decomp_State.Deflate.StreamDeflate);
+        z_stream* z_s = StPtr->PDF_Decomp_State.Deflate.StreamDeflate;
 
-        z_ret = inflateEnd(z_s);
-
-        if ( z_ret != Z_OK )
+        /* The stream is absent if Init_Stream() failed */
+        if ( z_s == NULL )
         {
             File_Decomp_Alert(SessionPtr, FILE_DECOMP_ERR_PDF_DEFL_FAILURE);
             return( File_Decomp_Error );
         }
 
+        InflatePool::release(z_s);
+        StPtr->PDF_Decomp_State.Deflate.StreamDeflate = NULL;
+
         break;
     }
     default:
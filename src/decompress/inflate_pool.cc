@@ -0,0 +1,177 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// inflate_pool.cc
+
+#include "inflate_pool.h"
+
+#include "main/thread.h"
+#include "utils/util.h"
+
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#endif
+
+// Each pooled stream holds about 40K so keep this modest
+#define MAX_POOLED 16
+
+static THREAD_LOCAL z_stream* pooled[MAX_POOLED];
+static THREAD_LOCAL unsigned num_pooled = 0;
+
+z_stream* InflatePool::acquire(int window_bits, bool* reused)
+{
+    while ( num_pooled > 0 )
+    {
+        z_stream* z_s = pooled[--num_pooled];
+
+        // The window is kept unless its size changes
+        if ( inflateReset2(z_s, window_bits) == Z_OK )
+        {
+            z_s->next_in = Z_NULL;
+            z_s->avail_in = 0;
+            z_s->total_in = 0;
+            z_s->total_out = 0;
+
+            if ( reused )
+                *reused = true;
+
+            return z_s;
+        }
+        inflateEnd(z_s);
+        snort_free(z_s);
+    }
+
+    z_stream* z_s = (z_stream*)snort_calloc(sizeof(z_stream));
+    z_s->zalloc = Z_NULL;
+    z_s->zfree = Z_NULL;
+    z_s->next_in = Z_NULL;
+    z_s->avail_in = 0;
+
+    if ( inflateInit2(z_s, window_bits) != Z_OK )
+    {
+        snort_free(z_s);
+        return nullptr;
+    }
+
+    if ( reused )
+        *reused = false;
+
+    return z_s;
+}
+
+void InflatePool::release(z_stream* z_s)
+{
+    if ( !z_s )
+        return;
+
+    if ( num_pooled < MAX_POOLED )
+    {
+        pooled[num_pooled++] = z_s;
+        return;
+    }
+    inflateEnd(z_s);
+    snort_free(z_s);
+}
+
+void InflatePool::tterm()
+{
+    while ( num_pooled > 0 )
+    {
+        z_stream* z_s = pooled[--num_pooled];
+        inflateEnd(z_s);
+        snort_free(z_s);
+    }
+}
+
+//--------------------------------------------------------------------------
+// unit tests
+//--------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+static const char* const inflate_pool_text =
+    "the quick brown fox jumps over the lazy dog the quick brown fox jumps over the lazy dog";
+
+static uLong inflate_pool_deflate(uint8_t* out, uLong size, int window_bits)
+{
+    z_stream d_s;
+    memset(&d_s, 0, sizeof(d_s));
+    REQUIRE(deflateInit2(&d_s, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8,
+        Z_DEFAULT_STRATEGY) == Z_OK);
+    d_s.next_in = (Bytef*)inflate_pool_text;
+    d_s.avail_in = strlen(inflate_pool_text);
+    d_s.next_out = out;
+    d_s.avail_out = size;
+    REQUIRE(deflate(&d_s, Z_FINISH) == Z_STREAM_END);
+    uLong length = d_s.total_out;
+    deflateEnd(&d_s);
+    return length;
+}
+
+static void inflate_pool_check(z_stream* z_s, uint8_t* in, uLong length)
+{
+    uint8_t out[256];
+    z_s->next_in = in;
+    z_s->avail_in = length;
+    z_s->next_out = out;
+    z_s->avail_out = sizeof(out);
+    REQUIRE(inflate(z_s, Z_SYNC_FLUSH) == Z_STREAM_END);
+    REQUIRE(z_s->total_out == strlen(inflate_pool_text));
+    REQUIRE(memcmp(out, inflate_pool_text, z_s->total_out) == 0);
+}
+
+TEST_CASE("InflatePool-reuse", "[inflate_pool]")
+{
+    uint8_t gzip[256];
+    uint8_t deflate[256];
+    uLong gzip_len = inflate_pool_deflate(gzip, sizeof(gzip), 31);
+    uLong deflate_len = inflate_pool_deflate(deflate, sizeof(deflate), 15);
+
+    bool reused = true;
+    z_stream* first = InflatePool::acquire(31, &reused);
+    REQUIRE(first != nullptr);
+    CHECK(!reused);
+    inflate_pool_check(first, gzip, gzip_len);
+    InflatePool::release(first);
+
+    // Same stream comes back reset and can switch from gzip to zlib format
+    z_stream* second = InflatePool::acquire(15, &reused);
+    CHECK(second == first);
+    CHECK(reused);
+    CHECK(second->total_in == 0);
+    inflate_pool_check(second, deflate, deflate_len);
+
+    // A stream abandoned mid-inflate is reset cleanly
+    second->next_in = gzip;
+    second->avail_in = 2;
+    InflatePool::release(second);
+    z_stream* third = InflatePool::acquire(31);
+    CHECK(third == first);
+    inflate_pool_check(third, gzip, gzip_len);
+    InflatePool::release(third);
+
+    InflatePool::release(nullptr);
+    InflatePool::tterm();
+    z_stream* fourth = InflatePool::acquire(31, &reused);
+    CHECK(!reused);
+    InflatePool::release(fourth);
+    InflatePool::tterm();
+}
+
+#endif
+
@@ -0,0 +1,51 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// inflate_pool.h
+
+#ifndef INFLATE_POOL_H
+#define INFLATE_POOL_H
+
+// Per-thread pool of initialized zlib inflate streams. Creating a stream allocates zlib's state
+// and, on first use, a 32K window. Streams released to the pool keep both and are prepared for
+// the next user with inflateReset2() which is far cheaper than inflateEnd() plus inflateInit2().
+//
+// The pool uses only the standard zlib API so a compatible implementation such as zlib-ng in
+// zlib compat mode can be substituted at build time by linking against it instead of zlib.
+
+#include <zlib.h>
+
+#include "main/snort_types.h"
+
+class SO_PUBLIC InflatePool
+{
+public:
+    // Returns a stream ready for inflate() with the given window bits (as for inflateInit2()) or
+    // nullptr if zlib could not provide one. If reused is not null it is set to whether the
+    // stream came from the pool.
+    static z_stream* acquire(int window_bits, bool* reused = nullptr);
+
+    // Give back a stream obtained from acquire(). Null is ignored.
+    static void release(z_stream*);
+
+    // Free the streams held by the current thread
+    static void tterm();
+};
+
+#endif
+
@@ -32,6 +32,8 @@
 #include "config.h"
 #endif
 
+#include <vector>
+
 #include "detection_defines.h"
 #include "detection_util.h"
 #include "treenodes.h"
@@ -345,8 +347,9 @@ int detection_option_node_evaluate(
     if ( !node )
         return 0;
 
-    auto& state = node->state[get_instance_id()];
-    RuleContext profile(state);
+    auto& state = node->get_state(get_instance_id());
+    dot_node_profile_t* stats = node->get_profile(get_instance_id());
+    RuleContext profile(stats);
 
     int result = 0;
     int rval = DETECTION_OPTION_NO_MATCH;
@@ -566,7 +569,7 @@ int detection_option_node_evaluate(
                         node->children[i];
 
                     dot_node_state_t* child_state =
-                        child_node->state + get_instance_id();
+                        &child_node->get_state(get_instance_id());
 
                     for ( int j = 0; j < NUM_BYTE_EXTRACT_VARS; ++j )
                         SetByteExtractValue(tmp_byte_extract_vars[j], (int8_t)j);
@@ -671,8 +674,8 @@ int detection_option_node_evaluate(
 
         // We're essentially checking this node again and it potentially
         // might match again
-        if ( continue_loop )
-            state.checks++;
+        if ( continue_loop and stats )
+            stats->checks++;
 
         loop_count++;
     }
@@ -722,10 +725,11 @@ static void detection_option_node_update_otn_stats(detection_option_tree_node_t*
 
     for ( unsigned i = 0; i < ThreadConfig::get_instance_max(); ++i )
     {
-        node_stats.elapsed += node->state[i].elapsed;
-        node_stats.elapsed_match += node->state[i].elapsed_match;
-        node_stats.elapsed_no_match += node->state[i].elapsed_no_match;
-        node_stats.checks += node->state[i].checks;
+        auto* ns = node->get_profile(i);
+        node_stats.elapsed += ns->elapsed;
+        node_stats.elapsed_match += ns->elapsed_match;
+        node_stats.elapsed_no_match += ns->elapsed_no_match;
+        node_stats.checks += ns->checks;
     }
 
     if ( stats )
@@ -790,15 +794,20 @@ void detection_option_tree_update_otn_stats(SFXHASH* doth)
         auto* node = (detection_option_tree_node_t*)hnode->data;
         assert(node);
 
+        // all nodes of a tree have profiles or none do
+        if ( !node->profile )
+            continue;
+
         uint64_t checks = 0;
         uint64_t timeouts = 0;
         uint64_t suspends = 0;
 
         for ( unsigned i = 0; i < ThreadConfig::get_instance_max(); ++i )
         {
-            checks += node->state[i].checks;
-            timeouts += node->state[i].latency_timeouts;
-            suspends += node->state[i].latency_suspends;
+            auto* ns = node->get_profile(i);
+            checks += ns->checks;
+            timeouts += ns->latency_timeouts;
+            suspends += ns->latency_suspends;
         }
 
         if ( checks )
@@ -842,12 +851,20 @@ detection_option_tree_node_t* new_node(
 
     p->state = (dot_node_state_t*)
         snort_calloc(ThreadConfig::get_instance_max(), sizeof(*p->state));
+    p->state_stride = 1;
 
     return p;
 }
 
 void free_detection_option_tree(detection_option_tree_node_t* node)
 {
+    if ( node->arena )
+    {
+        snort_free(node->arena);
+        snort_free(node);
+        return;
+    }
+
     int i;
     for (i=0; i<node->num_children; i++)
     {
@@ -858,3 +875,95 @@ void free_detection_option_tree(detection_option_tree_node_t* node)
     snort_free(node);
 }
 
+//-------------------------------------------------------------------------
+// compaction
+//-------------------------------------------------------------------------
+
+// the top node is kept in place since roots and the tree hash point to it.
+// all the others are moved into the arena and the originals are freed.
+// states are not copied since nothing has been evaluated yet.
+static void compact_tree(detection_option_tree_node_t* top, bool profile)
+{
+    std::vector<detection_option_tree_node_t*> bfs;
+    bfs.push_back(top);
+
+    for ( unsigned i = 0; i < bfs.size(); ++i )
+    {
+        detection_option_tree_node_t* node = bfs[i];
+
+        for ( int j = 0; j < node->num_children; ++j )
+            bfs.push_back(node->children[j]);
+    }
+
+    const unsigned num = bfs.size();
+    const unsigned line = 64;
+    const unsigned instances = ThreadConfig::get_instance_max();
+
+    // round the per thread rows up so each row starts on a cache line
+    unsigned stride = num;
+
+    while ( (stride * sizeof(dot_node_state_t)) % line or
+        (profile and (stride * sizeof(dot_node_profile_t)) % line) )
+        ++stride;
+
+    size_t node_size = (num - 1) * sizeof(detection_option_tree_node_t);
+    size_t child_size = (num - 1) * sizeof(detection_option_tree_node_t*);
+    size_t state_size = (size_t)instances * stride * sizeof(dot_node_state_t);
+    size_t profile_size = profile ? (size_t)instances * stride * sizeof(dot_node_profile_t) : 0;
+
+    uint8_t* arena = (uint8_t*)snort_calloc(
+        node_size + child_size + state_size + profile_size + line);
+
+    detection_option_tree_node_t* nodes = (detection_option_tree_node_t*)arena;
+    detection_option_tree_node_t** kids = (detection_option_tree_node_t**)(arena + node_size);
+
+    uintptr_t base = (uintptr_t)(arena + node_size + child_size);
+    base = (base + line - 1) & ~(uintptr_t)(line - 1);
+    dot_node_state_t* states = (dot_node_state_t*)base;
+
+    dot_node_profile_t* profiles = profile ?
+        (dot_node_profile_t*)(base + state_size) : nullptr;
+
+    // children of each node have consecutive bfs indices, starting at 1
+    unsigned next = 1;
+
+    for ( unsigned i = 0; i < num; ++i )
+    {
+        detection_option_tree_node_t* old = bfs[i];
+        detection_option_tree_node_t* node = i ? nodes + i - 1 : top;
+
+        if ( i )
+            *node = *old;
+
+        snort_free(old->children);
+        snort_free(old->state);
+
+        node->children = node->num_children ? kids + next - 1 : nullptr;
+        node->state = states + i;
+        node->profile = profiles ? profiles + i : nullptr;
+        node->state_stride = stride;
+
+        for ( int j = 0; j < node->num_children; ++j, ++next )
+            kids[next - 1] = nodes + next - 1;
+
+        if ( i )
+            snort_free(old);
+    }
+    top->arena = arena;
+}
+
+// profiles are only allocated if needed by the rule profiler or latency
+void detection_option_tree_compact(SFXHASH* doth, bool profile)
+{
+    if ( !doth )
+        return;
+
+    for ( auto hnode = sfxhash_findfirst(doth); hnode; hnode = sfxhash_findnext(doth) )
+    {
+        auto* node = (detection_option_tree_node_t*)hnode->data;
+
+        if ( !node->arena )
+            compact_tree(node, profile);
+    }
+}
+
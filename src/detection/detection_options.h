@@ -30,6 +30,12 @@
 // These trees are instantiated at parse time, one per MPSE match state.
 // Eval, profiling, and latency data are attached in an array sized per max
 // packet threads.
+//
+// Once all trees are built they are compacted so that each tree lives in a
+// single block: nodes in breadth first order so that siblings are adjacent,
+// then the child pointer arrays in the same order, then the node states with
+// all states of one packet thread together on their own cache lines.  The
+// profiles are allocated the same way, after the states, when profiling.
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -58,21 +64,24 @@ struct dot_node_state_t
         char result;
         char flowbit_failed;
     } last_check;
+};
 
-    // FIXIT-L perf profiler stuff should be factored of the node state struct
+// profiler and latency counters, also per packet thread.  these are kept
+// apart from the node state and only allocated if rule profiling or rule
+// latency is configured.
+struct dot_node_profile_t
+{
     hr_duration elapsed;
     hr_duration elapsed_match;
     hr_duration elapsed_no_match;
     uint64_t checks;
-    uint64_t disables;
 
     unsigned latency_timeouts;
     unsigned latency_suspends;
 
-    // FIXIT-L perf profiler stuff should be factored of the node state struct
     void update(hr_duration delta, bool match)
     {
-        elapsed += delta;;
+        elapsed += delta;
 
         if ( match )
             elapsed_match += delta;
@@ -92,7 +101,20 @@ struct detection_option_tree_node_t
     void* option_data;
     option_type_t option_type;
     detection_option_tree_node_t** children;
+
+    // one per packet thread, state_stride apart; profile may be null
     dot_node_state_t* state;
+    dot_node_profile_t* profile;
+    unsigned state_stride;
+
+    // set on the top node of a compacted tree; owns all the others
+    void* arena;
+
+    dot_node_state_t& get_state(unsigned instance)
+    { return state[instance * state_stride]; }
+
+    dot_node_profile_t* get_profile(unsigned instance)
+    { return profile ? profile + instance * state_stride : nullptr; }
 };
 
 struct detection_option_tree_root_t
@@ -126,6 +148,8 @@ void print_option_tree(detection_option_tree_node_t*, int level);
 #endif
 void detection_option_tree_update_otn_stats(SFXHASH*);
 
+void detection_option_tree_compact(SFXHASH*, bool profile);
+
 detection_option_tree_root_t* new_root();
 void free_detection_option_root(void** existing_tree);
 
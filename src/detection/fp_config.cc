@@ -33,6 +33,7 @@
 #include "framework/mpse.h"
 #include "managers/mpse_manager.h"
 #include "log/messages.h"
+#include "utils/util.h"
 
 FastPatternConfig::FastPatternConfig()
 {
@@ -48,7 +49,18 @@ FastPatternConfig::FastPatternConfig()
 }
 
 FastPatternConfig::~FastPatternConfig()
-{ }
+{
+    if ( cache_dir )
+        snort_free(cache_dir);
+}
+
+void FastPatternConfig::set_cache_dir(const char* dir)
+{
+    if ( cache_dir )
+        snort_free(cache_dir);
+
+    cache_dir = (dir and *dir) ? snort_strdup(dir) : nullptr;
+}
 
 bool FastPatternConfig::set_detect_search_method(const char* method)
 {
@@ -141,6 +141,17 @@ public:
     int get_max_pattern_len()
     { return max_pattern_len; }
 
+    void set_compile_threads(unsigned n)
+    { compile_threads = n; }
+
+    unsigned get_compile_threads()
+    { return compile_threads; }
+
+    void set_cache_dir(const char*);
+
+    const char* get_cache_dir()
+    { return cache_dir; }
+
 private:
     const struct MpseApi* search_api;
 
@@ -152,12 +163,15 @@ private:
 
     unsigned max_queue_events;
     unsigned bleedover_port_limit;
+    unsigned compile_threads;  // 0 means one per cpu
 
     int search_opt;
     int portlists_flags;
     int max_pattern_len;
     int num_patterns_truncated;  // due to max_pattern_len
     int num_patterns_trimmed;    // due to zero byte prefix
+
+    char* cache_dir;  // compiled mpse databases, null if disabled
 };
 
 #endif
@@ -39,7 +39,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
 #include "main/snort_config.h"
+#include "main/thread_config.h"
 #include "hash/sfghash.h"
 #include "ips_options/ips_flow.h"
 #include "utils/util.h"
@@ -52,10 +58,13 @@
 #include "ports/rule_port_tables.h"
 #include "framework/mpse.h"
 #include "framework/ips_option.h"
+#include "latency/latency_config.h"
 #include "managers/mpse_manager.h"
+#include "profiler/profiler_defs.h"
 #include "target_based/snort_protocols.h"
 
 #include "fp_config.h"
+#include "header_classifier.h"
 #include "service_map.h"
 #include "rules.h"
 #include "treenodes.h"
@@ -67,6 +76,10 @@
 
 static unsigned mpse_count = 0;
 
+// search engines with patterns are compiled after all port groups are
+// built so the independent work can be done in parallel
+static std::vector<Mpse*> s_prep;
+
 static void fpDeletePMX(void* data);
 
 static int fpGetFinalPattern(
@@ -632,13 +645,7 @@ static int fpFinishPortGroup(
         {
             if (pg->mpse[i]->get_pattern_count() != 0)
             {
-                if (pg->mpse[i]->prep_patterns(sc) != 0)
-                {
-                    FatalError("Failed to compile port group patterns.\n");
-                }
-
-                if (fp->get_debug_mode())
-                    pg->mpse[i]->print_info();
+                s_prep.push_back(pg->mpse[i]);
                 rules = 1;
             }
             else
@@ -652,14 +659,31 @@ static int fpFinishPortGroup(
     if ( pg->nfp_head )
     {
         RULE_NODE* ruleNode;
+        HeaderClassifier* hc = new HeaderClassifier;
 
+        // rules with header only options go in the tree of their class
         for (ruleNode = pg->nfp_head; ruleNode; ruleNode = ruleNode->rnNext)
         {
             OptTreeNode* otn = (OptTreeNode*)ruleNode->rnRuleData;
-            otn_create_tree(otn, &pg->nfp_tree);
+            uint64_t mask = hc->get_mask(otn);
+            otn_create_tree(otn, mask ? hc->get_tree(mask) : &pg->nfp_tree);
+        }
+
+        if ( pg->nfp_tree )
+            finalize_detection_option_tree(sc, (detection_option_tree_root_t*)pg->nfp_tree);
+
+        if ( hc->get_class_count() )
+        {
+            for ( uint64_t mask : hc->get_masks() )
+                finalize_detection_option_tree(
+                    sc, (detection_option_tree_root_t*)*hc->get_tree(mask));
+
+            hc->prepare();
+            pg->nfp_classifier = hc;
         }
+        else
+            delete hc;
 
-        finalize_detection_option_tree(sc, (detection_option_tree_root_t*)pg->nfp_tree);
         rules = 1;
 
         pg->delete_nfp_rules();
@@ -675,6 +699,87 @@ static int fpFinishPortGroup(
     return 0;
 }
 
+static void fpPrepCompile(SnortConfig* sc, Mpse* mpse)
+{
+    if ( mpse->prep_compile(sc) )
+        FatalError("Failed to compile port group patterns.\n");
+}
+
+static void fpPrepCompileAll(SnortConfig* sc, const std::vector<Mpse*>& list, unsigned max)
+{
+    unsigned num = list.size();
+
+    if ( max > num )
+        max = num;
+
+    if ( max > 1 )
+    {
+        std::atomic<unsigned> next(0);
+        std::vector<std::thread> workers;
+
+        auto work = [&]()
+        {
+            unsigned i;
+
+            while ( (i = next++) < num )
+                fpPrepCompile(sc, list[i]);
+        };
+
+        for ( unsigned t = 0; t < max; ++t )
+            workers.push_back(std::thread(work));
+
+        for ( auto& t : workers )
+            t.join();
+    }
+    else
+    {
+        for ( auto* mpse : list )
+            fpPrepCompile(sc, mpse);
+    }
+}
+
+/*
+ * Compile the search engines of all port groups.  The compile step of each
+ * engine is independent so it is spread over the available cpus.  Engines
+ * with the same compile key are deferred to a second pass so they don't
+ * race (and can reuse the cached result of the first).  Trees are built
+ * afterwards on this thread in group order so the result does not depend
+ * on thread scheduling.
+ */
+static void fpCompileSearchEngines(SnortConfig* sc, FastPatternConfig* fp)
+{
+    unsigned max = fp->get_compile_threads();
+
+    if ( !max )
+        max = ThreadConfig::get_cpu_count();
+
+    std::vector<Mpse*> first, dups;
+    std::unordered_set<uint64_t> keys;
+
+    for ( auto* mpse : s_prep )
+    {
+        uint64_t key = mpse->get_compile_key(sc);
+
+        if ( key and !keys.insert(key).second )
+            dups.push_back(mpse);
+        else
+            first.push_back(mpse);
+    }
+
+    fpPrepCompileAll(sc, first, max);
+    fpPrepCompileAll(sc, dups, max);
+
+    for ( auto* mpse : s_prep )
+    {
+        if ( mpse->prep_trees(sc) )
+            FatalError("Failed to compile port group patterns.\n");
+
+        if (fp->get_debug_mode())
+            mpse->print_info();
+    }
+    s_prep.clear();
+}
+
 static int fpAddPortGroupRule(
     SnortConfig* sc, PortGroup* pg, OptTreeNode* otn, FastPatternConfig* fp)
 {
@@ -1054,6 +1159,7 @@ void fpDeletePortGroup(void* data)
     }
 
     free_detection_option_root(&pg->nfp_tree);
+    delete pg->nfp_classifier;
     snort_free(pg);
 }
 
@@ -1735,6 +1841,7 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
     }
 
     mpse_count = 0;
+    s_prep.clear();
 
     MpseManager::start_search_engine(fp->get_search_api());
 
@@ -1772,6 +1879,12 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
     if (fp->get_debug_print_rule_group_build_details())
         LogMessage("Service Based Rule Maps Done....\n");
 
+    fpCompileSearchEngines(sc, fp);
+    bool profile = (sc->profiler and sc->profiler->rule.show) or
+        (sc->latency and sc->latency->rule_latency.enabled());
+
+    detection_option_tree_compact(sc->detection_option_tree_hash_table, profile);
+
     fp_print_port_groups(port_tables);
     fp_print_service_groups(sc->spgmmTable);
 
@@ -48,6 +48,7 @@
 #include "service_map.h"
 #include "detection_util.h"
 #include "detection_options.h"
+#include "header_classifier.h"
 #include "pattern_match_data.h"
 #include "pcrm.h"
 #include "tag.h"
@@ -876,24 +877,37 @@ static int rule_tree_queue(
     return 0;
 }
 
-#define SEARCH_DATA(buf, len, cnt) \
-    { \
-        assert(so->get_pattern_count() > 0); \
-        int start_state = 0; \
-        cnt++; \
-        omd->data = buf; omd->size = len; \
-        stash.init(); \
-        so->search(buf, len, rule_tree_queue, omd, &start_state); \
-        stash.process(rule_tree_match, omd); \
-        if ( PacketLatency::fastpath() ) \
-            return 1; \
-    }
+// all fast pattern buffers of a port group are collected into a batch and
+// searched together so the engine can interleave the walks.  flow is only
+// given for reassembled payload so that streaming engines can pick up where
+// the last flush left off.
+static const unsigned max_fp_batch = 6;
+
+static inline void fp_batch_add(
+    MpseBatchItem* batch, unsigned& n, Mpse* so, const uint8_t* buf, unsigned len,
+    OTNX_MATCH_DATA* omd, Flow* flow = nullptr, bool to_server = false, uint32_t seq = 0)
+{
+    assert(so->get_pattern_count() > 0);
+    assert(n < max_fp_batch);
+
+    MpseBatchItem& item = batch[n++];
+    item.so = so;
+    item.buf = buf;
+    item.len = len;
+    item.context = omd;
+    item.flow = flow;
+    item.to_server = to_server;
+    item.seq = seq;
+}
 
 #define SEARCH_BUFFER(ibt, pmt, cnt) \
     if ( gadget->get_fp_buf(ibt, p, buf) ) \
     { \
         if ( Mpse* so = port_group->mpse[pmt] ) \
-            SEARCH_DATA(buf.data, buf.len, cnt) \
+        { \
+            fp_batch_add(batch, nb, so, buf.data, buf.len, omd); \
+            cnt++; \
+        } \
     }
 
 static int fp_search(
@@ -903,6 +917,9 @@ static int fp_search(
     Inspector* gadget = p->flow ? p->flow->gadget : nullptr;
     InspectionBuffer buf;
 
+    MpseBatchItem batch[max_fp_batch];
+    unsigned nb = 0;
+
     omd->pg = port_group;
     omd->p = p;
     omd->check_ports = check_ports;
@@ -919,11 +936,21 @@ static int fp_search(
             if ( IsLimitedDetect(p) && (p->alt_dsize < p->dsize) )
                 pattern_match_size = p->alt_dsize;
 
-            if ( pattern_match_size )
-                SEARCH_DATA(p->data, pattern_match_size, pc.pkt_searches);
+            // only a whole tcp flush can continue a stream search; a
+            // truncated one leaves bytes unscanned so the stream restarts
+            // on the next flush since its seq won't follow this one
+            Flow* sf = ((p->packet_flags & PKT_REBUILT_STREAM) and p->ptrs.tcph and
+                pattern_match_size == p->dsize) ? p->flow : nullptr;
+
+            uint32_t seq = sf ? p->ptrs.tcph->seq() : 0;
 
             if ( pattern_match_size )
+            {
+                fp_batch_add(batch, nb, so, p->data, pattern_match_size, omd,
+                    sf, p->is_from_client(), seq);
+                pc.pkt_searches++;
                 p->is_cooked() ?  pc.cooked_searches++ : pc.raw_searches++;
+            }
         }
     }
 
@@ -948,9 +975,28 @@ static int fp_search(
             // FIXIT-M file data should be obtained from
             // inspector gadget as is done with SEARCH_BUFFER
             if ( g_file_data.len )
-                SEARCH_DATA(g_file_data.data, g_file_data.len, pc.file_searches);
+            {
+                fp_batch_add(batch, nb, so, g_file_data.data, g_file_data.len, omd);
+                pc.file_searches++;
+            }
         }
     }
+
+    if ( !nb )
+        return 0;
+
+    if ( nb > 1 )
+        pc.batch_searches++;
+
+    // the stash dedups by tree and all items share omd so matches from any
+    // buffer can be queued together
+    stash.init();
+    Mpse::search_batch(batch, nb, rule_tree_queue);
+    stash.process(rule_tree_match, omd);
+
+    if ( PacketLatency::fastpath() )
+        return 1;
+
     return 0;
 }
 
@@ -1038,6 +1084,17 @@ static inline int fpEvalHeaderSW(PortGroup* port_group, Packet* p,
                 Profile rule_nfp_eval_profile(ruleNFPEvalPerfStats);
                 rval = detection_option_tree_evaluate(
                     (detection_option_tree_root_t*)port_group->nfp_tree, &eval_data);
+
+                if ( HeaderClassifier* hc = port_group->nfp_classifier )
+                {
+                    void** trees;
+                    unsigned n = hc->classify(p, trees);
+                    pc.header_screens += hc->get_class_count() - n;
+
+                    for ( unsigned i = 0; i < n; ++i )
+                        rval += detection_option_tree_evaluate(
+                            (detection_option_tree_root_t*)trees[i], &eval_data);
+                }
             }
 
             if (rval)
@@ -0,0 +1,295 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// header_classifier.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "header_classifier.h"
+
+#include <assert.h>
+
+#include "detection_defines.h"
+#include "detection_options.h"
+#include "treenodes.h"
+
+#include "framework/cursor.h"
+#include "framework/ips_option.h"
+#include "main/thread.h"
+#include "main/thread_config.h"
+
+#ifdef UNIT_TEST
+#include <string.h>
+
+#include "catch/catch.hpp"
+#include "framework/module.h"
+#include "framework/value.h"
+#include "protocols/icmp4.h"
+#include "protocols/ipv4.h"
+#include "protocols/packet.h"
+#include "protocols/tcp.h"
+#include "utils/util.h"
+#endif
+
+HeaderClassifier::~HeaderClassifier()
+{
+    for ( auto& t : trees )
+        free_detection_option_root(&t);
+}
+
+uint64_t HeaderClassifier::get_mask(OptTreeNode* otn)
+{
+    uint64_t mask = 0;
+
+    for ( OptFpList* ofl = otn->opt_func; ofl; ofl = ofl->next )
+    {
+        IpsOption* opt = ofl->ips_opt;
+
+        if ( !opt or !opt->is_header_only() )
+            continue;
+
+        unsigned i;
+
+        // identical options are usually shared but compare to be sure
+        for ( i = 0; i < columns.size(); ++i )
+        {
+            if ( columns[i] == opt or *columns[i] == *opt )
+                break;
+        }
+
+        if ( i == columns.size() )
+        {
+            if ( i == HC_MAX_COLUMNS )
+                continue;
+
+            columns.push_back(opt);
+        }
+        mask |= (uint64_t)1 << i;
+    }
+    return mask;
+}
+
+void** HeaderClassifier::get_tree(uint64_t mask)
+{
+    assert(mask);
+
+    for ( unsigned i = 0; i < masks.size(); ++i )
+    {
+        if ( masks[i] == mask )
+            return &trees[i];
+    }
+    masks.push_back(mask);
+    trees.push_back(nullptr);
+    return &trees.back();
+}
+
+void HeaderClassifier::prepare()
+{
+    unsigned n = masks.size() * ThreadConfig::get_instance_max();
+    keep.resize(n);
+    survivors.resize(n);
+}
+
+unsigned HeaderClassifier::classify(Packet* p, void**& out)
+{
+    uint64_t failed = 0;
+    Cursor c(p);
+
+    for ( unsigned i = 0; i < columns.size(); ++i )
+    {
+        if ( columns[i]->eval(c, p) != DETECTION_OPTION_MATCH )
+            failed |= (uint64_t)1 << i;
+    }
+
+    const unsigned num = masks.size();
+    const uint64_t* m = masks.data();
+    uint8_t* k = keep.data() + get_instance_id() * num;
+
+    for ( unsigned i = 0; i < num; ++i )
+        k[i] = !(m[i] & failed);
+
+    out = survivors.data() + get_instance_id() * num;
+    unsigned n = 0;
+
+    for ( unsigned i = 0; i < num; ++i )
+    {
+        if ( k[i] )
+            out[n++] = trees[i];
+    }
+    return n;
+}
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+extern const BaseApi* ips_ack;
+extern const BaseApi* ips_dsize;
+extern const BaseApi* ips_flags;
+extern const BaseApi* ips_fragbits;
+extern const BaseApi* ips_fragoffset;
+extern const BaseApi* ips_icmp_id;
+extern const BaseApi* ips_icmp_seq;
+extern const BaseApi* ips_icode;
+extern const BaseApi* ips_id;
+extern const BaseApi* ips_ipopts;
+extern const BaseApi* ips_ip_proto;
+extern const BaseApi* ips_itype;
+extern const BaseApi* ips_seq;
+extern const BaseApi* ips_tos;
+extern const BaseApi* ips_ttl;
+extern const BaseApi* ips_window;
+
+// each header only option with an argument that matches the test packet
+// and one that doesn't
+struct HeaderCase
+{
+    const BaseApi* const* api;
+    const char* pass;
+    const char* fail;
+    bool icmp;
+};
+
+static const HeaderCase header_cases[] =
+{
+    { &ips_ttl, "64", "<10", false },
+    { &ips_tos, "16", "0", false },
+    { &ips_id, "1234", ">2000", false },
+    { &ips_ipopts, "any", "rr", false },
+    { &ips_fragbits, "D", "M", false },
+    { &ips_fragoffset, "16", "0", false },
+    { &ips_ip_proto, "6", "17", false },
+    { &ips_dsize, "100", ">1000", false },
+    { &ips_flags, "S", "A", false },
+    { &ips_seq, "1000", "1001", false },
+    { &ips_ack, "0", ">0", false },
+    { &ips_window, "512", "<100", false },
+    { &ips_itype, "8", "0", true },
+    { &ips_icode, "0", ">0", true },
+    { &ips_icmp_id, "7", "8", true },
+    { &ips_icmp_seq, "9", "10", true },
+};
+
+static IpsOption* get_option(const BaseApi* api, const char* arg)
+{
+    Module* mod = api->mod_ctor();
+    mod->begin(api->name, 0, nullptr);
+
+    Value v(arg);
+    v.set(mod->get_parameters());
+    mod->set(api->name, v, nullptr);
+    mod->end(api->name, 0, nullptr);
+
+    IpsOption* opt = ((const IpsApi*)api)->ctor(mod, nullptr);
+    api->mod_dtor(mod);
+    return opt;
+}
+
+TEST_CASE("header classifier option kinds", "[header_classifier]")
+{
+    alignas(4) uint8_t raw[24] = { };
+    ip::IP4Hdr* ip4h = (ip::IP4Hdr*)raw;
+    ip4h->ip_verhl = 0x46;  // 4 bytes of options
+    ip4h->ip_tos = 16;
+    ip4h->ip_id = htons(1234);
+    ip4h->ip_off = htons(0x4000 | 2);  // DF at offset 16
+    ip4h->ip_ttl = 64;
+    memset(raw + 20, 1, 4);  // nops
+
+    tcp::TCPHdr tcph;
+    memset(&tcph, 0, sizeof(tcph));
+    tcph.th_seq = htonl(1000);
+    tcph.th_offx2 = 0x50;
+    tcph.th_flags = TH_SYN;
+    tcph.th_win = htons(512);
+
+    icmp::ICMPHdr icmph;
+    memset(&icmph, 0, sizeof(icmph));
+    icmph.type = (icmp::IcmpType)ICMP_ECHO;
+    icmph.s_icmp_id = htons(7);
+    icmph.s_icmp_seq = htons(9);
+
+    int kept, screened;
+
+    for ( auto& hc : header_cases )
+    {
+        const BaseApi* api = *hc.api;
+        INFO(api->name);
+
+        Packet p(false);
+        p.dsize = 100;
+
+        if ( hc.icmp )
+        {
+            ip4h->ip_proto = IpProtocol::ICMPV4;
+            p.ptrs.icmph = &icmph;
+        }
+        else
+        {
+            ip4h->ip_proto = IpProtocol::TCP;
+            p.ptrs.tcph = &tcph;
+        }
+        p.ptrs.ip_api.set(ip4h);
+        p.ip_proto_next = ip4h->ip_proto;
+
+        IpsOption* pass = get_option(api, hc.pass);
+        IpsOption* fail = get_option(api, hc.fail);
+
+        OptFpList pass_fl = { }, fail_fl = { };
+        pass_fl.ips_opt = pass;
+        fail_fl.ips_opt = fail;
+
+        OptTreeNode* pass_otn = (OptTreeNode*)snort_calloc(sizeof(OptTreeNode));
+        OptTreeNode* fail_otn = (OptTreeNode*)snort_calloc(sizeof(OptTreeNode));
+        pass_otn->opt_func = &pass_fl;
+        fail_otn->opt_func = &fail_fl;
+
+        HeaderClassifier* hcl = new HeaderClassifier;
+        uint64_t pass_mask = hcl->get_mask(pass_otn);
+        uint64_t fail_mask = hcl->get_mask(fail_otn);
+
+        CHECK(pass_mask);
+        CHECK(fail_mask);
+        CHECK(pass_mask != fail_mask);
+
+        *hcl->get_tree(pass_mask) = &kept;
+        *hcl->get_tree(fail_mask) = &screened;
+        hcl->prepare();
+
+        void** trees;
+        CHECK(hcl->classify(&p, trees) == 1);
+        CHECK(trees[0] == &kept);
+
+        // the trees aren't real
+        *hcl->get_tree(pass_mask) = nullptr;
+        *hcl->get_tree(fail_mask) = nullptr;
+        delete hcl;
+
+        snort_free(pass_otn);
+        snort_free(fail_otn);
+
+        ((const IpsApi*)api)->dtor(pass);
+        ((const IpsApi*)api)->dtor(fail);
+    }
+}
+
+#endif
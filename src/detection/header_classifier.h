@@ -0,0 +1,77 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// header_classifier.h
+
+#ifndef HEADER_CLASSIFIER_H
+#define HEADER_CLASSIFIER_H
+
+// screens the non-fast-pattern rules of a port group by their header only
+// options (dsize, ttl, flags, etc.) before any tree is walked.  each
+// distinct header option in the group is a column that is evaluated once
+// per packet.  rules with the same set of columns form a class with its own
+// detection option tree.  a class survives if all of its columns passed and
+// only the trees of surviving classes are evaluated.  the class test is a
+// straight loop over an array of masks so the compiler can vectorize it.
+
+#include <stdint.h>
+#include <vector>
+
+class IpsOption;
+struct OptTreeNode;
+struct Packet;
+
+#define HC_MAX_COLUMNS 64
+
+class HeaderClassifier
+{
+public:
+    ~HeaderClassifier();
+
+    // main thread: returns the columns tested by the rule or zero if it
+    // has none, adding columns as needed up to HC_MAX_COLUMNS
+    uint64_t get_mask(OptTreeNode*);
+
+    // main thread: returns the tree of the class for the given mask
+    void** get_tree(uint64_t mask);
+
+    // main thread: call after all rules were added
+    void prepare();
+
+    unsigned get_class_count() const
+    { return masks.size(); }
+
+    const std::vector<uint64_t>& get_masks() const
+    { return masks; }
+
+    // packet thread: returns the number of surviving classes and sets
+    // trees to an array of their roots which is valid until the next call
+    unsigned classify(Packet*, void**& trees);
+
+private:
+    std::vector<IpsOption*> columns;
+    std::vector<uint64_t> masks;
+    std::vector<void*> trees;
+
+    // per packet thread scratch
+    std::vector<uint8_t> keep;
+    std::vector<void*> survivors;
+};
+
+#endif
+
@@ -37,10 +37,11 @@
 **       sfeventq_init()
 **
 **  2. Add events to queue
-**       sfeventq_event_alloc() allocates the memory for storing the event.
-**       sfeventq_add() adds the event and prioritizes the event in the queue.
-**       You should only allocate and add one event at a time.  Otherwise,
-**       event_alloc() will return NULL on memory exhaustion.
+**       sfeventq_event_alloc() returns the memory for storing the event.
+**       sfeventq_add() adds the event to the end of the queue.
+**       You must allocate and add one event at a time since alloc just
+**       returns the next free slot.  When the queue is full, alloc returns
+**       a reserve slot and add fails.
 **
 **  3. Event actions
 **       sfeventq_action() will call the provided function on the initialized
@@ -56,6 +57,13 @@
 #include <stdlib.h>
 #include "utils/util.h"
 
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#endif
+
 /*
 **  NAME
 **    sfeventq_new::
@@ -63,92 +71,31 @@
 /**
 **  Initialize the event queue.  Provide the max number of nodes that this
 **  queue will support, the number of top nodes to log in the queue, and the
-**  size of the event structure that the user will fill in.
+**  size of the event structure that the user will fill in.  All event
+**  memory, including the reserve slot, is allocated here so the per packet
+**  functions never allocate.
 **
-**  @return integer
+**  @return SF_EVENTQ *
 **
-**  @retval -1 failure
-**  @retval  0 success
+**  @retval NULL invalid arguments
+**  @retval !NULL the new queue
 */
 SF_EVENTQ* sfeventq_new(int max_nodes, int log_nodes, int event_size)
 {
-    SF_EVENTQ* eq;
-
     if ((max_nodes <= 0) || (log_nodes <= 0) || (event_size <= 0))
         return NULL;
 
-    eq = (SF_EVENTQ*)snort_calloc(sizeof(SF_EVENTQ));
+    SF_EVENTQ* eq = (SF_EVENTQ*)snort_calloc(sizeof(SF_EVENTQ));
 
-    /* Initialize the memory for the nodes that we are going to use. */
-    eq->node_mem = (SF_EVENTQ_NODE*)snort_calloc(max_nodes, sizeof(SF_EVENTQ_NODE));
     eq->event_mem = (char*)snort_calloc(max_nodes + 1, event_size);
-
     eq->max_nodes = max_nodes;
     eq->log_nodes = log_nodes;
     eq->event_size = event_size;
-    eq->cur_nodes = 0;
     eq->cur_events = 0;
-    eq->reserve_event = (char*)(&eq->event_mem[max_nodes * eq->event_size]);
 
     return eq;
 }
 
-/*
-**  NAME
-**    sfeventq_event_alloc::
-*/
-/**
-**  Allocate the memory for an event to add to the event queue.  This
-**  function is meant to be called first, the event structure filled in,
-**  and then added to the queue.  While you can allocate several times before
-**  adding to the queue, this is not recommended as you may get a NULL ptr
-**  if you allocate more than the max node number.
-**
-**  @return  void *
-**
-**  @retval  NULL unable to allocate memory.
-**  @retval !NULL ptr to memory.
-*/
-void* sfeventq_event_alloc(SF_EVENTQ* eq)
-{
-    void* event;
-
-    if (eq->cur_events >= eq->max_nodes)
-    {
-        if (eq->reserve_event == NULL)
-            return NULL;
-
-        event = (void*)eq->reserve_event;
-        eq->reserve_event = NULL;
-
-        return event;
-    }
-
-    event = (void*)(&eq->event_mem[eq->cur_events * eq->event_size]);
-
-    eq->cur_events++;
-
-    return event;
-}
-
-/*
-**  NAME
-**    sfeventq_reset::
-*/
-/**
-**  Resets the event queue.  We also set the reserve event back
-**  to the last event in the queue.
-**
-**  @return void
-*/
-void sfeventq_reset(SF_EVENTQ* eq)
-{
-    eq->head = NULL;
-    eq->cur_nodes = 0;
-    eq->cur_events = 0;
-    eq->reserve_event = (char*)(&eq->event_mem[eq->max_nodes * eq->event_size]);
-}
-
 /*
 **  NAME
 **    sfeventq_free::
@@ -164,116 +111,17 @@ void sfeventq_free(SF_EVENTQ* eq)
     if (eq == NULL)
         return;
 
-    /* Free the memory for the nodes that were in use. */
-    if (eq->node_mem != NULL)
-    {
-        snort_free(eq->node_mem);
-        eq->node_mem = NULL;
-    }
-
-    if (eq->event_mem != NULL)
-    {
-        snort_free(eq->event_mem);
-        eq->event_mem = NULL;
-    }
-
+    snort_free(eq->event_mem);
     snort_free(eq);
 }
 
-/*
-**  NAME
-**    get_eventq_node::
-*/
-/**
-**  This function returns a ptr to the node to use.  We allocate the last
-**  event node if we have exhausted the event queue.  Before we allocate
-**  the last node, we determine if the incoming event has a higher
-**  priority than the last node.  If it does, we allocate the node, otherwise
-**  we drop it because it is lower priority.
-**
-**  If the last node is allocated, we have to point the reserve_event to
-**  the allocated event memory, since the reserved_event memory was used
-**  for the incoming event.
-**
-**  @return SF_EVENTQ_NODE *
-**
-**  @retval NULL resource exhaustion and event is lower priority than last node
-**  @retval !NULL ptr to node memory.
-*/
-static SF_EVENTQ_NODE* get_eventq_node(SF_EVENTQ* eq, void*)
-{
-    if (eq->cur_nodes >= eq->max_nodes)
-        return NULL;
-
-    /*
-    **  We grab the next node from the node memory.
-    */
-    return &eq->node_mem[eq->cur_nodes++];
-}
-
-/*
-**  NAME
-**    sfeventq_add:
-*/
-/**
-**  Add this event to the queue using the supplied ordering
-**  function.  If the queue is exhausted, then we compare the
-**  event to be added with the last event, and decide whether
-**  it is a higher priority than the last node.
-**
-**  @return integer
-**
-**  @retval -1 add event failed
-**  @retval  0 add event succeeded
-*/
-int sfeventq_add(SF_EVENTQ* eq, void* event)
-{
-    SF_EVENTQ_NODE* node;
-
-    if (!event)
-        return -1;
-
-    /*
-    **  If get_eventq_node() returns NULL, this means that
-    **  we have exhausted the eventq and the incoming event
-    **  is lower in priority then the last ranked event.
-    **  So we just drop it.
-    */
-    node = get_eventq_node(eq, event);
-    if (!node)
-        return -1;
-
-    node->event = event;
-    node->next  = NULL;
-    node->prev  = NULL;
-
-    /*
-    **  This is the first node
-    */
-    if (eq->cur_nodes == 1)
-    {
-        eq->head = eq->last = node;
-        return 0;
-    }
-
-    /*
-    **  This means we are the last node.
-    */
-    node->prev = eq->last;
-
-    eq->last->next = node;
-    eq->last = node;
-
-    return 0;
-}
-
 /*
 **  NAME
 **    sfeventq_action::
 */
 /**
-**  Call the supplied user action function on the highest priority
-**  events.
+**  Call the supplied user action function on the first log_nodes events
+**  in the order they were added.
 **
 **  @return integer
 **
@@ -283,133 +131,142 @@ int sfeventq_add(SF_EVENTQ* eq, void* event)
 */
 int sfeventq_action(SF_EVENTQ* eq, int (* action_func)(void*, void*), void* user)
 {
-    SF_EVENTQ_NODE* node;
-    int logged = 0;
-
     if (action_func == NULL)
         return -1;
 
-    if (eq->head == NULL)
+    int n = eq->cur_events < eq->log_nodes ? eq->cur_events : eq->log_nodes;
+
+    if ( !n )
         return 0;
 
-    for (node = eq->head; node != NULL; node = node->next)
-    {
-        if (logged >= eq->log_nodes)
-            return 1;
+    char* event = eq->event_mem;
 
-        if (action_func(node->event, user))
+    for ( int i = 0; i < n; ++i, event += eq->event_size )
+    {
+        if (action_func(event, user))
             return -1;
-
-        logged++;
     }
 
     return 1;
 }
 
-//#define I_WANT_MY_MAIN
-#ifdef  I_WANT_MY_MAIN
+//--------------------------------------------------------------------------
+// unit tests
+//--------------------------------------------------------------------------
 
-#include <stdio.h>
-#include <time.h>
+#ifdef UNIT_TEST
 
-int myaction(void* event, void* user)
+static int test_action(void* event, void* user)
 {
-    int* e;
+    std::vector<int>* v = (std::vector<int>*)user;
+    v->push_back(*(int*)event);
+    return 0;
+}
 
-    if (!event)
-        return 1;
+static void test_add(SF_EVENTQ* eq, int n, int base = 0)
+{
+    for ( int i = 0; i < n; ++i )
+    {
+        int* e = (int*)sfeventq_event_alloc(eq);
+        *e = base + i;
+        sfeventq_add(eq, e);
+    }
+}
 
-    e = (int*)event;
+TEST_CASE("sfeventq empty", "[sfeventq]")
+{
+    SF_EVENTQ* eq = sfeventq_new(8, 3, sizeof(int));
+    std::vector<int> v;
 
-    printf("-- EVENT: %d\n", *e);
+    CHECK(sfeventq_action(eq, test_action, &v) == 0);
+    CHECK(v.empty());
 
-    return 0;
+    sfeventq_free(eq);
 }
 
-int main(int argc, char** argv)
+TEST_CASE("sfeventq log limit", "[sfeventq]")
 {
-    int max_events;
-    int log_events;
-    int add_events;
-    int* event;
-    int iCtr;
-    SF_EVENTQ* eq;
-
-    if (argc < 4)
-    {
-        printf("-- Not enough args\n");
-        return 1;
-    }
+    SF_EVENTQ* eq = sfeventq_new(8, 3, sizeof(int));
+    std::vector<int> v;
 
-    max_events = atoi(argv[1]);
-    if (max_events <= 0)
-    {
-        printf("-- max_events invalid.\n");
-        return 1;
-    }
+    test_add(eq, 5);
+    CHECK(eq->cur_events == 5);
+    CHECK(sfeventq_action(eq, test_action, &v) == 1);
+    CHECK((v == std::vector<int> { 0, 1, 2 }));
 
-    log_events = atoi(argv[2]);
-    if (log_events <= 0)
-    {
-        printf("-- log_events invalid.\n");
-        return 1;
-    }
+    sfeventq_free(eq);
+}
 
-    add_events = atoi(argv[3]);
-    if (add_events <= 0)
-    {
-        printf("-- add_events invalid.\n");
-        return 1;
-    }
+TEST_CASE("sfeventq overflow", "[sfeventq]")
+{
+    SF_EVENTQ* eq = sfeventq_new(4, 8, sizeof(int));
+    std::vector<int> v;
 
-    if (max_events < log_events)
-    {
-        printf("-- log_events greater than max_events\n");
-        return 1;
-    }
+    test_add(eq, 4);
 
-    srandom(time(NULL));
+    int* e = (int*)sfeventq_event_alloc(eq);
+    REQUIRE(e);
+    *e = 99;
+    CHECK(sfeventq_add(eq, e) == -1);
+    CHECK(eq->cur_events == 4);
 
-    eq = sfeventq_new(max_events, log_events, sizeof(int));
-    if (eq == NULL)
-    {
-        printf("Couldn't allocate the event queue\n");
-        return 1;
-    }
+    CHECK(sfeventq_action(eq, test_action, &v) == 1);
+    CHECK((v == std::vector<int> { 0, 1, 2, 3 }));
 
-    do
-    {
-        printf("-- Event Queue Test --\n\n");
+    sfeventq_free(eq);
+}
 
-        for (iCtr = 0; iCtr < add_events; iCtr++)
-        {
-            event  = (int*)sfeventq_event_alloc(eq);
-            if (!event)
-            {
-                printf("-- event allocation failed\n");
-                return 1;
-            }
+TEST_CASE("sfeventq reset", "[sfeventq]")
+{
+    SF_EVENTQ* eq = sfeventq_new(8, 8, sizeof(int));
+    std::vector<int> v;
 
-            *event = (int)(random()%3);
+    test_add(eq, 8);
+    sfeventq_reset(eq);
+    CHECK(sfeventq_action(eq, test_action, &v) == 0);
 
-            sfeventq_add(eq, event);
-            printf("-- added %d\n", *event);
-        }
+    test_add(eq, 2, 10);
+    CHECK(sfeventq_action(eq, test_action, &v) == 1);
+    CHECK((v == std::vector<int> { 10, 11 }));
+
+    sfeventq_free(eq);
+}
 
-        printf("\n-- Logging\n\n");
+// per packet cost of add + action + reset at increasing queue depths using
+// the default 8 max / 3 log configuration.  depth 0 is the common no alert
+// case; depths beyond max exercise overflow.
+static int bench_action(void* event, void* user)
+{
+    (*(unsigned*)user) += *(int*)event;
+    return 0;
+}
 
-        if (sfeventq_action(eq, myaction, NULL))
+// hidden; run with -T "[sfeventq_bench]"
+TEST_CASE("sfeventq benchmark", "[.][sfeventq_bench]")
+{
+    const unsigned iterations = 10000000;
+    SF_EVENTQ* eq = sfeventq_new(8, 3, sizeof(int));
+    unsigned sink = 0;
+
+    for ( int depth : { 0, 1, 3, 8, 16, 64 } )
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for ( unsigned i = 0; i < iterations; ++i )
         {
-            printf("-- There was a problem.\n");
-            return 1;
+            test_add(eq, depth);
+            sfeventq_action(eq, bench_action, &sink);
+            sfeventq_reset(eq);
         }
 
-        sfeventq_reset(eq);
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+
+        printf("depth %2d: %8.2f ns/packet\n", depth, ns / iterations);
     }
-    while (getc(stdin) < 14);
 
-    return 0;
+    CHECK(sink);
+    sfeventq_free(eq);
 }
 
 #endif
-
@@ -20,55 +20,44 @@
 #ifndef SFEVENTQ_H
 #define SFEVENTQ_H
 
-typedef struct s_SF_EVENTQ_NODE
-{
-    void* event;
-
-    struct s_SF_EVENTQ_NODE* prev;
-    struct s_SF_EVENTQ_NODE* next;
-}  SF_EVENTQ_NODE;
+// fixed capacity event queue.  events are stored in place in a single
+// array in the order they were added; reset is just a count reset and
+// action walks the array.  one extra slot is kept so that alloc can hand
+// out storage for an event that is subsequently dropped by add when full.
 
 typedef struct s_SF_EVENTQ
 {
-    /*
-    **  Handles the actual ordering and memory
-    **  of the event queue and it's nodes.
-    */
-    SF_EVENTQ_NODE* head;
-    SF_EVENTQ_NODE* last;
-
-    SF_EVENTQ_NODE* node_mem;
     char* event_mem;
 
-    /*
-    **  The reserve event allows us to allocate one extra node
-    **  and compare against the last event in the queue to determine
-    **  if the incoming event is a higher priority than the last
-    **  event in the queue.
-    */
-    char* reserve_event;
-
-    /*
-    **  Queue configuration
-    */
     int max_nodes;
     int log_nodes;
     int event_size;
 
-    /*
-    **  This element tracks the current number of
-    **  nodes in the event queue.
-    */
-    int cur_nodes;
+    // number of events currently in the queue
     int cur_events;
 }  SF_EVENTQ;
 
 SF_EVENTQ* sfeventq_new(int max_nodes, int log_nodes, int event_size);
-void* sfeventq_event_alloc(SF_EVENTQ*);
-void sfeventq_reset(SF_EVENTQ*);
-int sfeventq_add(SF_EVENTQ*, void* event);
 int sfeventq_action(SF_EVENTQ*, int (* action_func)(void* event, void* user), void* user);
 void sfeventq_free(SF_EVENTQ*);
 
+// returns the next free slot; when the queue is full this is the reserve
+// slot which is overwritten by the next alloc
+inline void* sfeventq_event_alloc(SF_EVENTQ* eq)
+{ return eq->event_mem + eq->cur_events * eq->event_size; }
+
+// event must be the last thing returned by sfeventq_event_alloc()
+inline int sfeventq_add(SF_EVENTQ* eq, void* event)
+{
+    if ( !event or eq->cur_events >= eq->max_nodes )
+        return -1;
+
+    eq->cur_events++;
+    return 0;
+}
+
+inline void sfeventq_reset(SF_EVENTQ* eq)
+{ eq->cur_events = 0; }
+
 #endif
 
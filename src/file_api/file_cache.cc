@@ -27,7 +27,30 @@
 #include "utils/snort_bounds.h"
 #include "main/snort_config.h"
 
-uint64_t FileCache::num_add_fails = 0;
+#include <mutex>
+
+#define NUM_PARTITIONS 16
+
+struct FileCache::Partition
+{
+    SFXHASH* fileHash = nullptr;
+    std::mutex cache_mutex;
+    FileCacheStats stats = { };
+
+    // keep the locks of adjacent partitions on separate cache lines
+    char pad[64];
+
+    void lock(std::unique_lock<std::mutex>&);
+};
+
+void FileCache::Partition::lock(std::unique_lock<std::mutex>& lk)
+{
+    if ( !lk.try_lock() )
+    {
+        lk.lock();
+        stats.contended++;
+    }
+}
 
 static int file_cache_free_func(void*, void* data)
 {
@@ -42,19 +65,55 @@ static int file_cache_free_func(void*, void* data)
 
 FileCache::FileCache()
 {
-    int max_files = snort_conf->file_config.max_files_cached;
-    fileHash = sfxhash_new(max_files, sizeof(FileHashKey), sizeof(FileNode),
-        0, 1, nullptr, file_cache_free_func, 1);
-    if (!fileHash)
-        FatalError("Failed to create the expected channel hash table.\n");
-    sfxhash_set_max_nodes(fileHash, max_files);
+    int max_files = snort_conf->file_config.max_files_cached / NUM_PARTITIONS;
+
+    if ( max_files < 1 )
+        max_files = 1;
+
+    partitions = new Partition[NUM_PARTITIONS];
+
+    for ( unsigned i = 0; i < NUM_PARTITIONS; ++i )
+    {
+        SFXHASH*& fileHash = partitions[i].fileHash;
+
+        fileHash = sfxhash_new(max_files, sizeof(FileHashKey), sizeof(FileNode),
+            0, 1, nullptr, file_cache_free_func, 1);
+        if (!fileHash)
+            FatalError("Failed to create the expected channel hash table.\n");
+        sfxhash_set_max_nodes(fileHash, max_files);
+    }
 }
 
 FileCache::~FileCache()
 {
-    if (fileHash)
+    for ( unsigned i = 0; i < NUM_PARTITIONS; ++i )
+    {
+        if (partitions[i].fileHash)
+            sfxhash_delete(partitions[i].fileHash);
+    }
+    delete[] partitions;
+}
+
+FileCache::Partition& FileCache::get_partition(const FileHashKey& key)
+{
+    uint64_t h = key.file_sig ^ ((uint64_t)key.sip.ip32[3] << 32) ^ key.dip.ip32[3];
+    h *= 0x9E3779B97F4A7C15ULL;
+    return partitions[h >> 60 & (NUM_PARTITIONS - 1)];
+}
+
+void FileCache::get_stats(FileCacheStats& sum)
+{
+    sum = { };
+
+    for ( unsigned i = 0; i < NUM_PARTITIONS; ++i )
     {
-        sfxhash_delete(fileHash);
+        const FileCacheStats& stats = partitions[i].stats;
+        sum.adds += stats.adds;
+        sum.add_fails += stats.add_fails;
+        sum.hits += stats.hits;
+        sum.misses += stats.misses;
+        sum.expired += stats.expired;
+        sum.contended += stats.contended;
     }
 }
 
@@ -71,43 +130,55 @@ FileContext* FileCache::add(const FileHashKey& hashKey)
     new_node.expires = now + timeout;
     new_node.file = new FileContext;
 
-    std::lock_guard<std::mutex> lock(cache_mutex);
+    Partition& part = get_partition(hashKey);
+    std::unique_lock<std::mutex> lock(part.cache_mutex, std::defer_lock);
+    part.lock(lock);
 
-    if (sfxhash_add(fileHash, (void*)&hashKey, &new_node) != SFXHASH_OK)
+    if (sfxhash_add(part.fileHash, (void*)&hashKey, &new_node) != SFXHASH_OK)
     {
         /* Uh, shouldn't get here...
          * There is already a node or couldn't alloc space
          * for key.  This means bigger problems, but fail
          * gracefully.
          */
-        FileCache::num_add_fails++;
+        part.stats.add_fails++;
         delete new_node.file;
         return nullptr;
     }
 
+    part.stats.adds++;
     return new_node.file;
 }
 
 FileContext* FileCache::find(const FileHashKey& hashKey)
 {
-    std::lock_guard<std::mutex> lock(cache_mutex);
+    Partition& part = get_partition(hashKey);
+    std::unique_lock<std::mutex> lock(part.cache_mutex, std::defer_lock);
+    part.lock(lock);
+
+    SFXHASH* fileHash = part.fileHash;
 
     // No hash table, or its empty?  Get out of dodge.
     if ((!fileHash) || (!sfxhash_count(fileHash)))
     {
         DebugMessage(DEBUG_FILE, "No expected sessions\n");
+        part.stats.misses++;
         return nullptr;
     }
 
     SFXHASH_NODE* hash_node = sfxhash_find_node(fileHash, &hashKey);
 
     if (!hash_node)
+    {
+        part.stats.misses++;
         return nullptr;
+    }
 
     FileNode* node = (FileNode*)hash_node->data;
     if (!node)
     {
         sfxhash_free_node(fileHash, hash_node);
+        part.stats.misses++;
         return nullptr;
     }
 
@@ -117,10 +188,13 @@ FileContext* FileCache::find(const FileHashKey& hashKey)
     {
         DebugMessage(DEBUG_FILE, "File expired\n");
         sfxhash_free_node(fileHash, hash_node);
+        part.stats.expired++;
+        part.stats.misses++;
         return nullptr;
     }
 
     node->expires = now + timeout;
+    part.stats.hits++;
     return node->file;
 }
 
@@ -21,8 +21,6 @@
 #ifndef FILE_CACHE_H
 #define FILE_CACHE_H
 
-#include <mutex>
-
 #include "file_api.h"
 #include "file_lib.h"
 #include "file_config.h"
@@ -31,6 +29,20 @@
 #include "hash/sfxhash.h"
 #include "hash/hashes.h"
 
+// the cache is split into partitions, each with its own lock and hash
+// table, selected by file id and addresses so threads working on
+// different files rarely contend.
+
+struct FileCacheStats
+{
+    uint64_t adds;
+    uint64_t add_fails;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t expired;
+    uint64_t contended;   // lock was held by another thread
+};
+
 class FileCache
 {
 public:
@@ -53,15 +65,16 @@ public:
     FileContext* add(const FileHashKey&);
     FileContext* find(const FileHashKey&);
 
-    static uint64_t num_add_fails;
+    // sum of all partitions
+    void get_stats(FileCacheStats&);
 
 private:
+    struct Partition;
 
-    /* The hash table of expected files */
-    SFXHASH* fileHash = nullptr;
-    uint32_t timeout = DEFAULT_FILE_BLOCK_TIMEOUT;
-    std::mutex cache_mutex;
+    Partition& get_partition(const FileHashKey&);
 
+    Partition* partitions = nullptr;
+    uint32_t timeout = DEFAULT_FILE_BLOCK_TIMEOUT;
 };
 
 #endif
@@ -30,17 +30,22 @@
 #include "config.h"
 #endif
 
-#include <sys/stat.h>
-#include <unistd.h>
-#include <string.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <string.h>
 #include <sys/types.h>
-#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "file_config.h"
 #include "file_stats.h"
 
 #include "main/snort_config.h"
+#include "main/thread_config.h"
 #include "hash/hashes.h"
 #include "utils/util.h"
 #include "utils/stats.h"
@@ -48,33 +53,137 @@
 FileMemPool* FileCapture::file_mempool = nullptr;
 File_Capture_Stats file_capture_stats;
 
-std::mutex FileCapture::capture_mutex;
-std::condition_variable FileCapture::capture_cv;
-std::thread* FileCapture::file_storer = nullptr;
-std::queue<FileCapture*> FileCapture::files_waiting;
-bool FileCapture::running = true;
+FileCaptureWriter* FileCapture::writers = nullptr;
+unsigned FileCapture::num_writers = 0;
+std::atomic<uint64_t> FileCapture::files_pending(0);
+uint64_t FileCapture::max_files_pending = 0;
+
+#define MAX_IOVS 64
 
-// Only one writer thread supported
-void FileCapture::writer_thread()
+//-------------------------------------------------------------------------
+// writers
+//
+// each writer thread has its own queue.  packet threads push files onto
+// it with a single compare and swap (a lifo stack); the writer takes the
+// whole stack at once and reverses it to restore arrival order.  the
+// mutex and condition variable are only used to park an idle writer.
+//-------------------------------------------------------------------------
+
+class FileCaptureWriter
+{
+public:
+    void start();
+    void stop();
+    void push(FileCapture*);
+
+private:
+    void run();
+    void wait();
+    FileCapture* pop_all();
+
+    std::atomic<FileCapture*> pending { nullptr };
+    std::atomic<bool> idle { false };
+    std::atomic<bool> running { false };
+
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    std::thread* thread = nullptr;
+};
+
+void FileCaptureWriter::start()
 {
-    while (1)
+    running = true;
+    thread = new std::thread(&FileCaptureWriter::run, this);
+}
+
+// files already queued are written before the thread exits
+void FileCaptureWriter::stop()
+{
+    if ( !thread )
+        return;
+
     {
-        // Wait until there are files
-        std::unique_lock<std::mutex> lk(capture_mutex);
-        capture_cv.wait(lk, [] { return !running or files_waiting.size(); });
+        std::lock_guard<std::mutex> lk(idle_mutex);
+        running = false;
+        idle_cv.notify_one();
+    }
+    thread->join();
+    delete thread;
+    thread = nullptr;
+}
 
-        if (!running)
-            break;
+void FileCaptureWriter::push(FileCapture* file)
+{
+    FileCapture* head = pending.load(std::memory_order_relaxed);
 
-        FileCapture* file = files_waiting.front();
-        files_waiting.pop();
-        lk.unlock();
+    do
+        file->next_pending = head;
+    while ( !pending.compare_exchange_weak(head, file) );
 
-        file->store_file();
-        delete file;
+    // pairs with the idle / pending check in wait()
+    if ( idle )
+    {
+        std::lock_guard<std::mutex> lk(idle_mutex);
+        idle_cv.notify_one();
     }
 }
 
+FileCapture* FileCaptureWriter::pop_all()
+{
+    FileCapture* file = pending.exchange(nullptr);
+    FileCapture* list = nullptr;
+
+    while ( file )
+    {
+        FileCapture* next = file->next_pending;
+        file->next_pending = list;
+        list = file;
+        file = next;
+    }
+    return list;
+}
+
+void FileCaptureWriter::wait()
+{
+    std::unique_lock<std::mutex> lk(idle_mutex);
+    idle = true;
+
+    if ( running and !pending )
+        idle_cv.wait(lk);
+
+    idle = false;
+}
+
+void FileCaptureWriter::run()
+{
+    while ( true )
+    {
+        FileCapture* file = pop_all();
+
+        if ( !file )
+        {
+            if ( !running )
+                break;
+
+            wait();
+            continue;
+        }
+
+        while ( file )
+        {
+            FileCapture* next = file->next_pending;
+            file->store_file();
+            delete file;
+            FileCapture::files_pending--;
+            file = next;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+// file capture
+//-------------------------------------------------------------------------
+
 FileCapture::FileCapture()
 {
     reserved = 0;
@@ -123,7 +232,19 @@ void FileCapture::init()
 {
     FileConfig& file_config = snort_conf->file_config;
     init_mempool(file_config.capture_memcap, file_config.capture_block_size);
-    file_storer = new std::thread(writer_thread);
+
+    max_files_pending = file_config.capture_queue_size;
+    num_writers = file_config.capture_writers;
+    writers = new FileCaptureWriter[num_writers];
+
+    for ( unsigned i = 0; i < num_writers; ++i )
+        writers[i].start();
+}
+
+void FileCapture::thread_term()
+{
+    if (file_mempool)
+        file_mempool->thread_term();
 }
 
 /*
@@ -132,14 +253,15 @@ void FileCapture::init()
  */
 void FileCapture::exit()
 {
-    running = false;
-    capture_cv.notify_one();
-
-    if (file_storer)
+    if (writers)
     {
-        file_storer->join();
-        delete file_storer;
-        file_storer = nullptr;
+        for ( unsigned i = 0; i < num_writers; ++i )
+            writers[i].stop();
+
+        delete[] writers;
+        writers = nullptr;
+        num_writers = 0;
+        max_files_pending = 0;
     }
 
     if (file_mempool)
@@ -171,7 +293,7 @@ void FileCapture::init_mempool(int64_t max_file_mem, int64_t block_len)
 
     int max_files = max_file_mem_in_bytes / block_size;
 
-    file_mempool = new FileMemPool(max_files, block_size);
+    file_mempool = new FileMemPool(max_files, block_size, ThreadConfig::get_instance_max());
 }
 
 inline FileCaptureBlock* FileCapture::create_file_buffer()
@@ -443,40 +565,42 @@ uint64_t FileCapture::get_capture_size() const
 /*
  * writing file data to the disk.
  *
- * In the case of interrupt errors, the write is retried, but only for a
- * finite number of times.
+ * The iovecs point directly at the mempool blocks so data is not copied
+ * again on the way out.  Short writes are resumed and interrupted writes
+ * are retried, but only for a finite number of times.
  */
-void FileCapture::write_file_data(uint8_t* buf, size_t buf_len, FILE* fh)
+bool FileCapture::write_file_data(struct iovec* iov, int iov_cnt, int fd)
 {
     int max_retries = 3;
-    size_t bytes_written = 0;
-    int err;
-
-    /* Nothing to write or nothing to write to */
-    if ((buf == nullptr) || (fh == nullptr))
-        return;
 
-    /* writing several times */
-    do
+    while (iov_cnt > 0)
     {
-        size_t bytes_left = buf_len - bytes_written;
+        ssize_t n = writev(fd, iov, iov_cnt);
+
+        if (n < 0)
+        {
+            if (((errno == EINTR) || (errno == EAGAIN)) && (--max_retries > 0))
+                continue;
 
-        bytes_written += fwrite(buf + bytes_written, 1, bytes_left, fh);
+            ErrorMessage("File inspect: disk writing error - %s!\n", get_error(errno));
+            return false;
+        }
 
-        err = ferror(fh);
-        if (err && (err != EINTR) && (err != EAGAIN))
+        while (iov_cnt > 0 && (size_t)n >= iov->iov_len)
         {
-            break;
+            n -= iov->iov_len;
+            ++iov;
+            --iov_cnt;
         }
 
-        max_retries--;
+        if (iov_cnt > 0)
+        {
+            iov->iov_base = (uint8_t*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
     }
-    while ((max_retries > 0) && (bytes_written < buf_len));
 
-    if (bytes_written < buf_len)
-    {
-        ErrorMessage("File inspect: disk writing error - %s!\n", get_error(err));
-    }
+    return true;
 }
 
 // Store files on local disk
@@ -487,50 +611,61 @@ void FileCapture::store_file()
 
     std::string& file_full_name = file_info->get_file_name();
 
-    /*Check whether the file exists*/
-    struct stat buffer;
-    if (stat (file_full_name.c_str(), &buffer) == 0)
-    {
-        return;
-    }
+    // O_EXCL skips files that are already stored
+    int fd = open(file_full_name.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
 
-    FILE* fh = fopen(file_full_name.c_str(), "w");
-    if (!fh )
-    {
+    if (fd < 0)
         return;
-    }
 
-    // Check the file buffer
+    // Gather the file buffer blocks into batches
+    struct iovec iov[MAX_IOVS];
+    int iov_cnt = 0;
     uint8_t* buff = nullptr;
     int size = 0;
     void* file_mem;
+    bool ok = true;
 
     do
     {
         file_mem = get_file_data(&buff, &size);
-        // Get file from file buffer
-        if (!buff || !size )
+
+        if (buff && size)
         {
-            return;
+            iov[iov_cnt].iov_base = buff;
+            iov[iov_cnt].iov_len = size;
+            ++iov_cnt;
         }
 
-        write_file_data(buff, size, fh);
+        if (iov_cnt && (iov_cnt == MAX_IOVS || !file_mem))
+        {
+            ok = write_file_data(iov, iov_cnt, fd);
+            iov_cnt = 0;
+        }
     }
-    while (file_mem);
+    while (ok && file_mem);
+
+    if (!ok)
+        file_capture_stats.file_store_errors++;
 
-    fclose(fh);
+    close(fd);
 }
 
 // Queue files to be stored to disk
 void FileCapture::store_file_async()
 {
-    // send data to the writer thread
-    if (!file_info)
+    // send data to a writer thread
+    if (!file_info || !writers)
+    {
+        delete this;
         return;
+    }
 
     uint8_t* sha = file_info->get_file_sig_sha256();
     if (!sha)
+    {
+        delete this;
         return;
+    }
 
     std::string file_name = file_info->sha_to_string(sha);
 
@@ -538,9 +673,18 @@ void FileCapture::store_file_async()
     get_instance_file(file_full_name, file_name.c_str());
     file_info->set_file_name(file_full_name.c_str(), file_full_name.size());
 
-    std::lock_guard<std::mutex> lk(capture_mutex);
-    files_waiting.push(this);
-    capture_cv.notify_one();
+    // the same file always goes to the same writer
+    uint32_t hash;
+    memcpy(&hash, sha, sizeof(hash));
+
+    files_pending++;
+    writers[hash % num_writers].push(this);
+}
+
+// the writers are not running before init() so there is nothing to back up
+bool FileCapture::is_backlogged()
+{
+    return max_files_pending && files_pending >= max_files_pending;
 }
 
 /*Log file capture mempool usage*/
@@ -548,10 +692,17 @@ void FileCapture::print_mem_usage()
 {
     if (file_mempool)
     {
+        FileMemPoolStats stats;
+        file_mempool->get_stats(stats);
+
         LogCount("Max buffers can allocate", file_mempool->total_objects());
         LogCount("Buffers in use", file_mempool->allocated());
-        LogCount("Buffers in free list", file_mempool->freed());
-        LogCount("Buffers in release list", file_mempool->released());
+        LogCount("Buffers in depot", file_mempool->freed());
+        LogCount("Buffers released", file_mempool->released());
+        LogCount("Buffer magazine hits", stats.magazine_hits);
+        LogCount("Buffer depot pops", stats.depot_pops);
+        LogCount("Buffer depot pushes", stats.depot_pushes);
+        LogCount("Buffer depot retries", stats.depot_retries);
     }
 }
 
@@ -31,15 +31,14 @@
 // 3) Then file data can be read through file_capture_read()
 // 4) Finally, fila data must be released from mempool file_capture_release()
 
-#include <condition_variable>
-#include <mutex>
-#include <queue>
-#include <thread>
+#include <atomic>
 
 #include "file_api.h"
 #include "file_lib.h"
 #include "file_mempool.h"
 
+class FileCaptureWriter;
+
 struct FileCaptureBlock
 {
     uint32_t length;
@@ -83,6 +82,10 @@ public:
     // Store file to disk asynchronously
     void store_file_async();
 
+    // True when the writers have fallen behind; new files should not be
+    // captured until the backlog drains
+    static bool is_backlogged();
+
     // Log file capture mempoofile_contentl usage
     static void print_mem_usage();
 
@@ -90,21 +93,27 @@ public:
     // this must be called when snort exits
     static void exit();
 
+    // Return this packet thread's cached buffers to the mempool,
+    // this must be called when a packet thread exits
+    static void thread_term();
+
 private:
 
+    friend class FileCaptureWriter;
+
     static void init_mempool(int64_t max_file_mem, int64_t block_size);
-    static void writer_thread();
     inline FileCaptureBlock* create_file_buffer();
     inline FileCaptureState save_to_file_buffer(const uint8_t* file_data, int data_size,
         int64_t max_size);
-    void write_file_data(uint8_t* buf, size_t buf_len, FILE* fh);
+    bool write_file_data(struct iovec*, int iov_cnt, int fd);
 
     static FileMemPool* file_mempool;
-    static std::mutex capture_mutex;
-    static std::condition_variable capture_cv;
-    static std::thread* file_storer;
-    static std::queue<FileCapture*> files_waiting;
-    static bool running;
+    static FileCaptureWriter* writers;
+    static unsigned num_writers;
+    static std::atomic<uint64_t> files_pending;
+    static uint64_t max_files_pending;
+
+    FileCapture* next_pending = nullptr;  /* writer queue link */
 
     bool reserved;
     uint64_t capture_size;
@@ -135,6 +144,8 @@ struct File_Capture_Stats
     uint64_t file_buffers_released_total;
     uint64_t file_buffers_free_errors;
     uint64_t file_buffers_release_errors;
+    uint64_t files_backlogged;        /* not captured while writers were behind */
+    uint64_t file_store_errors;
 };
 
 extern File_Capture_Stats file_capture_stats;
@@ -37,6 +37,8 @@
 #define DEFAULT_FILE_CAPTURE_MAX_SIZE       1048576     // 1 MiB
 #define DEFAULT_FILE_CAPTURE_MIN_SIZE       0           // 0
 #define DEFAULT_FILE_CAPTURE_BLOCK_SIZE     32768       // 32 KiB
+#define DEFAULT_FILE_CAPTURE_WRITERS        1
+#define DEFAULT_FILE_CAPTURE_QUEUE_SIZE     64
 #define DEFAULT_MAX_FILES_CACHED            65536
 
 class FileConfig
@@ -59,6 +61,8 @@ public:
     int64_t capture_max_size = DEFAULT_FILE_CAPTURE_MAX_SIZE;
     int64_t capture_min_size = DEFAULT_FILE_CAPTURE_MIN_SIZE;
     int64_t capture_block_size = DEFAULT_FILE_CAPTURE_BLOCK_SIZE;
+    int64_t capture_writers = DEFAULT_FILE_CAPTURE_WRITERS;
+    int64_t capture_queue_size = DEFAULT_FILE_CAPTURE_QUEUE_SIZE;
     int64_t file_depth =  0;
     int64_t max_files_cached = DEFAULT_MAX_FILES_CACHED;
 
@@ -25,11 +25,13 @@
  **
  */
 
+#include "file_mempool.h"
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
 
-#include "file_mempool.h"
+#include "main/thread.h"
 #include "utils/util.h"
 
 /*This magic is used for double free detection*/
@@ -37,38 +39,24 @@
 #define FREE_MAGIC    0x2525252525252525
 typedef uint64_t MagicType;
 
-#ifdef DEBUG_MSGS
-void FileMemPool::verify()
-{
-    uint64_t free_size;
-    uint64_t release_size;
+// free objects are linked through the word after the magic
+#define LINK_OFFSET   sizeof(MagicType)
 
-    free_size = cbuffer_used(free_list);
-    release_size = cbuffer_used(released_list);
+#define MAGAZINE_SIZE 32
 
-    if (free_size > cbuffer_size(free_list))
-    {
-        ErrorMessage("%s(%d) file_mempool: failed to verify free list!\n",
-            __FILE__, __LINE__);
-    }
-
-    if (release_size > cbuffer_size(released_list))
-    {
-        ErrorMessage("%s(%d) file_mempool: failed to verify release list!\n",
-            __FILE__, __LINE__);
-    }
+struct FileMemMagazine
+{
+    uint64_t pool_id;
+    unsigned count;
+    uint64_t hits;
+    void* objs[MAGAZINE_SIZE];
+};
 
-    /* The free mempool and size of release mempool should be smaller than
-     * or equal to the size of mempool
-     */
-    if (free_size + release_size > total)
-    {
-        ErrorMessage("%s(%d) file_mempool: failed to verify mempool size!\n",
-            __FILE__, __LINE__);
-    }
-}
+static THREAD_LOCAL FileMemMagazine magazine;
+static std::atomic<uint64_t> next_pool_id(1);
 
-#endif
+static inline std::atomic<uint32_t>& link(void* obj)
+{ return *(std::atomic<uint32_t>*)((uint8_t*)obj + LINK_OFFSET); }
 
 void FileMemPool::free_pools()
 {
@@ -77,9 +65,10 @@ void FileMemPool::free_pools()
         snort_free(datapool);
         datapool = nullptr;
     }
-
-    cbuffer_free(free_list);
-    cbuffer_free(released_list);
+    total = 0;
+    depot = 0;
+    depot_count = 0;
+    num_allocated = 0;
 }
 
 /*
@@ -87,63 +76,170 @@ void FileMemPool::free_pools()
  * Args:
  *   num_objects - number of items in this pool
  *   obj_size    - size of the items
+ *   num_threads - number of threads that allocate
  */
 
-FileMemPool::FileMemPool(uint64_t num_objects, size_t o_size)
+FileMemPool::FileMemPool(uint64_t num_objects, size_t o_size, unsigned num_threads)
 {
-    unsigned int i;
+    id = next_pool_id++;
 
-    if ((num_objects < 1) || (o_size < 1))
+    if ((num_objects < 1) || (o_size < LINK_OFFSET + sizeof(uint32_t)))
         return;
 
+    if (num_objects >= UINT32_MAX)
+    {
+        ErrorMessage("%s(%d) file_mempool: too many objects\n",
+            __FILE__, __LINE__);
+        return;
+    }
+
     obj_size = o_size;
 
     // this is the basis pool that represents all the *data pointers in the list
     datapool = (void**)snort_calloc(num_objects, obj_size);
 
-    /* sets up the memory list */
-    free_list = cbuffer_init(num_objects);
-    if (!free_list)
+    /* sets up the depot, lowest addresses on top */
+    for (uint64_t i = num_objects; i > 0; i--)
     {
-        ErrorMessage("%s(%d) file_mempool: Failed to init free list\n",
-            __FILE__, __LINE__);
-        free_pools();
-        return;
+        void* data = ((char*)datapool) + ((i - 1) * obj_size);
+        *(MagicType*)data = FREE_MAGIC;
+        link(data).store((uint32_t)depot.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        depot.store(i, std::memory_order_relaxed);
     }
+    total = num_objects;
+    depot_count = num_objects;
+
+    // limit what can be stranded in all magazines to a small part of the pool
+    magazine_size = total / (16 * (num_threads ? num_threads : 1));
 
-    released_list = cbuffer_init(num_objects);
-    if (!released_list)
+    if (magazine_size > MAGAZINE_SIZE)
+        magazine_size = MAGAZINE_SIZE;
+    else if (magazine_size < 2)
+        magazine_size = 2;
+}
+
+/*
+ * Destroy a set of FileMemPool objects
+ *
+ */
+FileMemPool::~FileMemPool()
+{
+    free_pools();
+}
+
+//-------------------------------------------------------------------------
+// depot
+//
+// the head holds the index + 1 of the top object in the low 32 bits and
+// a tag in the high 32 bits which changes on every update so a pop can't
+// succeed against a head that was popped and pushed back in between.
+//-------------------------------------------------------------------------
+
+void FileMemPool::depot_push(void* obj)
+{
+    uint64_t index = ((char*)obj - (char*)datapool) / obj_size + 1;
+    uint64_t head = depot.load(std::memory_order_relaxed);
+    uint64_t retries = 0;
+
+    while (true)
     {
-        ErrorMessage("%s(%d) file_mempool: "
-            "Failed to init release list\n", __FILE__, __LINE__);
-        free_pools();
-        return;
+        link(obj).store((uint32_t)head, std::memory_order_relaxed);
+        uint64_t top = (((head >> 32) + 1) << 32) | index;
+
+        if (depot.compare_exchange_weak(head, top,
+            std::memory_order_release, std::memory_order_relaxed))
+            break;
+
+        ++retries;
     }
 
-    for (i=0; i<num_objects; i++)
+    if (retries)
+        depot_retries += retries;
+}
+
+bool FileMemPool::depot_pop(void*& obj)
+{
+    uint64_t head = depot.load(std::memory_order_acquire);
+    uint64_t retries = 0;
+
+    while (true)
     {
-        void* data = ((char*)datapool) + (i * obj_size);
+        uint32_t index = (uint32_t)head;
 
-        if (cbuffer_write(free_list,  data))
+        if (!index)
+            break;
+
+        // the object may be taken and overwritten by another thread before
+        // the cas; then the tag has changed and the cas fails
+        void* top = ((char*)datapool) + ((index - 1) * obj_size);
+        uint32_t next = link(top).load(std::memory_order_relaxed);
+        uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+
+        if (depot.compare_exchange_weak(head, new_head,
+            std::memory_order_acquire, std::memory_order_acquire))
         {
-            ErrorMessage("%s(%d) file_mempool: "
-                "Failed to add to free list\n",
-                __FILE__, __LINE__);
-            free_pools();
-            return;
+            obj = top;
+            break;
         }
-        *(MagicType*)data = FREE_MAGIC;
-        total++;
+        ++retries;
     }
+
+    if (retries)
+        depot_retries += retries;
+
+    return (uint32_t)head != 0;
 }
 
-/*
- * Destroy a set of FileMemPool objects
- *
- */
-FileMemPool::~FileMemPool()
+//-------------------------------------------------------------------------
+// magazines
+//-------------------------------------------------------------------------
+
+// a magazine left over from a deleted pool is simply dropped
+FileMemMagazine* FileMemPool::get_magazine()
 {
-    free_pools();
+    if (magazine.pool_id != id)
+    {
+        magazine.pool_id = id;
+        magazine.count = 0;
+        magazine.hits = 0;
+    }
+    return &magazine;
+}
+
+void FileMemPool::refill(FileMemMagazine* m)
+{
+    unsigned n = 0;
+    void* obj;
+
+    while (m->count < magazine_size / 2 and depot_pop(obj))
+    {
+        m->objs[m->count++] = obj;
+        n++;
+    }
+
+    depot_count -= n;
+    depot_pops += n;
+
+    magazine_hits += m->hits;
+    m->hits = 0;
+}
+
+void FileMemPool::flush(FileMemMagazine* m, unsigned keep)
+{
+    unsigned n = 0;
+
+    while (m->count > keep)
+    {
+        depot_push(m->objs[--m->count]);
+        n++;
+    }
+
+    depot_count += n;
+    depot_pushes += n;
+
+    magazine_hits += m->hits;
+    m->hits = 0;
 }
 
 /*
@@ -157,17 +253,30 @@ FileMemPool::~FileMemPool()
 
 void* FileMemPool::m_alloc()
 {
-    void* b = NULL;
+    if (!datapool)
+        return nullptr;
 
-    std::lock_guard<std::mutex> lock(pool_mutex);
+    FileMemMagazine* m = get_magazine();
 
-    if (cbuffer_read(free_list, &b))
+    if (m->count)
     {
-        if (cbuffer_read(released_list, &b))
+        // counts are published in batches to keep the atomic off the
+        // fast path
+        if (++m->hits == MAGAZINE_SIZE * 32)
         {
-            return NULL;
+            magazine_hits += m->hits;
+            m->hits = 0;
         }
     }
+    else
+    {
+        refill(m);
+
+        if (!m->count)
+            return nullptr;
+    }
+
+    void* b = m->objs[--m->count];
 
     if (*(MagicType*)b != FREE_MAGIC)
     {
@@ -175,83 +284,101 @@ void* FileMemPool::m_alloc()
             __FILE__, __LINE__);
     }
 
-    DEBUG_WRAP(verify(); );
+    // so a double free of this object is caught
+    *(MagicType*)b = 0;
+    num_allocated++;
 
     return b;
 }
 
 /*
- * Free a new object from the buffer
- * We use circular buffer to synchronize one reader and one writer
+ * Check and mark an object being returned to the pool
  */
-int FileMemPool::remove(CircularBuffer* cb, void* obj)
+bool FileMemPool::mark_free(void* obj)
 {
-    if (obj == nullptr)
-        return FILE_MEM_FAIL;
-
-    if (cbuffer_write(cb, obj))
-    {
-        return FILE_MEM_FAIL;
-    }
+    if (obj == nullptr or !datapool)
+        return false;
 
     if (*(MagicType*)obj == FREE_MAGIC)
     {
         DEBUG_WRAP(ErrorMessage("%s(%d) file_mempool_remove(): Double free! \n",
                 __FILE__, __LINE__); );
-        return FILE_MEM_FAIL;
+        return false;
     }
 
     *(MagicType*)obj = FREE_MAGIC;
+    num_allocated--;
 
-    return FILE_MEM_SUCCESS;
+    return true;
 }
 
+/*
+ * Return an object to the calling thread's magazine, spilling half of
+ * it to the depot when full.
+ */
 int FileMemPool::m_free(void* obj)
 {
-    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (!mark_free(obj))
+        return FILE_MEM_FAIL;
+
+    FileMemMagazine* m = get_magazine();
 
-    int ret = remove(free_list, obj);
+    if (m->count == magazine_size)
+        flush(m, magazine_size / 2);
 
-    DEBUG_WRAP(verify(); );
+    m->objs[m->count++] = obj;
 
-    return ret;
+    return FILE_MEM_SUCCESS;
 }
 
 /*
  * Release a new object from the FileMemPool
  * This can be called by a different thread calling
  * file_mempool_alloc()
- *  *
  */
-
 int FileMemPool::m_release(void* obj)
 {
-    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (!mark_free(obj))
+        return FILE_MEM_FAIL;
 
-    /*A writer that might from different thread*/
-    int ret = remove(released_list, obj);
+    depot_push(obj);
+    depot_count++;
+    depot_pushes++;
+    num_released++;
 
-    DEBUG_WRAP(verify(); );
+    return FILE_MEM_SUCCESS;
+}
 
-    return ret;
+void FileMemPool::thread_term()
+{
+    if (datapool)
+        flush(get_magazine(), 0);
 }
 
-/* Returns number of elements allocated in current buffer*/
+/* Returns number of elements allocated; objects cached in thread
+ * magazines are free and not counted */
 uint64_t FileMemPool::allocated()
 {
-    uint64_t total_freed = released() + freed();
-    return (total - total_freed);
+    return num_allocated;
 }
 
-/* Returns number of elements freed in current buffer*/
+/* Returns number of elements in the depot */
 uint64_t FileMemPool::freed()
 {
-    return (cbuffer_used(free_list));
+    return depot_count;
 }
 
-/* Returns number of elements released in current buffer*/
+/* Returns number of elements released so far */
 uint64_t FileMemPool::released()
 {
-    return (cbuffer_used(released_list));
+    return num_released;
+}
+
+void FileMemPool::get_stats(FileMemPoolStats& stats)
+{
+    stats.magazine_hits = magazine_hits;
+    stats.depot_pops = depot_pops;
+    stats.depot_pushes = depot_pushes;
+    stats.depot_retries = depot_retries;
 }
 
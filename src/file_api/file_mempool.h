@@ -23,25 +23,38 @@
 #define FILE_MEMPOOL_H
 
 //  This mempool implementation has very efficient alloc/free operations.
-//  In addition, it provides thread-safe alloc/free for one allocation/free
-//  thread and one release thread.
+//  Each thread keeps a small magazine of free objects so most alloc/free
+//  calls touch only thread local memory.  Magazines are refilled from and
+//  flushed to a shared depot, a lock free stack of object indices tagged
+//  against ABA.  Any thread may alloc, free or release.  Threads that
+//  allocate must call thread_term() before they exit.
 //  One more bonus: Double free detection is also added into this library
-//  This is a thread safe version of memory pool for one writer and one reader thread
 
-#include <mutex>
+#include <atomic>
 
 #include "main/snort_types.h"
 #include "main/snort_debug.h"
-#include "circular_buffer.h"
 
 #define FILE_MEM_SUCCESS    0  // FIXIT-L use bool
 #define FILE_MEM_FAIL      -1
 
+struct FileMemMagazine;
+
+struct FileMemPoolStats
+{
+    uint64_t magazine_hits;   // allocs served from the thread's magazine
+    uint64_t depot_pops;      // objects taken from the depot
+    uint64_t depot_pushes;    // objects returned to the depot
+    uint64_t depot_retries;   // depot cas failures due to contention
+};
+
 class FileMemPool
 {
 public:
 
-    FileMemPool(uint64_t num_objects, size_t obj_size);
+    // magazines are sized so that num_threads of them hold a small part
+    // of the pool
+    FileMemPool(uint64_t num_objects, size_t obj_size, unsigned num_threads = 1);
     ~FileMemPool();
 
     // Allocate a new object from the FileMemPool
@@ -49,40 +62,60 @@ public:
     // Returns: a pointer to the FileMemPool object on success, nullptr on failure
     void* m_alloc();
 
-    // This must be called by the same thread calling file_mempool_alloc()
+    // Return an object to the pool; may be called from any thread
     // Return: FILE_MEM_SUCCESS or FILE_MEM_FAIL
     int m_free(void* obj);
 
-    // This can be called by a different thread calling file_mempool_alloc()
+    // Same as m_free but counted separately, for objects handed off to
+    // another thread (e.g. a file capture writer).  The object goes
+    // straight to the depot since the releasing thread may never allocate.
     // Return: FILE_MEM_SUCCESS or FILE_MEM_FAIL
     int m_release(void* obj);
 
+    // Return the calling thread's magazine to the depot
+    void thread_term();
+
     //Returns number of elements allocated
     uint64_t allocated();
 
-    // Returns number of elements freed in current buffer
+    // Returns number of elements in the depot
     uint64_t freed();
 
-    // Returns number of elements released in current buffer
+    // Returns number of elements released so far
     uint64_t released();
 
     // Returns total number of elements in current buffer
     uint64_t total_objects() { return total; }
 
-private:
+    void get_stats(FileMemPoolStats&);
 
+private:
     void free_pools();
-    int remove(CircularBuffer* cb, void* obj);
-#ifdef DEBUG_MSGS
-    void verify();
-#endif
-
-    void** datapool; /* memory buffer */
-    uint64_t total;
-    CircularBuffer* free_list;
-    CircularBuffer* released_list;
-    size_t obj_size;
-    std::mutex pool_mutex;
+    bool mark_free(void* obj);
+
+    FileMemMagazine* get_magazine();
+    void refill(FileMemMagazine*);
+    void flush(FileMemMagazine*, unsigned keep);
+
+    bool depot_pop(void*&);
+    void depot_push(void*);
+
+    void** datapool = nullptr; /* memory buffer */
+    uint64_t total = 0;
+    size_t obj_size = 0;
+    unsigned magazine_size = 0;
+    uint64_t id;
+
+    // index + 1 of the top object in the low half, aba tag in the high
+    std::atomic<uint64_t> depot { 0 };
+    std::atomic<uint64_t> depot_count { 0 };
+    std::atomic<uint64_t> num_allocated { 0 };
+    std::atomic<uint64_t> num_released { 0 };
+
+    std::atomic<uint64_t> magazine_hits { 0 };
+    std::atomic<uint64_t> depot_pops { 0 };
+    std::atomic<uint64_t> depot_pushes { 0 };
+    std::atomic<uint64_t> depot_retries { 0 };
 };
 
 #endif
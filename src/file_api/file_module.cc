@@ -60,6 +60,12 @@ bool FileIdModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("capture_block_size") )
         fc.capture_block_size = v.get_long();
 
+    else if ( v.is("capture_writers") )
+        fc.capture_writers = v.get_long();
+
+    else if ( v.is("capture_queue_size") )
+        fc.capture_queue_size = v.get_long();
+
     else if ( v.is("max_files_cached") )
         fc.max_files_cached = v.get_long();
 
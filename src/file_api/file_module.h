@@ -137,6 +137,12 @@ static const Parameter file_id_params[] =
     { "capture_block_size", Parameter::PT_INT, "8:", "32768",
       "file capture block size in bytes" },
 
+    { "capture_writers", Parameter::PT_INT, "1:32", "1",
+      "number of threads writing captured files to disk" },
+
+    { "capture_queue_size", Parameter::PT_INT, "1:", "64",
+      "stop capturing new files while this many are waiting to be written" },
+
     { "max_files_cached", Parameter::PT_INT, "8:", "65536",
       "maximal number of files cached in memory" },
 
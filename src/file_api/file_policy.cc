@@ -141,12 +141,19 @@ FileVerdict FilePolicy::match_file_signature(Flow*, FileInfo* file)
     return FILE_VERDICT_UNKNOWN;
 }
 
+// don't buffer new files while the capture writers are behind; this
+// keeps the capture mempool from filling up with files waiting on disk
+static bool capture_allowed(bool enabled)
+{
+    return enabled and !FileCapture::is_backlogged();
+}
+
 void FilePolicy::policy_check(Flow*, FileContext* file)
 {
     // TODO: enable based on file policy rules on flow
     file->config_file_type(type_enabled);
     file->config_file_signature(signature_enabled);
-    file->config_file_capture(capture_enabled);
+    file->config_file_capture(capture_allowed(capture_enabled));
 }
 
 FileVerdict FilePolicy::type_lookup(Flow* flow, FileInfo* file)
@@ -163,7 +170,14 @@ FileVerdict FilePolicy::type_lookup(Flow* flow, FileContext* file)
     type_lookup(flow, (FileInfo*)file);
     FileRule rule = match_file_rule(nullptr, file);
     file->config_file_signature(rule.use.signature_enabled);
-    file->config_file_capture(rule.use.capture_enabled);
+
+    if ( rule.use.capture_enabled and !capture_allowed(true) )
+    {
+        file_capture_stats.files_backlogged++;
+        file->config_file_capture(false);
+    }
+    else
+        file->config_file_capture(rule.use.capture_enabled);
 
     return rule.use.verdict;
 }
@@ -186,8 +200,15 @@ FileVerdict FilePolicy::signature_lookup(Flow* flow, FileContext* file)
     {
         FileCapture* captured = nullptr;
 
-        if (file->reserve_file(captured) == FILE_CAPTURE_SUCCESS)
+        if ( file->is_file_capture_enabled() and !capture_allowed(true) )
+        {
+            file_capture_stats.files_backlogged++;
+            file->stop_file_capture();
+        }
+        else if (file->reserve_file(captured) == FILE_CAPTURE_SUCCESS)
             captured->store_file_async();
+        else
+            delete captured;
     }
 
     return (signature_lookup(flow, (FileInfo*)file));
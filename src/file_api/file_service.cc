@@ -79,12 +79,20 @@ void FileService::close()
     if (file_enforcer)
         delete file_enforcer;
     if (file_cache)
+    {
         delete file_cache;
+        file_cache = nullptr;
+    }
 
     MimeSession::exit();
     FileCapture::exit();
 }
 
+void FileService::thread_term()
+{
+    FileCapture::thread_term();
+}
+
 void FileService::start_file_processing()
 {
     if (!file_processing_initiated)
@@ -35,6 +35,7 @@
 #include "file_capture.h"
 #include "file_cache.h"
 #include "file_config.h"
+#include "file_service.h"
 
 #include "main/snort_types.h"
 #include "main/snort_config.h"
@@ -274,6 +275,8 @@ void print_file_stats()
         LogCount("Reserve failures", file_capture_stats.file_reserve_failures);
         LogCount("File capture size min", file_capture_stats.file_size_min);
         LogCount("File capture size max", file_capture_stats.file_size_max);
+        LogCount("Files skipped while writers behind", file_capture_stats.files_backlogged);
+        LogCount("File store errors", file_capture_stats.file_store_errors);
         LogCount("File signature max", file_stats.files_sig_depth);
 
         FileCapture::print_mem_usage();
@@ -282,7 +285,18 @@ void print_file_stats()
     LogLabel("file stats summary");
     LogCount("Files processed",file_stats.files_total);
     LogCount("Files data processed", file_stats.file_data_total);
-    if(FileCache::num_add_fails)
-        LogCount("Fails to add to cache", FileCache::num_add_fails);
+
+    if (FileCache* file_cache = FileService::get_file_cache())
+    {
+        FileCacheStats stats;
+        file_cache->get_stats(stats);
+
+        LogCount("Files added to cache", stats.adds);
+        LogCount("Fails to add to cache", stats.add_fails);
+        LogCount("Cache hits", stats.hits);
+        LogCount("Cache misses", stats.misses);
+        LogCount("Cache entries expired", stats.expired);
+        LogCount("Cache lock contention", stats.contended);
+    }
 }
 
@@ -25,6 +25,7 @@
 #endif
 
 #include "flow/ha.h"
+#include "hash/clock_hash.h"
 #include "hash/zhash.h"
 #include "helpers/flag_context.h"
 #include "ips_options/ips_flowbits.h"
@@ -41,7 +42,11 @@
 
 FlowCache::FlowCache (const FlowConfig& cfg) : config(cfg)
 {
-    hash_table = new ZHash(config.max_sessions, sizeof(FlowKey));
+    if ( config.hash_type == FlowHashType::CLOCK )
+        hash_table = new ClockHash(config.max_sessions, sizeof(FlowKey));
+    else
+        hash_table = new ZHash(config.max_sessions, sizeof(FlowKey));
+
     hash_table->set_keyops(FlowKey::hash, FlowKey::compare);
 
     uni_head = new Flow;
@@ -295,6 +300,7 @@ unsigned FlowCache::timeout(unsigned num_flows, time_t thetime)
 {
     // FIXIT-H should Active be suspended here too?
     unsigned retired = 0;
+    unsigned skipped = 0;
 
     auto flow = static_cast<Flow*>(hash_table->current());
 
@@ -304,7 +310,15 @@ unsigned FlowCache::timeout(unsigned num_flows, time_t thetime)
     while ( flow and (retired < num_flows) )
     {
         if ( flow->last_data_seen + config.nominal_timeout > thetime )
-            break;
+        {
+            // ZHash walks in LRU order so the rest are newer; CLOCK order is
+            // not time order so keep looking, but only so far per call
+            if ( config.hash_type != FlowHashType::CLOCK or ++skipped >= num_flows )
+                break;
+
+            flow = static_cast<Flow*>(hash_table->next());
+            continue;
+        }
 
         if ( HighAvailabilityManager::in_standby(flow) )
         {
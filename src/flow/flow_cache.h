@@ -23,7 +23,7 @@
 #define FLOW_CACHE_H
 
 // there is a FlowCache instance for each protocol.
-// Flows are stored in a ZHash instance by FlowKey.
+// Flows are stored in a ZHash or ClockHash instance by FlowKey.
 
 #include <ctime>
 #include <type_traits>
@@ -81,7 +81,7 @@ private:
     unsigned uni_count;
     uint32_t flags;
 
-    class ZHash* hash_table;
+    class CacheHash* hash_table;
     Flow* uni_head, * uni_tail;
     PruneStats prune_stats;
 };
@@ -23,11 +23,18 @@
 
 // configured by the stream module for each cache instance
 
+enum class FlowHashType
+{
+    ZHASH,  // chained rows with exact LRU
+    CLOCK   // open addressed with approximate (CLOCK) LRU
+};
+
 struct FlowConfig
 {
     unsigned max_sessions = 0;
     unsigned pruning_timeout = 0;
     unsigned nominal_timeout = 0;
+    FlowHashType hash_type = FlowHashType::ZHASH;
 };
 
 #endif
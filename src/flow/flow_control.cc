@@ -217,10 +217,10 @@ bool FlowControl::prune_one(PruneReason reason, bool do_cleanup)
     return cache ? cache->prune_one(reason, do_cleanup) : false;
 }
 
-void FlowControl::timeout_flows(time_t cur_time)
+unsigned FlowControl::timeout_flows(time_t cur_time, unsigned max_flows)
 {
     if ( !types.size() )
-        return;
+        return 0;
 
     Active::suspend();
     FlowCache* fc = get_cache(types[next]);
@@ -228,10 +228,13 @@ void FlowControl::timeout_flows(time_t cur_time)
     if ( ++next >= types.size() )
         next = 0;
 
+    unsigned retired = 0;
+
     if ( fc )
-        fc->timeout(1, cur_time);
+        retired = fc->timeout(max_flows, cur_time);
 
     Active::resume();
+    return retired;
 }
 
 void FlowControl::preemptive_cleanup()
@@ -72,7 +72,7 @@ public:
     void purge_flows(PktType);
     bool prune_one(PruneReason, bool do_cleanup);
 
-    void timeout_flows(time_t cur_time);
+    unsigned timeout_flows(time_t cur_time, unsigned max_flows = 1);
 
     char expected_flow(Flow*, Packet*);
     bool is_expected(Packet*);
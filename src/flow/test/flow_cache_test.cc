@@ -0,0 +1,158 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// flow_cache_test.cc
+// unit tests for FlowCache timeouts with each hash table backend
+
+#include "flow/flow_cache.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <cstring>
+
+#include "flow/flow.h"
+#include "flow/ha.h"
+#include "hash/sfhashfcn.h"
+#include "main/thread.h"
+#include "packet_io/active.h"
+
+struct SnortConfig;
+THREAD_LOCAL SnortConfig* snort_conf = nullptr;
+THREAD_LOCAL bool Active::active_suspend = false;
+
+static time_t s_packet_time = 0;
+
+time_t packet_time()
+{ return s_packet_time; }
+
+bool HighAvailabilityManager::in_standby(Flow*)
+{ return false; }
+
+Flow::Flow()
+{ memset(&ssn_state, 0, sizeof(ssn_state)); next = prev = nullptr; }
+
+Flow::~Flow() { }
+void Flow::term() { }
+void Flow::reset(bool) { }
+
+uint32_t FlowKey::hash(SFHASHFCN*, unsigned char* d, int n)
+{
+    uint32_t h = 0;
+
+    for ( int i = 0; i < n; ++i )
+        h = h * 31 + d[i];
+
+    return h;
+}
+
+int FlowKey::compare(const void* s1, const void* s2, size_t n)
+{ return memcmp(s1, s2, n); }
+
+//-------------------------------------------------------------------------
+// timeout tests
+//-------------------------------------------------------------------------
+
+static const unsigned max_flows = 1024;
+static const unsigned timeout_secs = 60;
+
+static void make_key(FlowKey& key, unsigned id)
+{
+    memset(&key, 0, sizeof(key));
+    key.ip_l[0] = id;
+    key.port_l = id & 0xffff;
+}
+
+// fill the cache at time 0, then refresh every 16th flow so the live flows
+// are spread across the table and some sit in front of expired ones
+static void fill(FlowCache& cache, Flow* flows)
+{
+    FlowKey key;
+
+    for ( unsigned i = 0; i < max_flows; ++i )
+        cache.push(flows + i);
+
+    s_packet_time = 0;
+
+    for ( unsigned i = 0; i < max_flows; ++i )
+    {
+        make_key(key, i);
+        CHECK(cache.get(&key) != nullptr);
+    }
+
+    s_packet_time = timeout_secs;
+
+    for ( unsigned i = 0; i < max_flows; i += 16 )
+    {
+        make_key(key, i);
+        CHECK(cache.find(&key) != nullptr);
+    }
+}
+
+static void retire_all(FlowHashType type)
+{
+    FlowConfig fc;
+    fc.max_sessions = max_flows;
+    fc.pruning_timeout = timeout_secs;
+    fc.nominal_timeout = timeout_secs;
+    fc.hash_type = type;
+
+    Flow* flows = new Flow[max_flows];
+    FlowCache* cache = new FlowCache(fc);
+
+    fill(*cache, flows);
+
+    const unsigned live = max_flows / 16;
+    const unsigned expired = max_flows - live;
+    const time_t now = timeout_secs + 1;
+
+    unsigned retired = 0;
+    unsigned calls = 0;
+
+    // idle processing retires a few flows per call; every expired flow
+    // must go within a bounded number of calls
+    while ( retired < expired and calls < 4 * expired )
+    {
+        retired += cache->timeout(8, now);
+        ++calls;
+    }
+
+    CHECK(retired == expired);
+    CHECK(cache->get_count() == live);
+    CHECK(cache->timeout(8, now) == 0);
+
+    delete cache;
+    delete[] flows;
+}
+
+TEST_GROUP(flow_cache) { };
+
+TEST(flow_cache, timeout_zhash)
+{
+    retire_all(FlowHashType::ZHASH);
+}
+
+TEST(flow_cache, timeout_clock)
+{
+    retire_all(FlowHashType::CLOCK);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
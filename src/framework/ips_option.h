@@ -72,6 +72,10 @@ public:
 
     // packet threads
     virtual bool is_relative() { return false; }
+
+    // true if eval only tests decoded header fields of the packet (not the
+    // cursor, flow, or payload data) so it is the same for all rules
+    virtual bool is_header_only() { return false; }
     virtual bool fp_research() { return false; }
     virtual int eval(class Cursor&, Packet*) { return true; }
     virtual bool retry() { return false; }
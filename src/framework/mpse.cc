@@ -60,6 +60,61 @@ int Mpse::search(
     return ret;
 }
 
+int Mpse::search_stream(
+    Flow* flow, bool to_server, uint32_t seq, const unsigned char* T, int n,
+    MpseMatch match, void* context, int* current_state)
+{
+    if ( !flow )
+        return search(T, n, match, context, current_state);
+
+    Profile profile(mpsePerfStats);
+
+    int ret = _search_stream(flow, to_server, seq, T, n, match, context, current_state);
+
+    if ( inc_global_counter )
+        s_bcnt += n;
+
+    return ret;
+}
+
+void Mpse::search_batch(MpseBatchItem* items, unsigned count, MpseMatch match)
+{
+    Profile profile(mpsePerfStats);
+    unsigned i = 0;
+
+    while ( i < count )
+    {
+        const MpseApi* type = items[i].so->get_api();
+        unsigned j = i + 1;
+
+        while ( j < count and items[j].so->get_api() == type )
+            ++j;
+
+        items[i].so->_search_batch(items + i, j - i, match);
+
+        for ( ; i < j; ++i )
+        {
+            if ( items[i].so->inc_global_counter )
+                s_bcnt += items[i].len;
+        }
+    }
+}
+
+void Mpse::_search_batch(MpseBatchItem* items, unsigned count, MpseMatch match)
+{
+    for ( unsigned i = 0; i < count; ++i )
+    {
+        MpseBatchItem& item = items[i];
+        int state = 0;
+
+        if ( item.flow )
+            item.so->_search_stream(item.flow, item.to_server, item.seq,
+                item.buf, item.len, match, item.context, &state);
+        else
+            item.so->_search(item.buf, item.len, match, item.context, &state);
+    }
+}
+
 int Mpse::search_all(
     const unsigned char* T, int n, MpseMatch match,
     void* context, int* current_state)
@@ -41,6 +41,22 @@
 struct SnortConfig;
 struct MpseApi;
 struct ProfileStats;
+class Flow;
+class Mpse;
+
+// one buffer of a batch search.  each item may use a different engine
+// instance and match context.  flow is set only for stream searches and
+// seq is then the sequence number of the first byte of buf.
+struct MpseBatchItem
+{
+    Mpse* so;
+    const uint8_t* buf;
+    int len;
+    void* context;
+    Flow* flow;
+    bool to_server;
+    uint32_t seq;
+};
 
 class SO_PUBLIC Mpse
 {
@@ -69,12 +85,36 @@ public:
 
     virtual int prep_patterns(SnortConfig*) = 0;
 
+    // prep_patterns() may be split in two so that independent instances can
+    // be compiled concurrently.  prep_compile() must not call the agent or
+    // touch anything shared with other instances.  prep_trees() completes
+    // the work on the main thread.  by default it is all done in the latter.
+    virtual int prep_compile(SnortConfig*) { return 0; }
+    virtual int prep_trees(SnortConfig* sc) { return prep_patterns(sc); }
+
+    // instances returning the same nonzero key would write the same result,
+    // eg to a shared cache, so they are not compiled concurrently
+    virtual uint64_t get_compile_key(SnortConfig*) { return 0; }
+
     int search(
         const uint8_t* T, int n, MpseMatch, void* context, int* current_state);
 
     virtual int search_all(
         const uint8_t* T, int n, MpseMatch, void* context, int* current_state);
 
+    // search several buffers at once so engines can overlap independent
+    // walks.  consecutive items of the same engine type are handed to that
+    // engine together; match order across items is not defined.
+    static void search_batch(MpseBatchItem*, unsigned count, MpseMatch);
+
+    // search the next chunk of a reassembled stream starting at seq.
+    // engines that can carry match state across chunks keep it on the flow
+    // and must restart it if seq does not follow the prior chunk; all
+    // others (or a null flow) just do a regular search.
+    int search_stream(
+        Flow*, bool to_server, uint32_t seq, const uint8_t* T, int n, MpseMatch,
+        void* context, int* current_state);
+
     virtual void set_opt(int) { }
     virtual int print_info() { return 0; }
     virtual int get_pattern_count() { return 0; }
@@ -91,6 +131,14 @@ protected:
     virtual int _search(
         const uint8_t* T, int n, MpseMatch, void* context, int* current_state) = 0;
 
+    virtual int _search_stream(
+        Flow*, bool /*to_server*/, uint32_t /*seq*/, const uint8_t* T, int n,
+        MpseMatch match, void* context, int* current_state)
+    { return _search(T, n, match, context, current_state); }
+
+    // items are all of this engine type but not necessarily this instance
+    virtual void _search_batch(MpseBatchItem*, unsigned count, MpseMatch);
+
 private:
     std::string method;
     bool inc_global_counter;
@@ -0,0 +1,58 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef CACHE_HASH_H
+#define CACHE_HASH_H
+
+// CacheHash is the interface for hash tables that own a fixed set of
+// preallocated entries.  entries are added with push(), bound to a key with
+// get(), and recycled with remove().  first() / next() walk the in use
+// entries starting with the least recently used.
+
+#include <cstddef>
+
+struct SFHASHFCN;
+
+class CacheHash
+{
+public:
+    virtual ~CacheHash() { }
+
+    virtual void* push(void* p) = 0;
+    virtual void* pop() = 0;
+
+    virtual void* first() = 0;
+    virtual void* next() = 0;
+    virtual void* current() = 0;
+    virtual bool touch() = 0;
+
+    virtual void* find(const void* key) = 0;
+    virtual void* get(const void* key) = 0;
+
+    virtual bool remove(const void* key) = 0;
+    virtual bool remove() = 0;
+
+    virtual unsigned get_count() = 0;
+
+    virtual int set_keyops(
+        unsigned (* hash_fcn)(SFHASHFCN* p, unsigned char* d, int n),
+        int (* keycmp_fcn)(const void* s1, const void* s2, size_t n)) = 0;
+};
+
+#endif
+
@@ -0,0 +1,452 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clock_hash.h"
+
+#include <assert.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "sfhashfcn.h"
+#include "utils/util.h"
+
+//-------------------------------------------------------------------------
+// private stuff
+//-------------------------------------------------------------------------
+
+struct ClockHash::Node
+{
+    void* data;
+    uint32_t hash;
+    uint32_t slot;  // slot when in use, else next free node
+};
+
+static const unsigned NONE = ~0u;
+static const unsigned GROUP_SIZE = 16;
+static const unsigned LINE_SIZE = 64;
+
+static const uint8_t IN_USE = 0x01;
+static const uint8_t REFERENCED = 0x02;
+
+// tag 0 means empty so the top bit is always set
+static inline uint8_t make_tag(unsigned hash)
+{ return (uint8_t)((hash >> 25) | 0x80); }
+
+// hits and empty get one bit per slot starting at p
+static inline void match_group(
+    const uint8_t* p, uint8_t tag, unsigned& hits, unsigned& empty)
+{
+#ifdef __SSE2__
+    __m128i g = _mm_loadu_si128((const __m128i*)p);
+    hits = _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)tag)));
+    empty = _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_setzero_si128()));
+#else
+    hits = empty = 0;
+
+    for ( unsigned i = 0; i < GROUP_SIZE; ++i )
+    {
+        if ( p[i] == tag )
+            hits |= (1u << i);
+
+        else if ( !p[i] )
+            empty |= (1u << i);
+    }
+#endif
+}
+
+static unsigned nearest_powerof2(unsigned n)
+{
+    unsigned p = 1;
+
+    while ( p < n )
+        p <<= 1;
+
+    return p;
+}
+
+inline ClockHash::Node* ClockHash::get_node(unsigned idx) const
+{ return (Node*)(nodes + (size_t)idx * node_size); }
+
+inline void* ClockHash::get_key(unsigned idx) const
+{ return (uint8_t*)get_node(idx) + sizeof(Node); }
+
+inline unsigned ClockHash::hash_key(const void* key) const
+{ return sfhashfcn->hash_fcn(sfhashfcn, (unsigned char*)key, keysize); }
+
+// linear probe a group at a time.  returns the slot holding key or NONE
+// with ins set to the first empty slot, which ends the probe sequence.
+unsigned ClockHash::find_slot(const void* key, unsigned hash, unsigned& ins) const
+{
+    const uint8_t tag = make_tag(hash);
+    unsigned pos = hash & mask;
+
+    while ( true )
+    {
+        unsigned hits, empty;
+        match_group(tags + pos, tag, hits, empty);
+
+        if ( empty )
+            hits &= (1u << __builtin_ctz(empty)) - 1;
+
+        while ( hits )
+        {
+            unsigned slot = (pos + __builtin_ctz(hits)) & mask;
+
+            if ( !sfhashfcn->keycmp_fcn(get_key(slots[slot]), key, keysize) )
+                return slot;
+
+            hits &= hits - 1;
+        }
+
+        if ( empty )
+        {
+            ins = (pos + __builtin_ctz(empty)) & mask;
+            return NONE;
+        }
+        pos = (pos + GROUP_SIZE) & mask;
+    }
+}
+
+// the first group of tags is mirrored past the end so that a group load
+// never has to wrap
+inline void ClockHash::set_tag(unsigned slot, uint8_t tag)
+{
+    tags[slot] = tag;
+
+    if ( slot < GROUP_SIZE )
+        tags[nslots + slot] = tag;
+}
+
+void ClockHash::insert(unsigned slot, unsigned idx, unsigned hash)
+{
+    Node* node = get_node(idx);
+    node->hash = hash;
+    node->slot = slot;
+
+    slots[slot] = idx;
+    set_tag(slot, make_tag(hash));
+}
+
+// backward shift deletion; no tombstones so probe sequences stay short
+void ClockHash::erase(unsigned slot)
+{
+    unsigned j = slot;
+
+    while ( true )
+    {
+        j = (j + 1) & mask;
+
+        if ( !tags[j] )
+            break;
+
+        unsigned home = get_node(slots[j])->hash & mask;
+
+        // entry at j stays put if its home is cyclically in (slot, j]
+        if ( slot <= j ? (slot < home and home <= j) : (slot < home or home <= j) )
+            continue;
+
+        insert(slot, slots[j], get_node(slots[j])->hash);
+        slot = j;
+    }
+    set_tag(slot, 0);
+}
+
+// CLOCK: starting at start, return the first in use entry that has not
+// been referenced since the hand last passed, clearing reference bits on
+// the way.  gives up after limit steps.
+unsigned ClockHash::sweep(unsigned start, unsigned limit)
+{
+    if ( !count )
+        return NONE;
+
+    unsigned idx = start;
+
+    for ( unsigned n = 0; n < limit; ++n, ++idx )
+    {
+        if ( idx >= num_nodes )
+            idx = 0;
+
+        uint8_t& s = state[idx];
+
+        if ( !(s & IN_USE) )
+            continue;
+
+        if ( !(s & REFERENCED) )
+        {
+            walked += n + 1;
+            return idx;
+        }
+        s &= ~REFERENCED;
+    }
+    return NONE;
+}
+
+unsigned ClockHash::get_free_node()
+{
+    unsigned idx = free_head;
+
+    if ( idx != NONE )
+    {
+        free_head = get_node(idx)->slot;
+
+        if ( free_head == NONE )
+            free_tail = NONE;
+    }
+    return idx;
+}
+
+// move the cursor to the next candidate after idx within the current
+// revolution, like ZHash moves its cursor to the previous node
+void ClockHash::advance(unsigned idx)
+{
+    if ( walked >= num_nodes )
+        cursor = NONE;
+    else
+        cursor = sweep(idx + 1, num_nodes - walked);
+}
+
+bool ClockHash::remove_node(unsigned idx)
+{
+    if ( idx == NONE or !(state[idx] & IN_USE) )
+        return false;
+
+    Node* node = get_node(idx);
+    erase(node->slot);
+
+    // reuse recently freed entries first while they are still cached
+    state[idx] = 0;
+    node->slot = free_head;
+    free_head = idx;
+
+    if ( free_tail == NONE )
+        free_tail = idx;
+
+    if ( hand == idx )
+        hand = idx + 1;
+
+    count--;
+
+    if ( cursor == idx )
+        advance(idx);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+// public stuff
+//-------------------------------------------------------------------------
+
+ClockHash::ClockHash(unsigned max_entries, int keysz)
+{
+    keysize = keysz;
+    node_size = (sizeof(Node) + keysize + 15) & ~15;
+
+    // keep the load factor under 2/3 since linear probing degrades quickly
+    nslots = nearest_powerof2(max_entries + max_entries / 2);
+
+    if ( nslots < 2 * GROUP_SIZE )
+        nslots = 2 * GROUP_SIZE;
+
+    mask = nslots - 1;
+    sfhashfcn = sfhashfcn_new(nslots);
+
+    tags = (uint8_t*)snort_calloc(nslots + GROUP_SIZE, sizeof(*tags));
+    slots = (uint32_t*)snort_calloc(nslots, sizeof(*slots));
+    state = (uint8_t*)snort_calloc(max_entries ? max_entries : 1, sizeof(*state));
+
+    // align entries to cache lines so a 64 byte entry is one line
+    mem = (uint8_t*)snort_calloc((size_t)max_entries * node_size + LINE_SIZE, 1);
+    nodes = (uint8_t*)(((uintptr_t)mem + LINE_SIZE - 1) & ~(uintptr_t)(LINE_SIZE - 1));
+
+    max_nodes = max_entries;
+    num_nodes = 0;
+    free_head = free_tail = NONE;
+
+    count = 0;
+    hand = 0;
+    cursor = NONE;
+    walked = 0;
+}
+
+ClockHash::~ClockHash()
+{
+    if ( sfhashfcn )
+        sfhashfcn_free(sfhashfcn);
+
+    snort_free(tags);
+    snort_free(slots);
+    snort_free(state);
+    snort_free(mem);
+}
+
+size_t ClockHash::get_memory() const
+{
+    return (size_t)nslots * (sizeof(*tags) + sizeof(*slots)) +
+        (size_t)max_nodes * (node_size + sizeof(*state));
+}
+
+void* ClockHash::push(void* p)
+{
+    if ( num_nodes >= max_nodes )
+        return nullptr;
+
+    // pushed entries are handed out in order so the table fills the
+    // entry array from the front
+    unsigned idx = num_nodes++;
+    Node* node = get_node(idx);
+
+    node->data = p;
+    node->slot = NONE;
+
+    if ( free_tail == NONE )
+        free_head = idx;
+    else
+        get_node(free_tail)->slot = idx;
+
+    free_tail = idx;
+    return get_key(idx);
+}
+
+void* ClockHash::pop()
+{
+    unsigned idx = get_free_node();
+    return idx != NONE ? get_node(idx)->data : nullptr;
+}
+
+void* ClockHash::get(const void* key)
+{
+    unsigned hash = hash_key(key);
+    unsigned ins;
+    unsigned slot = find_slot(key, hash, ins);
+
+    if ( slot != NONE )
+    {
+        unsigned idx = slots[slot];
+
+        if ( !(state[idx] & REFERENCED) )
+            state[idx] |= REFERENCED;
+
+        return get_node(idx)->data;
+    }
+
+    unsigned idx = get_free_node();
+
+    if ( idx == NONE )
+        return nullptr;
+
+    Node* node = get_node(idx);
+    memcpy(get_key(idx), key, keysize);
+    insert(ins, idx, hash);
+
+    state[idx] = IN_USE | REFERENCED;
+    count++;
+
+    return node->data;
+}
+
+void* ClockHash::find(const void* key)
+{
+    unsigned ins;
+    unsigned slot = find_slot(key, hash_key(key), ins);
+
+    if ( slot == NONE )
+        return nullptr;
+
+    unsigned idx = slots[slot];
+
+    if ( !(state[idx] & REFERENCED) )
+        state[idx] |= REFERENCED;
+
+    return get_node(idx)->data;
+}
+
+void* ClockHash::first()
+{
+    walked = 0;
+    cursor = sweep(hand, 2 * num_nodes);
+
+    if ( cursor == NONE )
+        return nullptr;
+
+    // the hand moves past what it returns so an entry the caller keeps
+    // doesn't block the hand on every later call
+    hand = cursor + 1;
+    return get_node(cursor)->data;
+}
+
+// unlike ZHash there is no end of list so stop after one revolution
+void* ClockHash::next()
+{
+    if ( cursor == NONE )
+        return nullptr;
+
+    advance(cursor);
+    return current();
+}
+
+void* ClockHash::current()
+{
+    return cursor != NONE ? get_node(cursor)->data : nullptr;
+}
+
+// give the cursor entry a second chance and move the hand past it
+bool ClockHash::touch()
+{
+    if ( cursor == NONE )
+        return false;
+
+    state[cursor] |= REFERENCED;
+    hand = cursor + 1;
+    advance(cursor);
+
+    return true;
+}
+
+bool ClockHash::remove(const void* key)
+{
+    unsigned ins;
+    unsigned slot = find_slot(key, hash_key(key), ins);
+
+    if ( slot == NONE )
+        return false;
+
+    return remove_node(slots[slot]);
+}
+
+bool ClockHash::remove()
+{
+    return remove_node(cursor);
+}
+
+int ClockHash::set_keyops(
+    unsigned (* hash_fcn)(SFHASHFCN* p, unsigned char* d, int n),
+    int (* keycmp_fcn)(const void* s1, const void* s2, size_t n))
+{
+    if ( hash_fcn && keycmp_fcn )
+        return sfhashfcn_set_keyops(sfhashfcn, hash_fcn, keycmp_fcn);
+
+    return -1;
+}
+
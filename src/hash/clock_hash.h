@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef CLOCK_HASH_H
+#define CLOCK_HASH_H
+
+// ClockHash is an open addressed alternative to ZHash for large caches.
+// slots hold a 1 byte tag and a 4 byte entry index; a group of 16 tags is
+// compared at once so most lookups touch one tag line and one entry.
+// entries are fixed size (header + key) and allocated up front by push().
+// recency is tracked with a reference bit per entry and a CLOCK hand
+// instead of relinking a global LRU list on every hit, so first() returns
+// an approximately least recently used entry.
+
+#include <cstdint>
+
+#include "hash/cache_hash.h"
+
+class ClockHash : public CacheHash
+{
+public:
+    // max_entries is the most entries that may be pushed
+    ClockHash(unsigned max_entries, int keysize);
+    ~ClockHash();
+
+    void* push(void* p) override;
+    void* pop() override;
+
+    void* first() override;
+    void* next() override;
+    void* current() override;
+    bool touch() override;
+
+    void* find(const void* key) override;
+    void* get(const void* key) override;
+
+    bool remove(const void* key) override;
+    bool remove() override;
+
+    unsigned get_count() override { return count; }
+
+    int set_keyops(
+        unsigned (* hash_fcn)(SFHASHFCN* p, unsigned char* d, int n),
+        int (* keycmp_fcn)(const void* s1, const void* s2, size_t n)) override;
+
+    unsigned get_slots() const { return nslots; }
+    size_t get_memory() const;
+
+private:
+    struct Node;
+
+    Node* get_node(unsigned idx) const;
+    void* get_key(unsigned idx) const;
+    unsigned hash_key(const void* key) const;
+
+    unsigned find_slot(const void* key, unsigned hash, unsigned& ins) const;
+    void set_tag(unsigned slot, uint8_t tag);
+    void insert(unsigned slot, unsigned idx, unsigned hash);
+    void erase(unsigned slot);
+
+    unsigned sweep(unsigned start, unsigned limit);
+    void advance(unsigned idx);
+    unsigned get_free_node();
+    bool remove_node(unsigned idx);
+
+private:
+    SFHASHFCN* sfhashfcn;
+    unsigned keysize;
+    unsigned node_size;
+
+    unsigned nslots;
+    unsigned mask;
+    unsigned count;
+
+    unsigned max_nodes;
+    unsigned num_nodes;
+    unsigned free_head;
+    unsigned free_tail;
+
+    unsigned hand;
+    unsigned cursor;
+    unsigned walked;
+
+    uint8_t* tags;
+    uint32_t* slots;
+    uint8_t* state;
+
+    uint8_t* mem;
+    uint8_t* nodes;
+};
+
+#endif
+
@@ -0,0 +1,183 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// lru_cache_sharded.h
+
+#ifndef LRU_CACHE_SHARDED_H
+#define LRU_CACHE_SHARDED_H
+
+// LruCacheSharded -- splits a thread-safe LRU cache into a fixed number of
+// independently locked LruCacheShared shards selected by key hash so that
+// packet threads working on different keys rarely contend.  LRU order and
+// the size limit are maintained per shard, which approximates a global
+// LRU when keys are spread evenly.
+
+#include <atomic>
+#include <vector>
+
+#include "hash/lru_cache_shared.h"
+
+template<typename Key, typename Data, typename Hash, unsigned num_shards = 16>
+class LruCacheSharded
+{
+public:
+    static_assert(num_shards and !(num_shards & (num_shards - 1)),
+        "shard count must be a power of 2");
+
+    LruCacheSharded() = delete;
+    LruCacheSharded(const LruCacheSharded& arg) = delete;
+    LruCacheSharded& operator=(const LruCacheSharded& arg) = delete;
+
+    LruCacheSharded(const size_t initial_size) : max_size(initial_size)
+    {
+        for ( unsigned i = 0; i < num_shards; ++i )
+            shards[i] = new Shard(shard_size(initial_size));
+    }
+
+    ~LruCacheSharded()
+    {
+        for ( unsigned i = 0; i < num_shards; ++i )
+            delete shards[i];
+    }
+
+    //  Get current number of elements in all shards.
+    size_t size()
+    {
+        size_t n = 0;
+
+        for ( unsigned i = 0; i < num_shards; ++i )
+            n += shards[i]->cache.size();
+
+        return n;
+    }
+
+    size_t get_max_size()
+    { return max_size; }
+
+    //  Modify the maximum number of entries allowed in the cache.  The
+    //  limit is divided evenly between the shards.
+    bool set_max_size(size_t newsize)
+    {
+        if ( !newsize )
+            return false;
+
+        for ( unsigned i = 0; i < num_shards; ++i )
+            shards[i]->cache.set_max_size(shard_size(newsize));
+
+        max_size = newsize;
+        return true;
+    }
+
+    void insert(const Key& key, const Data& data)
+    { get_shard(key).insert(key, data); }
+
+    bool find(const Key& key, Data& data, bool update=true)
+    { return get_shard(key).find(key, data, update); }
+
+    bool remove(const Key& key)
+    { return get_shard(key).remove(key); }
+
+    bool remove(const Key& key, Data& data)
+    { return get_shard(key).remove(key, data); }
+
+    void clear();
+
+    //  Return all data in LRU order within each shard.
+    std::vector<std::pair<Key, Data> > get_all_data();
+
+    const PegInfo* get_pegs() const
+    { return lru_cache_shared_peg_names; }
+
+    //  Sum of the shard counts.  Like LruCacheShared, counts are read
+    //  without locking.
+    PegCount* get_counts() const;
+
+private:
+    using Cache = LruCacheShared<Key, Data, Hash>;
+
+    // shards are allocated separately and padded so that the locks of
+    // adjacent shards don't share a cache line
+    struct Shard
+    {
+        Cache cache;
+        char pad[64];
+        Shard(size_t n) : cache(n) { }
+    };
+
+    static size_t shard_size(size_t n)
+    { return n > num_shards ? (n + num_shards - 1) / num_shards : 1; }
+
+    Cache& get_shard(const Key& key)
+    {
+        // the shard is chosen from the high bits of the mixed hash so it is
+        // independent of the bucket chosen by the shard's unordered_map
+        uint64_t h = (uint64_t)Hash()(key) * 0x9E3779B97F4A7C15ULL;
+        return shards[(h >> 32) & (num_shards - 1)]->cache;
+    }
+
+    std::atomic<size_t> max_size;
+    Shard* shards[num_shards];
+
+    mutable LruCacheSharedStats stats;
+};
+
+template<typename Key, typename Data, typename Hash, unsigned num_shards>
+void LruCacheSharded<Key, Data, Hash, num_shards>::clear()
+{
+    for ( unsigned i = 0; i < num_shards; ++i )
+        shards[i]->cache.clear();
+}
+
+template<typename Key, typename Data, typename Hash, unsigned num_shards>
+std::vector<std::pair<Key, Data> > LruCacheSharded<Key, Data, Hash, num_shards>::get_all_data()
+{
+    std::vector<std::pair<Key, Data> > vec;
+
+    for ( unsigned i = 0; i < num_shards; ++i )
+    {
+        auto part = shards[i]->cache.get_all_data();
+        vec.insert(vec.end(), part.begin(), part.end());
+    }
+
+    return vec;
+}
+
+template<typename Key, typename Data, typename Hash, unsigned num_shards>
+PegCount* LruCacheSharded<Key, Data, Hash, num_shards>::get_counts() const
+{
+    const unsigned num_pegs = sizeof(stats) / sizeof(PegCount);
+    PegCount* sum = (PegCount*)&stats;
+
+    for ( unsigned j = 0; j < num_pegs; ++j )
+        sum[j] = 0;
+
+    for ( unsigned i = 0; i < num_shards; ++i )
+    {
+        const PegCount* pc = shards[i]->cache.get_counts();
+
+        for ( unsigned j = 0; j < num_pegs; ++j )
+            sum[j] += pc[j];
+    }
+
+    // each call to clear() clears every shard
+    stats.clears /= num_shards;
+
+    return sum;
+}
+
+#endif
+
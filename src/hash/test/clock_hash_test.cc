@@ -0,0 +1,262 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// clock_hash_test.cc
+// unit tests for ClockHash and a lookup / insert / prune comparison with
+// ZHash.  set CLOCK_HASH_BENCH_FLOWS to run the comparison at 1M - 10M.
+
+#include "hash/clock_hash.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "hash/sfhashfcn.h"
+#include "hash/zhash.h"
+#include "main/thread.h"
+#include "time/stopwatch.h"
+
+struct SnortConfig;
+THREAD_LOCAL SnortConfig* snort_conf = nullptr;
+
+// same size and hash as FlowKey
+struct TestKey
+{
+    uint32_t w[12];
+};
+
+static unsigned test_hash(SFHASHFCN*, unsigned char* d, int)
+{
+    const uint32_t* k = (const uint32_t*)d;
+    uint32_t a = k[0], b = k[1], c = k[2];
+
+    mix(a, b, c);
+    a += k[3]; b += k[4]; c += k[5];
+    mix(a, b, c);
+    a += k[6]; b += k[7]; c += k[8];
+    mix(a, b, c);
+    a += k[9]; b += k[10]; c += k[11];
+    finalize(a, b, c);
+
+    return c;
+}
+
+static int test_compare(const void* s1, const void* s2, size_t n)
+{ return memcmp(s1, s2, n); }
+
+static void make_key(TestKey& key, unsigned id)
+{
+    memset(&key, 0, sizeof(key));
+    key.w[0] = 0x0a000000 | (id & 0xffffff);
+    key.w[4] = 0xc0a80000 | (id >> 24);
+    key.w[8] = (id * 2654435761u) & 0xffff;
+}
+
+//-------------------------------------------------------------------------
+// functional tests
+//-------------------------------------------------------------------------
+
+TEST_GROUP(clock_hash)
+{
+    static const unsigned max = 1024;
+    int data[max];
+    ClockHash* ch = nullptr;
+
+    void setup() override
+    {
+        ch = new ClockHash(max, sizeof(TestKey));
+        ch->set_keyops(test_hash, test_compare);
+
+        for ( unsigned i = 0; i < max; ++i )
+            ch->push(data + i);
+    }
+
+    void teardown() override
+    { delete ch; }
+};
+
+TEST(clock_hash, push_limit)
+{
+    int extra;
+    CHECK(ch->push(&extra) == nullptr);
+    CHECK(ch->get_slots() >= max + max / 2);
+}
+
+TEST(clock_hash, get_find_remove)
+{
+    TestKey key;
+
+    for ( unsigned i = 0; i < max; ++i )
+    {
+        make_key(key, i);
+        CHECK(ch->get(&key) != nullptr);
+    }
+    CHECK(ch->get_count() == max);
+
+    make_key(key, max);
+    CHECK(ch->get(&key) == nullptr);
+    CHECK(ch->find(&key) == nullptr);
+
+    make_key(key, 7);
+    void* p = ch->find(&key);
+    CHECK(p != nullptr);
+    CHECK(ch->get(&key) == p);
+
+    CHECK(ch->remove(&key));
+    CHECK(!ch->remove(&key));
+    CHECK(ch->find(&key) == nullptr);
+    CHECK(ch->get_count() == max - 1);
+
+    // removal must not break probe sequences of the others
+    for ( unsigned i = 0; i < max; ++i )
+    {
+        make_key(key, i);
+        CHECK((ch->find(&key) != nullptr) == (i != 7));
+    }
+
+    // the freed entry is reused
+    make_key(key, max);
+    CHECK(ch->get(&key) == p);
+}
+
+TEST(clock_hash, clock_order)
+{
+    TestKey key;
+
+    for ( unsigned i = 0; i < 4; ++i )
+    {
+        make_key(key, i);
+        ch->get(&key);
+    }
+
+    // everything is referenced on insert so the first sweep clears all
+    // and returns the oldest
+    void* oldest = ch->first();
+    CHECK(oldest != nullptr);
+
+    // a hit gives it a second chance
+    make_key(key, 0);
+    CHECK(ch->find(&key) == oldest);
+    CHECK(ch->first() != oldest);
+
+    // walk ends after one revolution
+    unsigned n = 0;
+
+    for ( void* p = ch->first(); p; p = ch->next() )
+        ++n;
+
+    CHECK(n <= 4);
+
+    while ( ch->first() )
+        CHECK(ch->remove());
+
+    CHECK(ch->get_count() == 0);
+}
+
+//-------------------------------------------------------------------------
+// comparison with ZHash
+//-------------------------------------------------------------------------
+
+static double mops(unsigned n, Stopwatch<std::chrono::high_resolution_clock>& sw)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    auto usecs = duration_cast<microseconds>(sw.get()).count();
+    return usecs ? (double)n / usecs : 0.0;
+}
+
+static void run_bench(const char* name, CacheHash* h, unsigned flows)
+{
+    std::vector<int> data(flows);
+    TestKey key;
+
+    for ( unsigned i = 0; i < flows; ++i )
+        h->push(&data[i]);
+
+    h->set_keyops(test_hash, test_compare);
+
+    Stopwatch<std::chrono::high_resolution_clock> ins, hit, miss, prune;
+
+    ins.start();
+    for ( unsigned i = 0; i < flows; ++i )
+    {
+        make_key(key, i);
+        h->get(&key);
+    }
+    ins.stop();
+    CHECK(h->get_count() == flows);
+
+    // scattered hits like interleaved packets from many flows
+    hit.start();
+    for ( unsigned i = 0, j = 0; i < flows; ++i, j = (j + 7919) % flows )
+    {
+        make_key(key, j);
+        CHECK(h->find(&key) != nullptr);
+    }
+    hit.stop();
+
+    miss.start();
+    for ( unsigned i = 0; i < flows; ++i )
+    {
+        make_key(key, flows + i);
+        CHECK(h->find(&key) == nullptr);
+    }
+    miss.stop();
+
+    prune.start();
+    while ( h->first() )
+        h->remove();
+    prune.stop();
+    CHECK(h->get_count() == 0);
+
+    printf("\n%-6s %9u flows: insert %6.2f  hit %6.2f  miss %6.2f  prune %6.2f Mops/s",
+        name, flows, mops(flows, ins), mops(flows, hit), mops(flows, miss), mops(flows, prune));
+}
+
+TEST_GROUP(clock_hash_bench)
+{
+};
+
+TEST(clock_hash_bench, zhash_vs_clock)
+{
+    unsigned flows = 1 << 16;
+
+    if ( const char* s = getenv("CLOCK_HASH_BENCH_FLOWS") )
+        flows = strtoul(s, nullptr, 0);
+
+    ZHash* zh = new ZHash(flows, sizeof(TestKey));
+    run_bench("zhash", zh, flows);
+    delete zh;
+
+    ClockHash* ch = new ClockHash(flows, sizeof(TestKey));
+    run_bench("clock", ch, flows);
+    delete ch;
+
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
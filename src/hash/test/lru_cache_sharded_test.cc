@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// lru_cache_sharded_test.cc
+// unit tests for LruCacheSharded class
+
+#include "hash/lru_cache_sharded.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+#include <functional>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef LruCacheSharded<int, std::string, std::hash<int>, 4> TestCache;
+
+TEST_GROUP(lru_cache_sharded)
+{
+};
+
+//  Test LruCacheSharded constructor and member access.
+TEST(lru_cache_sharded, constructor_test)
+{
+    TestCache lru_cache(20);
+
+    CHECK(lru_cache.get_max_size() == 20);
+    CHECK(lru_cache.size() == 0);
+}
+
+//  Test insert, find and remove across shards.
+TEST(lru_cache_sharded, insert_test)
+{
+    std::string data;
+    TestCache lru_cache(100);
+
+    for (int i = 0; i < 20; i++)
+        lru_cache.insert(i, std::to_string(i));
+
+    CHECK(20 == lru_cache.size());
+    CHECK(20 == lru_cache.get_all_data().size());
+
+    for (int i = 0; i < 20; i++)
+    {
+        CHECK(true == lru_cache.find(i, data));
+        CHECK(data == std::to_string(i));
+    }
+    CHECK(false == lru_cache.find(20, data));
+
+    //  Verify that insert will replace data if key exists already.
+    lru_cache.insert(1, "newone");
+    CHECK(true == lru_cache.find(1, data));
+    CHECK("newone" == data);
+
+    CHECK(true == lru_cache.remove(1, data));
+    CHECK("newone" == data);
+    CHECK(false == lru_cache.remove(1));
+    CHECK(19 == lru_cache.size());
+
+    lru_cache.clear();
+    CHECK(0 == lru_cache.size());
+}
+
+//  Test that the size limit is split between shards and that reducing
+//  it prunes each shard.
+TEST(lru_cache_sharded, size_test)
+{
+    TestCache lru_cache(8);
+
+    for (int i = 0; i < 1000; i++)
+        lru_cache.insert(i, std::to_string(i));
+
+    CHECK(lru_cache.size() <= 8);
+
+    CHECK(false == lru_cache.set_max_size(0));
+    CHECK(true == lru_cache.set_max_size(1000));
+    CHECK(1000 == lru_cache.get_max_size());
+
+    for (int i = 0; i < 1000; i++)
+        lru_cache.insert(i, std::to_string(i));
+
+    CHECK(lru_cache.size() > 900);
+
+    CHECK(true == lru_cache.set_max_size(4));
+    CHECK(lru_cache.size() <= 4);
+}
+
+//  Test that the stats are summed over the shards.
+TEST(lru_cache_sharded, stats_test)
+{
+    std::string data;
+    TestCache lru_cache(100);
+
+    for (int i = 0; i < 10; i++)
+        lru_cache.insert(i, std::to_string(i));
+
+    lru_cache.insert(0, "zero");
+    lru_cache.find(1, data);
+    lru_cache.find(2, data);
+    lru_cache.find(100, data);
+    lru_cache.remove(3);
+    lru_cache.clear();
+
+    const PegInfo* pegs = lru_cache.get_pegs();
+    PegCount* stats = lru_cache.get_counts();
+
+    CHECK(!strcmp(pegs[0].name, "lru cache adds"));
+    CHECK(stats[0] == 10);  // adds
+    CHECK(stats[1] == 1);   // replaces
+    CHECK(stats[2] == 0);   // prunes
+    CHECK(stats[3] == 2);   // find hits
+    CHECK(stats[4] == 1);   // find misses
+    CHECK(stats[5] == 1);   // removes
+    CHECK(stats[6] == 1);   // clears
+}
+
+//  Test concurrent access from several threads.
+TEST(lru_cache_sharded, thread_test)
+{
+    const int num_threads = 4;
+    const int num_keys = 1000;
+    TestCache lru_cache(num_threads * num_keys);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; t++)
+    {
+        threads.push_back(std::thread([&lru_cache, t, num_keys]
+        {
+            std::string data;
+
+            for (int i = t * num_keys; i < (t + 1) * num_keys; i++)
+            {
+                lru_cache.insert(i, std::to_string(i));
+                lru_cache.find(i, data);
+            }
+        }));
+    }
+
+    for (auto& th : threads)
+        th.join();
+
+    PegCount* stats = lru_cache.get_counts();
+    CHECK(stats[0] == num_threads * num_keys);
+    CHECK(stats[3] + stats[4] == num_threads * num_keys);
+    CHECK(lru_cache.size() <= (size_t)num_threads * num_keys);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
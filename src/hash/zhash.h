@@ -20,36 +20,35 @@
 #ifndef ZHASH_H
 #define ZHASH_H
 
-#include <cstddef>
+#include "hash/cache_hash.h"
 
-struct SFHASHFCN;
 struct ZHashNode;
 
-class ZHash
+class ZHash : public CacheHash
 {
 public:
     ZHash(int nrows, int keysize);
     ~ZHash();
 
-    void* push(void* p);
-    void* pop();
+    void* push(void* p) override;
+    void* pop() override;
 
-    void* first();
-    void* next();
-    void* current();
-    bool touch();
+    void* first() override;
+    void* next() override;
+    void* current() override;
+    bool touch() override;
 
-    void* find(const void* key);
-    void* get(const void* key);
+    void* find(const void* key) override;
+    void* get(const void* key) override;
 
-    bool remove(const void* key);
-    bool remove();
+    bool remove(const void* key) override;
+    bool remove() override;
 
-    inline unsigned get_count() { return count; }
+    unsigned get_count() override { return count; }
 
     int set_keyops(
         unsigned (* hash_fcn)(SFHASHFCN* p, unsigned char* d, int n),
-        int (* keycmp_fcn)(const void* s1, const void* s2, size_t n));
+        int (* keycmp_fcn)(const void* s1, const void* s2, size_t n)) override;
 
 private:
     ZHashNode* get_free_node();
@@ -25,8 +25,7 @@
 
 #define LRU_CACHE_INITIAL_SIZE 65535
 
-LruCacheShared<HostIpKey, std::shared_ptr<HostTracker>, HashHostIpKey>
-    host_cache(LRU_CACHE_INITIAL_SIZE);
+HostCache host_cache(LRU_CACHE_INITIAL_SIZE);
 
 void host_cache_add_host_tracker(HostTracker* ht)
 {
@@ -22,11 +22,12 @@
 #define HOST_CACHE_H
 
 // The host cache is used to cache information about hosts so that it can
-// be shared among threads.
+// be shared among threads.  It is sharded by address so that packet
+// threads looking up different hosts don't contend on one lock.
 
 #include <functional>
 #include "host_tracker/host_tracker.h"
-#include "hash/lru_cache_shared.h"
+#include "hash/lru_cache_sharded.h"
 #include "main/snort_types.h"
 
 
@@ -64,7 +65,9 @@ struct HashHostIpKey
     }
 };
 
-extern LruCacheShared<HostIpKey, std::shared_ptr<HostTracker>, HashHostIpKey> host_cache;
+typedef LruCacheSharded<HostIpKey, std::shared_ptr<HostTracker>, HashHostIpKey> HostCache;
+
+extern HostCache host_cache;
 
 void host_cache_add_host_tracker(HostTracker*);
 
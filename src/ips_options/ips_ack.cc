@@ -59,6 +59,9 @@ public:
 
     int eval(Cursor&, Packet*) override;
 
+    bool is_header_only() override
+    { return true; }
+
 private:
     RangeCheck config;
 };
@@ -78,6 +78,9 @@ public:
 
     int eval(Cursor&, Packet*) override;
 
+    bool is_header_only() override
+    { return true; }
+
 private:
     TcpFlagCheckData config;
 };
@@ -53,6 +53,9 @@ public:
 
     int eval(Cursor&, Packet*) override;
 
+    bool is_header_only() override
+    { return true; }
+
 private:
     RangeCheck config;
 };
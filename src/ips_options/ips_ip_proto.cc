@@ -66,6 +66,9 @@ public:
 
     int eval(Cursor&, Packet*) override;
 
+    bool is_header_only() override
+    { return true; }
+
     IpProtoData* get_data()
     { return &config; }
 
@@ -64,6 +64,9 @@ public:
 
     int eval(Cursor&, Packet*) override;
 
+    bool is_header_only() override
+    { return true; }
+
     IpOptionData* get_data()
     { return &config; }
 
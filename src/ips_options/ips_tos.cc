@@ -47,6 +47,9 @@ public:
 
     int eval(Cursor&, Packet*) override;
 
+    bool is_header_only() override
+    { return true; }
+
 public:
     RangeCheck config;
 };
@@ -148,10 +148,12 @@ struct DefaultRuleInterface
 
             for ( int i = 0; i < root.num_children; ++i )
             {
-                auto& child_state = root.children[i]->state[get_instance_id()];
-                // FIXIT-L rename to something like latency_timeout_count
-                ++child_state.latency_timeouts;
-                ++child_state.latency_suspends;
+                if ( auto* child_state = root.children[i]->get_profile(get_instance_id()) )
+                {
+                    // FIXIT-L rename to something like latency_timeout_count
+                    ++child_state->latency_timeouts;
+                    ++child_state->latency_suspends;
+                }
             }
 
             return true;
@@ -162,7 +164,8 @@ struct DefaultRuleInterface
             for ( int i = 0; i < root.num_children; ++i )
             {
                 // FIXIT-L rename to something like latency_timeout_count
-                ++root.children[i]->state[get_instance_id()].latency_timeouts;
+                if ( auto* child_state = root.children[i]->get_profile(get_instance_id()) )
+                    ++child_state->latency_timeouts;
             }
         }
 
@@ -604,8 +607,12 @@ TEST_CASE ( "default latency rule interface", "[latency]" )
     detection_option_tree_node_t child;
     children[0] = &child;
 
-    std::unique_ptr<dot_node_state_t[]> child_state(new dot_node_state_t[instances]());
-    child.state = child_state.get();
+    std::unique_ptr<dot_node_state_t[]> child_node_state(new dot_node_state_t[instances]());
+    child.state = child_node_state.get();
+    child.state_stride = 1;
+
+    std::unique_ptr<dot_node_profile_t[]> child_state(new dot_node_profile_t[instances]());
+    child.profile = child_state.get();
 
     detection_option_tree_root_t root;
     root.latency_state = latency_state.get();
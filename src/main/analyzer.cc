@@ -244,9 +244,16 @@ void Analyzer::analyze()
             this_thread::sleep_for(ms);
             continue;
         }
-        if (daq_instance->acquire(0, main_func))
+        // with batching, acquire returns after at most batch_size packets so
+        // per batch housekeeping is done here instead of per packet
+        unsigned batch_size = SFDAQ::get_batch_size();
+
+        if (daq_instance->acquire(batch_size, main_func))
             break;
 
+        if (batch_size && Snort::thread_batch())
+            continue;
+
         // FIXIT-L acquire(0) makes idle processing unlikely under high traffic
         // because it won't return until no packets, signal, etc.  that means
         // the idle processing may not be useful or that we need a hook to do
@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// idle_slice.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "idle_slice.h"
+
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#endif
+
+void IdleSlice::init(uint32_t n, uint32_t usecs, hr_time now)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    max_pkts = n;
+    pkts = 0;
+
+    timed = usecs != 0;
+    interval = duration_cast<hr_duration>(microseconds(clock_ticks(usecs)));
+    start = now;
+}
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+static unsigned count_due(IdleSlice& slice, unsigned pkts)
+{
+    unsigned n = 0;
+
+    for ( unsigned i = 0; i < pkts; ++i )
+    {
+        if ( slice.due() )
+        {
+            ++n;
+            slice.reset();
+        }
+    }
+    return n;
+}
+
+TEST_CASE("idle slice disabled", "[idle_slice]")
+{
+    IdleSlice slice;
+    slice.init(0, 0, SnortClock::now());
+    CHECK(count_due(slice, 10000) == 0);
+}
+
+TEST_CASE("idle slice packets", "[idle_slice]")
+{
+    IdleSlice slice;
+    slice.init(3, 0, SnortClock::now());
+
+    CHECK(!slice.due());
+    CHECK(!slice.due());
+    CHECK(slice.due());
+
+    // still due until a slice runs
+    CHECK(slice.due());
+    slice.reset();
+
+    CHECK(!slice.due());
+    CHECK(count_due(slice, 299) == 100);
+}
+
+TEST_CASE("idle slice reset by idle", "[idle_slice]")
+{
+    IdleSlice slice;
+    slice.init(3, 0, SnortClock::now());
+
+    CHECK(!slice.due());
+    CHECK(!slice.due());
+
+    // an idle call did the housekeeping so the count starts over
+    slice.reset();
+
+    CHECK(!slice.due());
+    CHECK(!slice.due());
+    CHECK(slice.due());
+}
+
+TEST_CASE("idle slice time", "[idle_slice]")
+{
+    IdleSlice slice;
+    hr_time t0 = SnortClock::now();
+    slice.init(0, 100, t0);
+
+    const hr_duration interval = slice.get_interval();
+    CHECK(interval > hr_duration::zero());
+
+    CHECK(!slice.expired(t0));
+    CHECK(!slice.expired(t0 + interval - hr_duration(1)));
+    CHECK(slice.expired(t0 + interval));
+    CHECK(slice.expired(t0 + 2 * interval));
+}
+
+#endif
@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// idle_slice.h
+
+#ifndef IDLE_SLICE_H
+#define IDLE_SLICE_H
+
+// acquire won't return while traffic is available so the housekeeping done
+// when idle is also run from the packet loop in bounded slices.  a slice is
+// due after a number of packets and / or once an interval has passed since
+// the last slice or idle call.  a trigger configured as 0 is off.
+
+#include <stdint.h>
+
+#include "time/clock_defs.h"
+
+class IdleSlice
+{
+public:
+    // constexpr so it can be THREAD_LOCAL
+    constexpr IdleSlice() :
+        max_pkts(0), pkts(0), timed(false), start(), interval(hr_duration::zero()) { }
+
+    void init(uint32_t max_pkts, uint32_t usecs, hr_time now);
+
+    // packet thread: call once per packet
+    bool due()
+    {
+        if ( max_pkts and ++pkts >= max_pkts )
+            return true;
+
+        return timed and expired(SnortClock::now());
+    }
+
+    // packet thread: call when housekeeping was done, by a slice or idle
+    void reset()
+    {
+        if ( timed )
+            start = SnortClock::now();
+
+        pkts = 0;
+    }
+
+    bool expired(hr_time now) const
+    { return now - start >= interval; }
+
+    hr_duration get_interval() const
+    { return interval; }
+
+private:
+    uint32_t max_pkts;
+    uint32_t pkts;
+    bool timed;
+    hr_time start;
+    hr_duration interval;
+};
+
+#endif
@@ -201,6 +201,12 @@ static const Parameter search_engine_params[] =
     { "enable_single_rule_group", Parameter::PT_BOOL, nullptr, "false",
       "put all rules into one group" },
 
+    { "cache_dir", Parameter::PT_STRING, nullptr, nullptr,
+      "directory for compiled search engine databases; unchanged groups are loaded instead of compiled (hyperscan only)" },
+
+    { "compile_threads", Parameter::PT_INT, "0:", "0",
+      "threads used to compile port group search engines (0 means one per cpu)" },
+
     { "debug", Parameter::PT_BOOL, nullptr, "false",
       "print verbose fast pattern info" },
 
@@ -286,6 +292,12 @@ bool SearchEngineModule::set(const char*, Value& v, SnortConfig* sc)
         if ( v.get_bool() )
             fp->set_single_rule_group();
     }
+    else if ( v.is("cache_dir") )
+        fp->set_cache_dir(v.get_string());
+
+    else if ( v.is("compile_threads") )
+        fp->set_compile_threads(v.get_long());
+
     else if ( v.is("debug") )
     {
         if ( v.get_bool() )
@@ -864,6 +876,15 @@ static const Parameter packets_params[] =
     { "skip", Parameter::PT_INT, "0:", "0",
       "number of packets to skip before before processing" },
 
+    { "idle_slice_packets", Parameter::PT_INT, "0:", "0",
+      "run housekeeping after this many packets even if traffic is continuous (0 is never)" },
+
+    { "idle_slice_usecs", Parameter::PT_INT, "0:", "0",
+      "run housekeeping after this much time even if traffic is continuous (0 is never)" },
+
+    { "idle_slice_flows", Parameter::PT_INT, "1:", "16",
+      "maximum number of idle flows to time out in one housekeeping slice; idle calls still time out 1" },
+
     { "vlan_agnostic", Parameter::PT_BOOL, nullptr, "false",
       "determines whether VLAN info is used to track fragments and connections" },
 
@@ -894,6 +915,15 @@ bool PacketsModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("skip") )
         sc->pkt_skip = v.get_long();
 
+    else if ( v.is("idle_slice_packets") )
+        sc->idle_slice_pkts = v.get_long();
+
+    else if ( v.is("idle_slice_usecs") )
+        sc->idle_slice_usecs = v.get_long();
+
+    else if ( v.is("idle_slice_flows") )
+        sc->idle_slice_flows = v.get_long();
+
     else if ( v.is("vlan_agnostic") )
         sc->vlan_agnostic = v.get_long();
 
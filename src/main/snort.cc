@@ -36,6 +36,7 @@
 #include <sys/stat.h>
 
 #include "decompress/file_decomp.h"
+#include "decompress/inflate_pool.h"
 #include "detection/detect.h"
 #include "detection/detection_util.h"
 #include "detection/fp_config.h"
@@ -75,6 +76,8 @@
 #include "target_based/sftarget_reader.h"
 #include "time/packet_time.h"
 #include "time/periodic.h"
+#include "time/clock_defs.h"
+#include "time/stopwatch.h"
 #include "utils/kmap.h"
 #include "utils/util.h"
 #include "utils/util_utf.h"
@@ -86,6 +89,7 @@
 #endif
 
 #include "build.h"
+#include "idle_slice.h"
 #include "main.h"
 #include "snort_config.h"
 #include "snort_debug.h"
@@ -102,6 +106,7 @@ static pid_t snort_main_thread_pid = 0;
 static THREAD_LOCAL DAQ_PktHdr_t s_pkth;
 static THREAD_LOCAL uint8_t s_data[65536];
 static THREAD_LOCAL Packet* s_packet = nullptr;
+static THREAD_LOCAL unsigned s_batch_pkts = 0;
 
 //-------------------------------------------------------------------------
 // perf stats
@@ -277,6 +282,8 @@ void Snort::init(int argc, char** argv)
     else if ( SnortConfig::log_verbose() )
         InspectorManager::print_config(snort_conf);
 
+    snort_conf->post_setup();
+
     if (snort_conf->file_mask != 0)
         umask(snort_conf->file_mask);
     else
@@ -534,6 +541,8 @@ SnortConfig* Snort::get_reload_config(const char* fname)
         return NULL;
     }
 
+    sc->post_setup();
+
     FlowbitResetCounts();  // FIXIT-L updates global hash, put in sc
 
     if ((sc->file_mask != 0) && (sc->file_mask != snort_conf->file_mask))
@@ -598,12 +607,57 @@ void Snort::capture_packet()
     }
 }
 
+//-------------------------------------------------------------------------
+// idle slices
+//-------------------------------------------------------------------------
+// the housekeeping done by thread_idle() is also run from the packet loop in
+// bounded slices every packets.idle_slice_packets packets and / or
+// packets.idle_slice_usecs.  a slice times out up to packets.idle_slice_flows
+// flows while an idle call times out just one as before.
+
+static THREAD_LOCAL IdleSlice s_idle_slice;
+
+static void idle_slice_run()
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    Stopwatch<SnortClock> sw;
+    sw.start();
+
+    Stream::timeout_flows(packet_time(), snort_conf->idle_slice_flows);
+    perf_monitor_idle_process();
+    HighAvailabilityManager::process_receive();
+
+    aux_counts.idle_slices++;
+    aux_counts.idle_slice_usecs += clock_usecs(duration_cast<microseconds>(sw.get()).count());
+
+    s_idle_slice.reset();
+}
+
 void Snort::thread_idle()
 {
     Stream::timeout_flows(time(nullptr));
     perf_monitor_idle_process();
     aux_counts.idle++;
     HighAvailabilityManager::process_receive();
+    s_idle_slice.reset();
+}
+
+// when daq.batch_size is set, flow timeouts and HA receive are deferred from
+// packet_callback to here so they run once per acquired batch.  returns false
+// if the batch was empty so the caller can fall back to idle processing.
+bool Snort::thread_batch()
+{
+    if ( !s_batch_pkts )
+        return false;
+
+    s_batch_pkts = 0;
+    aux_counts.batches++;
+
+    Stream::timeout_flows(packet_time());
+    HighAvailabilityManager::process_receive();
+    return true;
 }
 
 void Snort::thread_rotate()
@@ -659,6 +713,9 @@ void Snort::thread_init_unprivileged()
     HighAvailabilityManager::thread_init(); // must be before InspectorManager::thread_init();
     InspectorManager::thread_init(snort_conf);
     HighAvailabilityManager::process_receive(); // in case there are HA messages waiting, process them first
+
+    s_idle_slice.init(
+        snort_conf->idle_slice_pkts, snort_conf->idle_slice_usecs, SnortClock::now());
 }
 
 void Snort::thread_term()
@@ -678,6 +735,8 @@ void Snort::thread_term()
     CodecManager::thread_term();
     HighAvailabilityManager::thread_term();
     SideChannelManager::thread_term();
+    InflatePool::tterm();
+    FileService::thread_term();
 
     if ( s_packet )
     {
@@ -850,8 +909,17 @@ DAQ_Verdict Snort::packet_callback(
 
     Active::reset();
     PacketManager::encode_reset();
-    Stream::timeout_flows(pkthdr->ts.tv_sec);
-    HighAvailabilityManager::process_receive();
+
+    if ( SFDAQ::get_batch_size() )
+        s_batch_pkts++;
+    else
+    {
+        Stream::timeout_flows(pkthdr->ts.tv_sec);
+        HighAvailabilityManager::process_receive();
+    }
+
+    if ( s_idle_slice.due() )
+        idle_slice_run();
 
     s_packet->pkth = nullptr;  // no longer avail upon sig segv
 
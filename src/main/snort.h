@@ -54,6 +54,7 @@ public:
     static void thread_term();
 
     static void thread_idle();
+    static bool thread_batch();
     static void thread_rotate();
 
     static void capture_packet();
@@ -278,6 +278,14 @@ void SnortConfig::setup()
 #ifdef HAVE_HYPERSCAN
     regex_setup(this);
     sdpattern_setup(this);
+#endif
+}
+
+// inspectors may build their own search engines when they are configured
+// so the shared hyperscan scratch is sized and cloned after that
+void SnortConfig::post_setup()
+{
+#ifdef HAVE_HYPERSCAN
     hyperscan_setup(this);
 #endif
 }
@@ -151,6 +151,7 @@ public:
     ~SnortConfig();
 
     void setup();
+    void post_setup();
     bool verify();
 
     void merge(SnortConfig*);
@@ -246,6 +247,10 @@ public:
     uint64_t pkt_cnt = 0;           /* -n */
     uint64_t pkt_skip = 0;
 
+    uint32_t idle_slice_pkts = 0;
+    uint32_t idle_slice_usecs = 0;
+    uint32_t idle_slice_flows = 16;
+
     std::string bpf_file;          /* -F or config bpf_file */
 
     //------------------------------------------------------
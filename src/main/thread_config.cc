@@ -81,6 +81,16 @@ unsigned ThreadConfig::get_instance_max()
     return instance_max;
 }
 
+// number of CPUs in our process's running cpuset
+unsigned ThreadConfig::get_cpu_count()
+{
+    if ( !process_cpuset )
+        return 1;
+
+    int n = hwloc_bitmap_weight(process_cpuset);
+    return n > 0 ? n : 1;
+}
+
 CpuSet* ThreadConfig::validate_cpuset_string(const char* cpuset_str)
 {
     hwloc_bitmap_t cpuset = hwloc_bitmap_alloc();
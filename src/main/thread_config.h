@@ -33,6 +33,7 @@ public:
     static void destroy_cpuset(CpuSet*);
     static void set_instance_max(unsigned);
     static unsigned get_instance_max();
+    static unsigned get_cpu_count();
     static void term();
 
     ~ThreadConfig();
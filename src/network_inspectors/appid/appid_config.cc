@@ -74,6 +74,7 @@ AppIdModuleConfig::~AppIdModuleConfig()
     snort_free((void*)app_stats_filename);
     snort_free((void*)app_detector_dir);
     snort_free((void*)thirdparty_appid_dir);
+    snort_free((void*)lua_cache_dir);
     pAppidActiveConfig = nullptr;
 
 }
@@ -29,6 +29,7 @@
 #include "service_plugins/service_config.h"
 
 #include "appid.h"
+#include "appid_pattern_matcher.h"
 #include "http_common.h"
 
 
@@ -85,6 +86,7 @@ public:
     unsigned long app_stats_rollover_time = 0;
     const char* app_detector_dir = nullptr;
     const char* thirdparty_appid_dir = nullptr;
+    const char* lua_cache_dir = nullptr;
     uint32_t instance_id = 0;
     uint32_t memcap = 0;
     bool debug = false;
@@ -164,6 +166,7 @@ public:
     ServiceSslConfig serviceSslConfig;      // SSL service configuration
     ServiceDnsConfig serviceDnsConfig;      // DNS service configuration
     ClientAppConfig clientAppConfig;        // Common configuration for all client applications
+    AppIdPatternMatcher patternMatcher;     // Service and client payload patterns
     HttpPatternLists httpPatternLists;
     ServicePortPattern* servicePortPattern = nullptr;
     ClientPortPattern* clientPortPattern = nullptr;
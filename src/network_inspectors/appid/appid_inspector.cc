@@ -25,6 +25,9 @@
 #include "config.h"
 #endif
 
+#include "detection/fp_config.h"
+#include "framework/mpse.h"
+#include "main/snort_config.h"
 #include "profiler/profiler.h"
 #include "appid_session.h"
 #include "fw_appid.h"
@@ -47,9 +50,11 @@ AppIdInspector::~AppIdInspector()
     delete config;
 }
 
-bool AppIdInspector::configure(SnortConfig*)
+bool AppIdInspector::configure(SnortConfig* sc)
 {
     active_config = new AppIdConfig( ( AppIdModuleConfig* )config);
+    active_config->patternMatcher.set_search_method(
+        sc->fast_pattern_config->get_search_api()->base.name);
     if(config->debug)
     	show(nullptr);
     return active_config->init_appid();
@@ -73,6 +78,8 @@ void AppIdInspector::show(SnortConfig*)
     LogMessage("AppId Configuration\n");
 
     LogMessage("    Detector Path:          %s\n", config->app_detector_dir);
+    LogMessage("    Lua Cache Path:         %s\n",
+        config->lua_cache_dir ? config->lua_cache_dir : "disabled");
     LogMessage("    appStats Files:         %s\n", config->app_stats_filename);
     LogMessage("    appStats Period:        %lu secs\n", config->app_stats_period);
     LogMessage("    appStats Rollover Size: %lu bytes\n",
@@ -109,6 +116,11 @@ static void appid_inspector_init()
     AppIdSession::init();
 }
 
+static void appid_inspector_tterm()
+{
+    AppIdPatternMatcher::tterm();
+}
+
 static Inspector* appid_inspector_ctor(Module* m)
 {
     AppIdModule* mod = (AppIdModule*)m;
@@ -141,7 +153,7 @@ const InspectApi appid_inspector_api =
     appid_inspector_init, // pinit
     nullptr, // pterm
     nullptr, // tinit
-    nullptr, // tterm
+    appid_inspector_tterm, // tterm
     appid_inspector_ctor,
     appid_inspector_dtor,
     nullptr, // ssn
@@ -41,6 +41,10 @@ const PegInfo appid_pegs[] =
     { "packets", "count of packets received by appid inspector" },
     { "processed packets", "count of packets processed by appid inspector" },
     { "ignored packets", "count of packets ignored by appid inspector" },
+    { "pattern scans", "count of payloads searched for service and client patterns" },
+    { "pattern scans shared",
+      "count of pattern lookups answered by an earlier search of the same payload" },
+    { "lua detector calls", "count of Lua detector validate calls" },
     { "battlefield_flows", "count of battle field flows discovered by appid" },
     { "bgp_flows", "count of bgp flows discovered by appid" },
     { "bit_clients", "count of bittorrent clients discovered by appid" },
@@ -110,6 +114,9 @@ static const Parameter s_params[] =
       "enable dump of AppId port information" },
     { "thirdparty_appid_dir", Parameter::PT_STRING, nullptr, nullptr,
       "directory to load thirdparty AppId detectors from" },
+    { "lua_cache_dir", Parameter::PT_STRING, nullptr, nullptr,
+      "directory to cache compiled Lua detector bytecode in; must be owned by the snort "
+      "user and not group or world writable (disabled if not set)" },
 
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
@@ -133,9 +140,22 @@ AppIdModule::~AppIdModule()
 {
 }
 
-ProfileStats* AppIdModule::get_profile() const
+ProfileStats* AppIdModule::get_profile(
+    unsigned index, const char*& name, const char*& parent) const
 {
-    return &appidPerfStats;
+    switch ( index )
+    {
+    case 0:
+        name = MOD_NAME;
+        parent = nullptr;
+        return &appidPerfStats;
+
+    case 1:
+        name = "appid_lua";
+        parent = MOD_NAME;
+        return &luaCustomPerfStats;
+    }
+    return nullptr;
 }
 
 const AppIdModuleConfig* AppIdModule::get_data()
@@ -163,6 +183,8 @@ bool AppIdModule::set(const char*, Value& v, SnortConfig*)
         config->app_detector_dir = snort_strdup(v.get_string());
     else if ( v.is("thirdparty_appid_dir") )
         config->thirdparty_appid_dir = snort_strdup(v.get_string());
+    else if ( v.is("lua_cache_dir") )
+        config->lua_cache_dir = snort_strdup(v.get_string());
     else if ( v.is("instance_id") )
         config->instance_id = v.get_long();
     else if ( v.is("debug") )
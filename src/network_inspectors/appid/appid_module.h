@@ -27,6 +27,7 @@
 #include "appid_config.h"
 
 extern THREAD_LOCAL ProfileStats appidPerfStats;
+extern THREAD_LOCAL ProfileStats luaCustomPerfStats;
 
 //-------------------------------------------------------------------------
 // stream module
@@ -40,6 +41,9 @@ struct AppIdStats
     PegCount packets;
     PegCount processed_packets;
     PegCount ignored_packets;
+    PegCount pattern_scans;
+    PegCount pattern_scans_shared;
+    PegCount lua_detector_calls;
     PegCount battlefield_flows;
     PegCount bgp_flows;
     PegCount bit_clients;
@@ -98,7 +102,7 @@ public:
 
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
-    ProfileStats* get_profile() const override;
+    ProfileStats* get_profile(unsigned, const char*&, const char*&) const override;
 
     const AppIdModuleConfig* get_data();
 
@@ -0,0 +1,251 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// appid_pattern_matcher.cc
+
+#include "appid_pattern_matcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "appid_module.h"
+#include "main/thread.h"
+#include "protocols/packet.h"
+#include "protocols/protocol_ids.h"
+#include "search_engines/search_tool.h"
+#include "utils/stats.h"
+
+struct PatternHandler
+{
+    AppIdPatternMatchFunc match;
+    AppIdPatternFreeFunc free;
+};
+
+static PatternHandler handlers[APPID_PATTERN_MAX];
+
+// the results of the last scan on this thread.  the Packet is reused so a
+// packet is recognized by its number and payload.
+struct ScanCache
+{
+    const AppIdPatternMatcher* owner;
+    PegCount packet;
+    const uint8_t* data;
+    uint16_t dsize;
+    IpProtocol proto;
+    unsigned pending;   // families that have not taken their list yet
+    void* lists[APPID_PATTERN_MAX];
+};
+
+static THREAD_LOCAL ScanCache scan_cache;
+
+struct ScanContext
+{
+    unsigned types;
+    void** lists;
+};
+
+static void release_scan_cache()
+{
+    ScanCache& c = scan_cache;
+
+    for ( unsigned i = 0; i < APPID_PATTERN_MAX; ++i )
+    {
+        if ( c.lists[i] )
+        {
+            handlers[i].free(c.lists[i]);
+            c.lists[i] = nullptr;
+        }
+    }
+    c.owner = nullptr;
+    c.pending = 0;
+}
+
+//-------------------------------------------------------------------------
+// class methods
+//-------------------------------------------------------------------------
+
+void AppIdPatternMatcher::set_handlers(
+    AppIdPatternType type, AppIdPatternMatchFunc mf, AppIdPatternFreeFunc ff)
+{
+    handlers[type].match = mf;
+    handlers[type].free = ff;
+}
+
+void AppIdPatternMatcher::tterm()
+{
+    release_scan_cache();
+}
+
+AppIdPatternMatcher::~AppIdPatternMatcher()
+{
+    delete tcp.search;
+    delete udp.search;
+}
+
+// the detectors count every hit of every pattern.  hyperscan reports each
+// pattern on its own, and without single match for SearchTool databases;
+// of the Aho-Corasick engines only ac_full implements search_all() and
+// reports all patterns that end in the same state.
+void AppIdPatternMatcher::set_search_method(const char* m)
+{
+    method = (m and !strcmp(m, "hyperscan")) ? m : "ac_full";
+}
+
+AppIdPatternMatcher::Engine* AppIdPatternMatcher::get_engine(IpProtocol proto)
+{
+    if ( proto == IpProtocol::TCP )
+        return &tcp;
+
+    if ( proto == IpProtocol::UDP )
+        return &udp;
+
+    return nullptr;
+}
+
+const AppIdPatternMatcher::Engine* AppIdPatternMatcher::get_engine(IpProtocol proto) const
+{
+    return const_cast<AppIdPatternMatcher*>(this)->get_engine(proto);
+}
+
+// the search engine holds pointers into the pattern vectors so it is
+// dropped whenever they change and rebuilt by prep()
+void AppIdPatternMatcher::invalidate()
+{
+    delete tcp.search;
+    tcp.search = nullptr;
+
+    delete udp.search;
+    udp.search = nullptr;
+
+    dirty = true;
+}
+
+void AppIdPatternMatcher::add(IpProtocol proto, AppIdPatternType type,
+    const uint8_t* pattern, unsigned size, bool nocase, void* data)
+{
+    Engine* e = get_engine(proto);
+
+    if ( !e )
+        return;
+
+    invalidate();
+    e->patterns.push_back({ std::string((const char*)pattern, size), type, nocase, data });
+}
+
+void AppIdPatternMatcher::remove(AppIdPatternType type)
+{
+    invalidate();
+
+    for ( Engine* e : { &tcp, &udp } )
+    {
+        auto& v = e->patterns;
+        v.erase(std::remove_if(v.begin(), v.end(),
+            [type](const Pattern& p) { return p.type == type; }), v.end());
+    }
+}
+
+void AppIdPatternMatcher::prep()
+{
+    if ( !dirty )
+        return;
+
+    for ( Engine* e : { &tcp, &udp } )
+    {
+        e->types = 0;
+
+        if ( e->patterns.empty() )
+            continue;
+
+        e->search = new SearchTool(method.c_str());
+
+        for ( auto& p : e->patterns )
+        {
+            e->search->add((const uint8_t*)p.bytes.data(), p.bytes.size(), &p, p.nocase);
+            e->types |= 1u << p.type;
+        }
+        e->search->prep();
+    }
+    dirty = false;
+}
+
+int AppIdPatternMatcher::dispatch(void* id, void*, int index, void* context, void*)
+{
+    const Pattern* p = (const Pattern*)id;
+    ScanContext* sc = (ScanContext*)context;
+
+    if ( sc->types & (1u << p->type) )
+        handlers[p->type].match(p->data, index, &sc->lists[p->type]);
+
+    return 0;
+}
+
+void AppIdPatternMatcher::scan(
+    const Packet* p, const Engine* e, unsigned types, void** lists) const
+{
+    ScanContext sc = { types, lists };
+
+    e->search->find_all((const char*)p->data, p->dsize, dispatch, false, &sc);
+    appid_stats.pattern_scans++;
+}
+
+void* AppIdPatternMatcher::get_matches(
+    const Packet* p, IpProtocol proto, AppIdPatternType type) const
+{
+    const Engine* e = get_engine(proto);
+    const unsigned bit = 1u << type;
+
+    if ( !e or !e->search or !(e->types & bit) )
+        return nullptr;
+
+    ScanCache& c = scan_cache;
+
+    if ( c.owner == this and c.packet == get_packet_number() and
+        c.data == p->data and c.dsize == p->dsize and c.proto == proto )
+    {
+        if ( c.pending & bit )
+        {
+            void* list = c.lists[type];
+            c.lists[type] = nullptr;
+            c.pending &= ~bit;
+            appid_stats.pattern_scans_shared++;
+            return list;
+        }
+
+        // this family already has its results for the packet so it is
+        // searched again on its own without disturbing the others
+        void* lists[APPID_PATTERN_MAX] = { };
+        scan(p, e, bit, lists);
+        return lists[type];
+    }
+
+    release_scan_cache();
+
+    c.owner = this;
+    c.packet = get_packet_number();
+    c.data = p->data;
+    c.dsize = p->dsize;
+    c.proto = proto;
+
+    scan(p, e, e->types, c.lists);
+
+    void* list = c.lists[type];
+    c.lists[type] = nullptr;
+    c.pending = e->types & ~bit;
+    return list;
+}
+
@@ -0,0 +1,101 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// appid_pattern_matcher.h
+
+#ifndef APPID_PATTERN_MATCHER_H
+#define APPID_PATTERN_MATCHER_H
+
+// The payload patterns of every service and client detector for an IP
+// protocol are compiled into one search engine so each packet is scanned
+// once.  Each pattern remembers which detector family registered it and
+// hits are handed to that family's match function, which builds the same
+// match list its own search used to.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SearchTool;
+struct Packet;
+enum class IpProtocol : uint8_t;
+
+enum AppIdPatternType
+{
+    APPID_PATTERN_SERVICE = 0,
+    APPID_PATTERN_CLIENT,
+    APPID_PATTERN_MAX
+};
+
+// data is what was given to add(), index is the search engine's offset for
+// the hit, and list is the match list being built for the detector family
+typedef void (* AppIdPatternMatchFunc)(void* data, int index, void** list);
+typedef void (* AppIdPatternFreeFunc)(void* list);
+
+class AppIdPatternMatcher
+{
+public:
+    AppIdPatternMatcher() = default;
+    ~AppIdPatternMatcher();
+
+    static void set_handlers(AppIdPatternType, AppIdPatternMatchFunc, AppIdPatternFreeFunc);
+    static void tterm();
+
+    // picks the engine from the configured detection search method
+    void set_search_method(const char*);
+
+    void add(IpProtocol, AppIdPatternType, const uint8_t* pattern, unsigned size,
+        bool nocase, void* data);
+    void remove(AppIdPatternType);
+    void prep();
+
+    // the first call for a packet scans it for all detector families and
+    // later calls for the other families return what that scan found
+    void* get_matches(const Packet*, IpProtocol, AppIdPatternType) const;
+
+private:
+    struct Pattern
+    {
+        std::string bytes;
+        AppIdPatternType type;
+        bool nocase;
+        void* data;
+    };
+
+    struct Engine
+    {
+        std::vector<Pattern> patterns;
+        SearchTool* search = nullptr;
+        unsigned types = 0;
+    };
+
+    static int dispatch(void* id, void* tree, int index, void* context, void* neg_list);
+
+    Engine* get_engine(IpProtocol);
+    const Engine* get_engine(IpProtocol) const;
+    void invalidate();
+    void scan(const Packet*, const Engine*, unsigned types, void** lists) const;
+
+    Engine tcp;
+    Engine udp;
+    std::string method = "ac_full";
+    bool dirty = false;
+};
+
+#endif
+
@@ -66,6 +66,8 @@ static void* client_app_flowdata_get(AppIdSession* flowp, unsigned client_id);
 static int client_app_flowdata_add(AppIdSession* flowp, void* data, unsigned client_id, AppIdFreeFCN
     fcn);
 static void AppIdAddClientAppInfo(AppIdSession* flowp, const char* info);
+static void pattern_match(void* id, int index, void** data);
+static void free_pattern_matches(void* list);
 
 static const ClientAppApi client_app_api =
 {
@@ -205,21 +207,22 @@ const RNAClientAppModule* ClientAppGetClientAppModule(RNAClientAppFCN fcn, struc
     return nullptr;
 }
 
-static void add_pattern_data(SearchTool* st, const RNAClientAppModule* li, int position,
+static void add_pattern_data(IpProtocol proto, const RNAClientAppModule* li, int position,
         const uint8_t* const pattern, unsigned size, unsigned nocase,
-        int* count, ClientAppConfig* pClientAppConfig)
+        int* count, AppIdConfig* pConfig)
 {
+    ClientAppConfig* pClientAppConfig = &pConfig->clientAppConfig;
     ClientPatternData* pd = (ClientPatternData*)snort_calloc(sizeof(ClientPatternData));
     pd->ca = li;
     pd->position = position;
     (*count)++;
     pd->next = pClientAppConfig->pattern_data_list;
     pClientAppConfig->pattern_data_list = pd;
-    st->add((const char*)pattern, size, pd, nocase);
+    pConfig->patternMatcher.add(proto, APPID_PATTERN_CLIENT, pattern, size, nocase, pd);
 }
 
 static void clientCreatePattern(IpProtocol proto, const uint8_t* const pattern, unsigned size,
-    int position, unsigned nocase, const RNAClientAppModule* li, ClientAppConfig* pClientAppConfig)
+    int position, unsigned nocase, const RNAClientAppModule* li, AppIdConfig* pConfig)
 {
     int* count;
 
@@ -231,19 +234,13 @@ static void clientCreatePattern(IpProtocol proto, const uint8_t* const pattern,
 
     if (proto == IpProtocol::TCP)
     {
-        if (!pClientAppConfig->tcp_patterns)
-            pClientAppConfig->tcp_patterns = new SearchTool("ac_full");
-        count = &pClientAppConfig->tcp_pattern_count;
-        add_pattern_data(pClientAppConfig->tcp_patterns, li, position, pattern, size,
-            nocase, count, pClientAppConfig);
+        count = &pConfig->clientAppConfig.tcp_pattern_count;
+        add_pattern_data(proto, li, position, pattern, size, nocase, count, pConfig);
     }
     else if (proto == IpProtocol::UDP)
     {
-        if (!pClientAppConfig->udp_patterns)
-            pClientAppConfig->udp_patterns = new SearchTool("ac_full");
-        count = &pClientAppConfig->udp_pattern_count;
-        add_pattern_data(pClientAppConfig->udp_patterns, li, position, pattern, size,
-            nocase, count, pClientAppConfig);
+        count = &pConfig->clientAppConfig.udp_pattern_count;
+        add_pattern_data(proto, li, position, pattern, size, nocase, count, pConfig);
     }
     else
     {
@@ -255,36 +252,34 @@ static void CClientAppRegisterPattern(RNAClientAppFCN fcn, IpProtocol proto,
     const uint8_t* const pattern, unsigned size,
     int position, AppIdConfig* pConfig)
 {
-    ClientAppRegisterPattern(fcn, proto, pattern, size, position, 0, nullptr,
-        &pConfig->clientAppConfig);
+    ClientAppRegisterPattern(fcn, proto, pattern, size, position, 0, nullptr, pConfig);
 }
 
 static void CClientAppRegisterPatternNoCase(RNAClientAppFCN fcn, IpProtocol proto,
     const uint8_t* const pattern, unsigned size,
     int position, AppIdConfig* pConfig)
 {
-    ClientAppRegisterPattern(fcn, proto, pattern, size, position, 1, nullptr,
-        &pConfig->clientAppConfig);
+    ClientAppRegisterPattern(fcn, proto, pattern, size, position, 1, nullptr, pConfig);
 }
 
 static void LuaClientAppRegisterPattern(RNAClientAppFCN fcn, IpProtocol proto,
     const uint8_t* const pattern, unsigned size, int position, struct Detector* userData)
 {
     ClientAppRegisterPattern(fcn, proto, pattern, size, position, 0, userData,
-        &userData->pAppidNewConfig->clientAppConfig);
+        userData->pAppidNewConfig);
 }
 
 void ClientAppRegisterPattern(RNAClientAppFCN fcn, IpProtocol proto, const uint8_t* const pattern,
     unsigned size, int position, unsigned nocase, struct Detector* userData,
-    ClientAppConfig* pClientAppConfig)
+    AppIdConfig* pConfig)
 {
     RNAClientAppRecord* list;
     RNAClientAppRecord* li;
 
     if (proto == IpProtocol::TCP)
-        list = pClientAppConfig->tcp_client_app_list;
+        list = pConfig->clientAppConfig.tcp_client_app_list;
     else if (proto == IpProtocol::UDP)
-        list = pClientAppConfig->udp_client_app_list;
+        list = pConfig->clientAppConfig.udp_client_app_list;
     else
     {
         ErrorMessage("Invalid protocol when registering a pattern: %u\n",(unsigned)proto);
@@ -295,8 +290,7 @@ void ClientAppRegisterPattern(RNAClientAppFCN fcn, IpProtocol proto, const uint8
     {
         if ((li->module->validate == fcn) && (li->module->userData == userData))
         {
-            clientCreatePattern(proto, pattern, size, position, nocase,
-                    li->module, pClientAppConfig);
+            clientCreatePattern(proto, pattern, size, position, nocase, li->module, pConfig);
             break;
         }
     }
@@ -590,12 +584,7 @@ void UnconfigureClientApp(AppIdConfig* pConfig)
     for (li = pConfig->clientAppConfig.udp_client_app_list; li; li = li->next)
         clean_module(li);
 
-    // FIXIT - should this be deleted here? or move this clean up to a dtor?
-    delete pConfig->clientAppConfig.tcp_patterns;
-    pConfig->clientAppConfig.tcp_patterns = nullptr;
-
-    delete pConfig->clientAppConfig.udp_patterns;
-    pConfig->clientAppConfig.udp_patterns = nullptr;
+    pConfig->patternMatcher.remove(APPID_PATTERN_CLIENT);
 
     while (pConfig->clientAppConfig.pattern_data_list)
     {
@@ -623,6 +612,9 @@ void ClientAppInit(AppIdConfig* pConfig)
 {
     RNAClientAppRecord* li;
 
+    AppIdPatternMatcher::set_handlers(APPID_PATTERN_CLIENT, pattern_match,
+        free_pattern_matches);
+
     sflist_init(&pConfig->clientAppConfig.module_configs);
     pConfig->clientAppConfig.enabled = 1;
 
@@ -650,16 +642,12 @@ void ClientAppInit(AppIdConfig* pConfig)
     }
 }
 
+// the pattern matcher is shared with the services so this builds it for
+// both and ServiceFinalize() finds nothing left to do
 void ClientAppFinalize(AppIdConfig* pConfig)
 {
     if (pConfig->clientAppConfig.enabled)
-    {
-        if ( pConfig->clientAppConfig.tcp_patterns )
-            pConfig->clientAppConfig.tcp_patterns->prep();
-
-        if ( pConfig->clientAppConfig.udp_patterns )
-            pConfig->clientAppConfig.udp_patterns->prep();
-    }
+        pConfig->patternMatcher.prep();
 }
 
 struct ClientAppMatch
@@ -681,16 +669,8 @@ void CleanupClientApp(AppIdConfig* pConfig )
     RNAClientAppRecord* li;
 
     clean_api.pAppidConfig = pConfig;
-    if (pConfig->clientAppConfig.tcp_patterns)
-    {
-        delete pConfig->clientAppConfig.tcp_patterns;
-        pConfig->clientAppConfig.tcp_patterns = nullptr;
-    }
-    if (pConfig->clientAppConfig.udp_patterns)
-    {
-        delete pConfig->clientAppConfig.udp_patterns;
-        pConfig->clientAppConfig.udp_patterns = nullptr;
-    }
+    pConfig->patternMatcher.remove(APPID_PATTERN_CLIENT);
+
     while ((pd = pConfig->clientAppConfig.pattern_data_list) != nullptr)
     {
         pConfig->clientAppConfig.pattern_data_list = pd->next;
@@ -737,15 +717,14 @@ void CleanupClientApp(AppIdConfig* pConfig )
  * @return response
  * @retval 1        commands caller to stop searching
  */
-static int pattern_match(void* id, void* /*unused_tree*/, int index, void* data,
-    void* /*unused_neg*/)
+static void pattern_match(void* id, int index, void** data)
 {
     ClientAppMatch** matches = (ClientAppMatch**)data;
     ClientPatternData* pd = (ClientPatternData*)id;
     ClientAppMatch* cam;
 
     if ( pd->position >= 0 && pd->position != index )
-        return 0;
+        return;
 
     for (cam = *matches; cam; cam = cam->next)
     {
@@ -771,7 +750,6 @@ static int pattern_match(void* id, void* /*unused_tree*/, int index, void* data,
         cam->next = *matches;
         *matches = cam;
     }
-    return 0;
 }
 
 void AppIdAddClientApp(AppIdSession* flowp, AppId service_id, AppId id, const char* version)
@@ -803,22 +781,10 @@ static void AppIdAddClientAppInfo(AppIdSession* flowp, const char* info)
 }
 
 static ClientAppMatch* BuildClientPatternList(const Packet* pkt, IpProtocol protocol,
-    const ClientAppConfig* pClientAppConfig)
+    const AppIdConfig* pConfig)
 {
-    ClientAppMatch* match_list = nullptr;
-    SearchTool* patterns;
-
-    if (protocol == IpProtocol::TCP)
-        patterns = pClientAppConfig->tcp_patterns;
-    else
-        patterns = pClientAppConfig->udp_patterns;
-
-    if (!patterns)
-        return nullptr;
-
-    patterns->find_all((char*)pkt->data, pkt->dsize, &pattern_match, false, (void*)&match_list);
-
-    return match_list;
+    return (ClientAppMatch*)pConfig->patternMatcher.get_matches(pkt, protocol,
+        APPID_PATTERN_CLIENT);
 }
 
 static const RNAClientAppModule* GetNextFromClientPatternList(ClientAppMatch** match_list)
@@ -885,6 +851,12 @@ static void FreeClientPatternList(ClientAppMatch** match_list)
     *match_list = nullptr;
 }
 
+static void free_pattern_matches(void* list)
+{
+    ClientAppMatch* match_list = (ClientAppMatch*)list;
+    FreeClientPatternList(&match_list);
+}
+
 /**
  * The process to determine the running client app given the packet data.
  *
@@ -918,7 +890,7 @@ static void ClientAppID(Packet* p, const int /*direction*/, AppIdSession* flowp,
         flowp->num_candidate_clients_tried = 0;
     }
 
-    match_list = BuildClientPatternList(p, flowp->protocol, &pConfig->clientAppConfig);
+    match_list = BuildClientPatternList(p, flowp->protocol, pConfig);
     while (flowp->num_candidate_clients_tried < MAX_CANDIDATE_CLIENTS)
     {
         const RNAClientAppModule* tmp = GetNextFromClientPatternList(&match_list);
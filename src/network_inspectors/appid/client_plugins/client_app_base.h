@@ -48,7 +48,7 @@ int ClientAppLoadForConfigCallback(void* symbol, ClientAppConfig*);
 void appSetClientValidator(RNAClientAppFCN, AppId, unsigned extractsInfo, AppIdConfig*);
 int LoadClientAppModules(AppIdConfig*);
 void ClientAppRegisterPattern(RNAClientAppFCN, IpProtocol proto, const uint8_t* const pattern,
-        unsigned size, int position, unsigned nocase, Detector*, ClientAppConfig*);
+        unsigned size, int position, unsigned nocase, Detector*, AppIdConfig*);
 const ClientAppApi* getClientApi();
 RNAClientAppModuleConfig* getClientAppModuleConfig(const char* moduleName, ClientAppConfig*);
 int AppIdDiscoverClientApp(Packet* p, int direction, AppIdSession*, const AppIdConfig*);
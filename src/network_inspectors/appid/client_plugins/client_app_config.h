@@ -42,9 +42,7 @@ struct ClientAppConfig
     int enabled;
     SF_LIST module_configs;
     ClientPatternData* pattern_data_list;
-    SearchTool* tcp_patterns;
     int tcp_pattern_count;
-    SearchTool* udp_patterns;
     int udp_pattern_count;
 };
 
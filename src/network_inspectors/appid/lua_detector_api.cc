@@ -31,6 +31,7 @@
 #include "main/snort_debug.h"
 #include "profiler/profiler.h"
 #include "sfip/sf_ip.h"
+#include "time/stopwatch.h"
 #include "utils/util.h"
 
 #include "appid_module.h"
@@ -73,7 +74,7 @@ enum
 
 ProfileStats luaDetectorsPerfStats;
 ProfileStats luaCiscoPerfStats;
-ProfileStats luaCustomPerfStats;
+THREAD_LOCAL ProfileStats luaCustomPerfStats;
 
 static void FreeDetectorAppUrlPattern(DetectorAppUrlPattern* pattern);
 
@@ -391,6 +392,21 @@ static int service_analyzePayload(lua_State* L)
     return 0;
 }
 
+// Calls the detector validate function already pushed on L and charges the call to
+// the detector so hot detectors show up in the Lua detector stats.
+static inline int callValidator(Detector* detector, lua_State* L)
+{
+    Stopwatch<SnortClock> sw;
+    sw.start();
+
+    int rc = lua_pcall(L, 0, 1, 0);
+
+    detector->validate_ticks.fetch_add(sw.get().count(), std::memory_order_relaxed);
+    detector->validate_calls.fetch_add(1, std::memory_order_relaxed);
+    appid_stats.lua_detector_calls++;
+    return rc;
+}
+
 // Design notes: Due to following two design limitations:
 //  a. lua validate functions, known only at runtime, can not be wrapped inside unique
 //     C functions at runtime and
@@ -440,7 +456,7 @@ int validateAnyService(ServiceValidationArgs* args)
         LUA_GCCOUNT, 0));
     DebugFormat(DEBUG_APPID,"server %s: validating\n", serverName.c_str());
 
-    if ( lua_pcall(L, 0, 1, 0) )
+    if ( callValidator(detector, L) )
     {
         /*Runtime Lua errors are suppressed in production code since detectors are written for
           efficiency
@@ -1082,7 +1098,7 @@ CLIENT_APP_RETCODE validateAnyClientApp(
         LUA_GCCOUNT,0));
     DebugFormat(DEBUG_APPID,"client %s: validating\n",clientName);
 
-    if (lua_pcall(myLuaState, 0, 1, 0))
+    if (callValidator(detector, myLuaState))
     {
         ErrorMessage("client %s: error validating %s\n",clientName, lua_tostring(myLuaState, -1));
         detector->validateParams.pkt = nullptr;
@@ -1135,7 +1151,7 @@ static int client_registerPattern(lua_State* L)
         &ud->pAppidNewConfig->clientAppConfig);
     ClientAppRegisterPattern(
         validateAnyClientApp, protocol, (const uint8_t*)pattern, size,
-        position, 0, ud, &ud->pAppidNewConfig->clientAppConfig);
+        position, 0, ud, ud->pAppidNewConfig);
 
     lua_pushnumber(L, 0);
     return 1;   /*number of results */
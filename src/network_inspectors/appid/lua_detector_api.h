@@ -24,11 +24,13 @@
 
 // This module supports basic API towards Lua detectors.
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 
 #include "client_plugins/client_app_api.h"
 #include "service_plugins/service_api.h"
+#include "time/clock_defs.h"
 
 struct Packet;
 struct ProfileStats;
@@ -120,6 +122,11 @@ struct Detector
     char* validatorBuffer;
     unsigned char digest[16];
 
+    /**Number of validate calls into this detector and the clock ticks spent in them.
+     * Detectors are shared by the packet threads. */
+    std::atomic<uint64_t> validate_calls { 0 };
+    std::atomic<hr_duration::rep> validate_ticks { 0 };
+
     AppIdConfig* pAppidActiveConfig;     ///< AppId context in which this detector should be used;
                                           // used during packet processing
     AppIdConfig* pAppidOldConfig;        ///< AppId context in which this detector should be
@@ -0,0 +1,300 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// lua_detector_cache.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "lua_detector_cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <lua.hpp>
+
+#include "log/messages.h"
+#include "main/snort_debug.h"
+
+#ifdef UNIT_TEST
+#include <cstring>
+#include "catch/catch.hpp"
+#include "lua/lua.h"
+#endif
+
+#define DIGEST_SIZE 16
+
+// anyone else able to write here could get their bytecode run by us
+static bool is_private(const struct stat& st)
+{ return st.st_uid == geteuid() && !(st.st_mode & (S_IWGRP | S_IWOTH)); }
+
+LuaDetectorCache::LuaDetectorCache(const char* s) : dir(s)
+{
+    if ( !dir || !*dir )
+        return;
+
+    struct stat st;
+
+    if ( stat(dir, &st) || !S_ISDIR(st.st_mode) || !is_private(st) )
+    {
+        WarningMessage("AppId: not using lua_cache_dir %s; it must be a directory owned by "
+            "this user and not writable by group or others\n", dir);
+        dir = nullptr;
+    }
+}
+
+bool LuaDetectorCache::get_path(const unsigned char* digest, std::string& path) const
+{
+    if ( !dir || !*dir )
+        return false;
+
+    char hex[2 * DIGEST_SIZE + 1];
+
+    for ( unsigned i = 0; i < DIGEST_SIZE; i++ )
+        snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+
+    path = dir;
+    path += "/";
+    path += hex;
+    path += ".luac";
+    return true;
+}
+
+bool LuaDetectorCache::load_file(lua_State* L, const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if ( !file )
+        return false;
+
+    struct stat st;
+
+    if ( fstat(fileno(file), &st) || !S_ISREG(st.st_mode) || !is_private(st) )
+    {
+        fclose(file);
+        return false;
+    }
+
+    std::string code;
+    char buf[4096];
+    size_t n;
+
+    while ( (n = fread(buf, 1, sizeof(buf), file)) > 0 )
+        code.append(buf, n);
+
+    fclose(file);
+
+    if ( code.empty() )
+        return false;
+
+    // bytecode built by a different Lua version fails here and is rebuilt from source
+    if ( luaL_loadbuffer(L, code.data(), code.size(), "<buffer>") )
+    {
+        lua_pop(L, 1);
+        return false;
+    }
+    return true;
+}
+
+static int write_bytecode(lua_State*, const void* p, size_t size, void* ud)
+{
+    static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+    return 0;
+}
+
+// write to a unique temporary file and rename so a concurrent start never
+// sees a partial entry
+void LuaDetectorCache::save_file(lua_State* L, const std::string& path)
+{
+    std::string code;
+
+    if ( lua_dump(L, write_bytecode, &code) || code.empty() )
+        return;
+
+    std::string tmp = path + ".XXXXXX";
+    int fd = mkstemp(&tmp[0]);
+    FILE* file = (fd < 0) ? nullptr : fdopen(fd, "wb");
+
+    if ( !file )
+    {
+        DebugFormat(DEBUG_APPID, "cannot write Lua bytecode cache %s\n", tmp.c_str());
+
+        if ( fd >= 0 )
+        {
+            close(fd);
+            unlink(tmp.c_str());
+        }
+        return;
+    }
+
+    bool ok = fwrite(code.data(), code.size(), 1, file) == 1;
+
+    if ( fclose(file) || !ok || rename(tmp.c_str(), path.c_str()) )
+        unlink(tmp.c_str());
+}
+
+int LuaDetectorCache::load(
+    lua_State* L, const char* source, size_t len, const unsigned char* digest)
+{
+    std::string path;
+    bool cache = get_path(digest, path);
+
+    if ( cache && load_file(L, path) )
+    {
+        hits++;
+        return 0;
+    }
+
+    if ( int rval = luaL_loadbuffer(L, source, len, "<buffer>") )
+        return rval;
+
+    compiles++;
+
+    if ( cache )
+        save_file(L, path);
+
+    return 0;
+}
+
+#ifdef UNIT_TEST
+static const char* s_source = "value = 42";
+
+static bool run_chunk(Lua::State& lua)
+{
+    lua_State* L = lua.get_ptr();
+
+    if ( lua_pcall(L, 0, 0, 0) )
+        return false;
+
+    lua_getglobal(L, "value");
+    bool ok = lua_tonumber(L, -1) == 42;
+    lua_pop(L, 1);
+    return ok;
+}
+
+TEST_CASE("lua detector cache", "[appid]")
+{
+    char dir[] = "/tmp/lua_detector_cache_XXXXXX";
+    REQUIRE(mkdtemp(dir));
+
+    unsigned char digest[DIGEST_SIZE];
+    memset(digest, 0xa5, sizeof(digest));
+
+    std::string path = dir;
+    path += "/a5a5a5a5a5a5a5a5a5a5a5a5a5a5a5a5.luac";
+
+    SECTION("miss then hit")
+    {
+        LuaDetectorCache cache(dir);
+        Lua::State lua;
+
+        CHECK(cache.load(lua.get_ptr(), s_source, strlen(s_source), digest) == 0);
+        CHECK(run_chunk(lua));
+        CHECK(cache.get_compiles() == 1);
+        CHECK(access(path.c_str(), R_OK) == 0);
+
+        Lua::State lua2;
+        CHECK(cache.load(lua2.get_ptr(), s_source, strlen(s_source), digest) == 0);
+        CHECK(run_chunk(lua2));
+        CHECK(cache.get_hits() == 1);
+        CHECK(cache.get_compiles() == 1);
+    }
+
+    SECTION("bad entry falls back to source")
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        REQUIRE(file);
+        fputs("\033LJ garbage", file);
+        fclose(file);
+
+        LuaDetectorCache cache(dir);
+        Lua::State lua;
+
+        CHECK(cache.load(lua.get_ptr(), s_source, strlen(s_source), digest) == 0);
+        CHECK(run_chunk(lua));
+        CHECK(cache.get_hits() == 0);
+        CHECK(cache.get_compiles() == 1);
+
+        // the entry was rewritten
+        Lua::State lua2;
+        CHECK(cache.load(lua2.get_ptr(), s_source, strlen(s_source), digest) == 0);
+        CHECK(run_chunk(lua2));
+        CHECK(cache.get_hits() == 1);
+    }
+
+    SECTION("disabled")
+    {
+        LuaDetectorCache cache(nullptr);
+        Lua::State lua;
+
+        CHECK(cache.load(lua.get_ptr(), s_source, strlen(s_source), digest) == 0);
+        CHECK(run_chunk(lua));
+        CHECK(cache.get_compiles() == 1);
+        CHECK(access(path.c_str(), R_OK) != 0);
+    }
+
+    SECTION("unsafe dir")
+    {
+        REQUIRE(chmod(dir, 0777) == 0);
+        LuaDetectorCache cache(dir);
+        Lua::State lua;
+
+        CHECK(cache.load(lua.get_ptr(), s_source, strlen(s_source), digest) == 0);
+        CHECK(run_chunk(lua));
+        CHECK(cache.get_compiles() == 1);
+        CHECK(access(path.c_str(), R_OK) != 0);
+        chmod(dir, 0700);
+    }
+
+    SECTION("unsafe entry")
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        REQUIRE(file);
+        fclose(file);
+        chmod(path.c_str(), 0666);
+
+        LuaDetectorCache cache(dir);
+        Lua::State lua;
+
+        CHECK(cache.load(lua.get_ptr(), s_source, strlen(s_source), digest) == 0);
+        CHECK(cache.get_hits() == 0);
+        CHECK(cache.get_compiles() == 1);
+
+        // replaced by a private entry
+        struct stat st;
+        REQUIRE(stat(path.c_str(), &st) == 0);
+        CHECK((st.st_mode & 0777) == 0600);
+    }
+
+    SECTION("syntax error")
+    {
+        LuaDetectorCache cache(dir);
+        Lua::State lua;
+
+        CHECK(cache.load(lua.get_ptr(), "value =", 7, digest) != 0);
+        CHECK(cache.get_compiles() == 0);
+        CHECK(access(path.c_str(), R_OK) != 0);
+    }
+
+    unlink(path.c_str());
+    rmdir(dir);
+}
+#endif
+
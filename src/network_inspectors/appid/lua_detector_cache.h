@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// lua_detector_cache.h
+
+#ifndef LUA_DETECTOR_CACHE_H
+#define LUA_DETECTOR_CACHE_H
+
+// Compiled detectors are cached as <dir>/<md5 of source>.luac so an unchanged
+// detector is loaded from bytecode instead of being parsed again on each start
+// and reload.  A changed detector gets a new digest and therefore a new entry.
+// Since bytecode is not verified when loaded, the cache is only used if the
+// directory and each entry are owned by this user and not writable by others.
+
+#include <cstddef>
+#include <string>
+
+struct lua_State;
+
+class LuaDetectorCache
+{
+public:
+    // caching is disabled if dir is null, empty, or not safe to load from
+    LuaDetectorCache(const char* dir);
+
+    // loads the detector chunk from the cache, or compiles the source and
+    // caches the result.  returns 0 with the chunk on the stack, else the
+    // luaL_loadbuffer() error with the message on the stack.
+    int load(lua_State*, const char* source, size_t len, const unsigned char* digest);
+
+    unsigned get_hits() const
+    { return hits; }
+
+    unsigned get_compiles() const
+    { return compiles; }
+
+private:
+    bool get_path(const unsigned char* digest, std::string&) const;
+    bool load_file(lua_State*, const std::string&);
+    void save_file(lua_State*, const std::string&);
+
+private:
+    const char* dir;
+    unsigned hits = 0;
+    unsigned compiles = 0;
+};
+
+#endif
+
@@ -25,6 +25,7 @@
 
 #include <list>
 #include <algorithm>
+#include <chrono>
 #include <glob.h>
 #include <lua.hpp>
 #include <openssl/md5.h>
@@ -36,6 +37,7 @@
 #include "log/messages.h"
 #include "lua/lua.h"
 #include "lua_detector_api.h"
+#include "lua_detector_cache.h"
 #include "lua_detector_flow_api.h"
 #include "main/snort_debug.h"
 #include "utils/util.h"
@@ -62,6 +64,8 @@ SF_LIST allocatedFlowList;  /*list of flows allocated. */
 static uint32_t gLuaTrackerSize = 0;
 static unsigned gNumDetectors = 0;
 static unsigned gNumActiveDetectors;
+static unsigned gNumCachedLoads = 0;
+static unsigned gNumSourceLoads = 0;
 
 static inline bool match_char_set(char c, const char* set)
 {
@@ -409,7 +413,7 @@ static inline void setLuaTrackerSize(lua_State* L, uint32_t numTrackers)
 }
 
 static void luaCustomLoad( char* detectorName, char* validator, unsigned int validatorLen,
-        unsigned char* const digest, AppIdConfig* pConfig, bool isCustom)
+        unsigned char* const digest, AppIdConfig* pConfig, LuaDetectorCache& cache, bool isCustom)
 {
     Detector* detector;
     RNAClientAppModule* cam = nullptr;
@@ -422,7 +426,7 @@ static void luaCustomLoad( char* detectorName, char* validator, unsigned int val
         return;
     }
 
-    if ( luaL_loadbuffer(L, validator, validatorLen, "<buffer>") || lua_pcall(L, 0, 0, 0) )
+    if ( cache.load(L, validator, validatorLen, digest) || lua_pcall(L, 0, 0, 0) )
     {
         ErrorMessage("cannot run validator %s, error: %s\n", detectorName, lua_tostring(L, -1));
         lua_close(L);
@@ -508,7 +512,8 @@ static inline uint32_t calculateLuaTrackerSize(uint64_t rnaMemory, uint32_t numD
     return (numTrackers > LUA_TRACKERS_MAX) ? LUA_TRACKERS_MAX : numTrackers;
 }
 
-static void loadCustomLuaModules(char* path, AppIdConfig* pConfig, bool isCustom)
+static void loadCustomLuaModules(
+    char* path, AppIdConfig* pConfig, LuaDetectorCache& cache, bool isCustom)
 {
     unsigned n;
     FILE* file;
@@ -599,7 +604,7 @@ static void loadCustomLuaModules(char* path, AppIdConfig* pConfig, bool isCustom
         }
 
         luaCustomLoad(detectorName, (char*)validatorBuffer, validatorBufferLen, digest, pConfig,
-            isCustom);
+            cache, isCustom);
     }
 
     globfree(&globs);
@@ -637,12 +642,17 @@ void LuaDetectorModuleManager::LoadLuaModules(AppIdConfig* pConfig)
             detector->server.pServiceElement->ref_count = 0;
     }
 
+    LuaDetectorCache cache(pConfig->mod_config->lua_cache_dir);
+
     char path[PATH_MAX];
     snprintf(path, sizeof(path), "%s/odp/lua", pAppidActiveConfig->mod_config->app_detector_dir);
-    loadCustomLuaModules(path, pConfig, 0);
+    loadCustomLuaModules(path, pConfig, cache, 0);
     snprintf(path, sizeof(path), "%s/custom/lua",
         pAppidActiveConfig->mod_config->app_detector_dir);
-    loadCustomLuaModules(path, pConfig, 1);
+    loadCustomLuaModules(path, pConfig, cache, 1);
+
+    gNumCachedLoads = cache.get_hits();
+    gNumSourceLoads = cache.get_compiles();
     // luaDetectorsCleanInactive();
 }
 
@@ -748,9 +758,13 @@ void LuaDetectorModuleManager::luaModuleFini()
 
 void RNAPndDumpLuaStats()
 {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
     size_t totalMem = 0;
     size_t mem;
     uint32_t total_detectors = 0;
+    uint64_t total_calls = 0;
 
     if ( allocatedDetectorList.empty() )
         return;
@@ -762,10 +776,19 @@ void RNAPndDumpLuaStats()
         mem = lua_gc(detector->myLuaState, LUA_GCCOUNT, 0);
         totalMem += mem;
         total_detectors++;
-        LogMessage("\tDetector %s: Lua Memory usage %zu kb\n", detector->name.c_str(), mem);
+        uint64_t calls = detector->validate_calls;
+        hr_duration time(detector->validate_ticks);
+
+        total_calls += calls;
+        LogMessage("\tDetector %s: Lua Memory usage %zu kb, calls " STDu64 ", time %ld usecs\n",
+            detector->name.c_str(), mem, calls,
+            clock_usecs(duration_cast<microseconds>(time).count()));
     }
 
     LogMessage("Lua Stats total detectors: %u\n", total_detectors);
     LogMessage("Lua Stats total memory usage %zu kb\n", totalMem);
+    LogMessage("Lua Stats total validate calls " STDu64 "\n", total_calls);
+    LogMessage("Lua Stats detectors loaded from bytecode cache %u, from source %u\n",
+        gNumCachedLoads, gNumSourceLoads);
 }
 
@@ -131,7 +131,7 @@ static ServicePatternData* free_pattern_data;
 
 /*C service API */
 static void ServiceRegisterPattern(RNAServiceValidationFCN, IpProtocol, const uint8_t*, unsigned,
-        int, struct Detector*, int, const char*, ServiceConfig*);
+        int, struct Detector*, int, const char*, AppIdConfig*);
 static void CServiceRegisterPattern(RNAServiceValidationFCN, IpProtocol, const uint8_t* ,
         unsigned, int , const char*, AppIdConfig*);
 static void ServiceRegisterPatternUser(RNAServiceValidationFCN, IpProtocol, const uint8_t*,
@@ -286,14 +286,14 @@ static inline ServiceMatch* allocServiceMatch(void)
     return (ServiceMatch*)snort_calloc(sizeof(ServiceMatch));
 }
 
-static int pattern_match(void* id, void*, int index, void* data, void*)
+static void pattern_match(void* id, int index, void** data)
 {
     ServiceMatch** matches = (ServiceMatch**)data;
     ServicePatternData* pd = (ServicePatternData*)id;
     ServiceMatch* sm;
 
     if (pd->position >= 0 && pd->position != index)
-        return 0;
+        return;
 
     for (sm=*matches; sm; sm=sm->next)
         if (sm->svc == pd->svc)
@@ -309,7 +309,11 @@ static int pattern_match(void* id, void*, int index, void* data, void*)
         sm->next = *matches;
         *matches = sm;
     }
-    return 0;
+}
+
+static void free_pattern_matches(void* list)
+{
+    AppIdFreeServiceMatchList((ServiceMatch*)list);
 }
 
 AppId getPortServiceId(IpProtocol proto, uint16_t port, const AppIdConfig* pConfig)
@@ -461,9 +465,9 @@ const RNAServiceElement* ServiceGetServiceElement(RNAServiceValidationFCN fcn, s
 static void ServiceRegisterPattern(RNAServiceValidationFCN fcn,
     IpProtocol proto, const uint8_t* pattern, unsigned size,
     int position, struct Detector* userdata, int provides_user,
-    const char* name, ServiceConfig* pServiceConfig)
+    const char* name, AppIdConfig* pConfig)
 {
-    SearchTool** patterns;
+    ServiceConfig* pServiceConfig = &pConfig->serviceConfig;
     ServicePatternData** pd_list;
     int* count;
     ServicePatternData* pd;
@@ -472,7 +476,6 @@ static void ServiceRegisterPattern(RNAServiceValidationFCN fcn,
 
     if ((IpProtocol)proto == IpProtocol::TCP)
     {
-        patterns = &pServiceConfig->tcp_patterns;
         pd_list = &pServiceConfig->tcp_pattern_data;
 
         count = &pServiceConfig->tcp_pattern_count;
@@ -480,7 +483,6 @@ static void ServiceRegisterPattern(RNAServiceValidationFCN fcn,
     }
     else if ((IpProtocol)proto == IpProtocol::UDP)
     {
-        patterns = &pServiceConfig->udp_patterns;
         pd_list = &pServiceConfig->udp_pattern_data;
 
         count = &pServiceConfig->udp_pattern_count;
@@ -509,16 +511,6 @@ static void ServiceRegisterPattern(RNAServiceValidationFCN fcn,
         li->name = name;
     }
 
-    if (!(*patterns))
-    {
-        *patterns = new SearchTool("ac_full");
-        if (!(*patterns))
-        {
-            ErrorMessage("Error initializing the pattern table for protocol %u\n",(unsigned)proto);
-            return;
-        }
-    }
-
     if (free_pattern_data)
     {
         pd = free_pattern_data;
@@ -531,7 +523,7 @@ static void ServiceRegisterPattern(RNAServiceValidationFCN fcn,
     pd->svc = li;
     pd->size = size;
     pd->position = position;
-    (*patterns)->add(pattern, size, pd, false);
+    pConfig->patternMatcher.add(proto, APPID_PATTERN_SERVICE, pattern, size, false, pd);
     (*count)++;
     pd->next = *pd_list;
     *pd_list = pd;
@@ -543,14 +535,13 @@ void ServiceRegisterPatternDetector(RNAServiceValidationFCN fcn,
     int position, struct Detector* userdata, const char* name)
 {
     ServiceRegisterPattern(fcn, proto, pattern, size, position, userdata, 0, name,
-        &userdata->pAppidNewConfig->serviceConfig);
+        userdata->pAppidNewConfig);
 }
 
 static void ServiceRegisterPatternUser(RNAServiceValidationFCN fcn, IpProtocol proto,
     const uint8_t* pattern, unsigned size, int position, const char* name, AppIdConfig* pConfig)
 {
-    ServiceRegisterPattern(fcn, proto, pattern, size, position, nullptr, 1, name,
-        &pConfig->serviceConfig);
+    ServiceRegisterPattern(fcn, proto, pattern, size, position, nullptr, 1, name, pConfig);
 }
 
 static void CServiceRegisterPattern(RNAServiceValidationFCN fcn, IpProtocol proto,
@@ -558,8 +549,7 @@ static void CServiceRegisterPattern(RNAServiceValidationFCN fcn, IpProtocol prot
     int position, const char* name,
     AppIdConfig* pConfig)
 {
-    ServiceRegisterPattern(fcn, proto, pattern, size, position, nullptr, 0, name,
-        &pConfig->serviceConfig);
+    ServiceRegisterPattern(fcn, proto, pattern, size, position, nullptr, 0, name, pConfig);
 }
 
 static void RemoveServicePortsByType(RNAServiceValidationFCN validate, SF_LIST** services,
@@ -822,15 +812,14 @@ int ReloadServiceModules(AppIdConfig* pConfig)
 
 void ServiceInit(AppIdConfig*)
 {
+    AppIdPatternMatcher::set_handlers(APPID_PATTERN_SERVICE, pattern_match,
+        free_pattern_matches);
     luaModuleInitAllServices();
 }
 
 void ServiceFinalize(AppIdConfig* pConfig)
 {
-    if (pConfig->serviceConfig.tcp_patterns)
-        pConfig->serviceConfig.tcp_patterns->prep();
-    if (pConfig->serviceConfig.udp_patterns)
-        pConfig->serviceConfig.udp_patterns->prep();
+    pConfig->patternMatcher.prep();
 }
 
 void UnconfigureServices(AppIdConfig* pConfig)
@@ -841,11 +830,8 @@ void UnconfigureServices(AppIdConfig* pConfig)
 
     svc_clean_api.pAppidConfig = pConfig;
 
-    if (pConfig->serviceConfig.tcp_patterns)
-    {
-        delete pConfig->serviceConfig.tcp_patterns;
-        pConfig->serviceConfig.tcp_patterns = nullptr;
-    }
+    pConfig->patternMatcher.remove(APPID_PATTERN_SERVICE);
+
     // Do not free memory for the pattern; this can be later reclaimed when a
     // new pattern needs to be created. Memory for these patterns will be freed
     // on exit.
@@ -858,11 +844,6 @@ void UnconfigureServices(AppIdConfig* pConfig)
         pd->next = free_pattern_data;
         free_pattern_data = pd;
     }
-    if (pConfig->serviceConfig.udp_patterns)
-    {
-        delete pConfig->serviceConfig.udp_patterns;
-        pConfig->serviceConfig.udp_patterns = nullptr;
-    }
     while (pConfig->serviceConfig.udp_pattern_data)
     {
         pd = pConfig->serviceConfig.udp_pattern_data;
@@ -918,16 +899,8 @@ void CleanupServices(AppIdConfig* pConfig)
 
     svc_clean_api.pAppidConfig = pConfig;
 
-    if (pConfig->serviceConfig.tcp_patterns)
-    {
-        delete pConfig->serviceConfig.tcp_patterns;
-        pConfig->serviceConfig.tcp_patterns = nullptr;
-    }
-    if (pConfig->serviceConfig.udp_patterns)
-    {
-        delete pConfig->serviceConfig.udp_patterns;
-        pConfig->serviceConfig.udp_patterns = nullptr;
-    }
+    pConfig->patternMatcher.remove(APPID_PATTERN_SERVICE);
+
     while ((pattern=pConfig->serviceConfig.tcp_pattern_data))
     {
         pConfig->serviceConfig.tcp_pattern_data = pattern->next;
@@ -1013,31 +986,14 @@ static int AppIdPatternPrecedence(const void* a, const void* b)
  * this sensor.
 */
 static inline RNAServiceElement* AppIdGetServiceByPattern(const Packet* pkt, IpProtocol proto,
-    const int, AppIdServiceIDState* id_state, const ServiceConfig* pServiceConfig)
+    const int, AppIdServiceIDState* id_state, const AppIdConfig* pConfig)
 {
-    SearchTool* patterns = nullptr;
     ServiceMatch* match_list;
     ServiceMatch* sm;
     uint32_t count;
     uint32_t i;
     RNAServiceElement* service = nullptr;
 
-    if (proto == IpProtocol::TCP)
-        patterns = pServiceConfig->tcp_patterns;
-    else
-        patterns = pServiceConfig->udp_patterns;
-
-    if (!patterns)
-    {
-#ifdef SERVICE_DEBUG
-#if SERVICE_DEBUG_PORT
-        if (pkt->ptrs.dp == SERVICE_DEBUG_PORT || pkt->ptrs.sp == SERVICE_DEBUG_PORT)
-#endif
-        fprintf(SF_DEBUG_FILE, "Pattern bailing due to no patterns\n");
-#endif
-        return nullptr;
-    }
-
     if (!smOrderedList)
     {
         // FIXIT-M: - using calloc because this may be realloc'ed later, change to vector asap
@@ -1062,8 +1018,8 @@ static inline RNAServiceElement* AppIdGetServiceByPattern(const Packet* pkt, IpP
 #endif
 #endif
     /*FRE didn't search */
-    match_list = nullptr;
-    patterns->find_all((char*)pkt->data, pkt->dsize, &pattern_match, false, (void*)&match_list);
+    match_list = (ServiceMatch*)pConfig->patternMatcher.get_matches(pkt, proto,
+        APPID_PATTERN_SERVICE);
 
     count = 0;
     for (sm = match_list; sm; sm = sm->next)
@@ -2074,7 +2030,7 @@ static const RNAServiceElement* AppIdGetNexService(const Packet* p, const int di
                     (reverse_service = ( RNAServiceElement*)sflist_first(
                         pConfig->serviceConfig.udp_reversed_services[p->ptrs.sp], &iter)))
                     || (p->dsize && (reverse_service = AppIdGetServiceByPattern(p, proto,
-                        dir, nullptr, &pConfig->serviceConfig))) )
+                        dir, nullptr, pConfig))) )
                 {
                     id_state->svc = reverse_service;
                     return id_state->svc;
@@ -2088,8 +2044,7 @@ static const RNAServiceElement* AppIdGetNexService(const Packet* p, const int di
         {
             if (id_state->serviceList == nullptr)    /* no list yet (need to make one) */
             {
-                id_state->svc = AppIdGetServiceByPattern(p, proto, dir, id_state,
-                    &pConfig->serviceConfig);
+                id_state->svc = AppIdGetServiceByPattern(p, proto, dir, id_state, pConfig);
             }
             else    /* already have a pattern service list (just use it) */
             {
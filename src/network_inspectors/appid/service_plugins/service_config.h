@@ -98,10 +98,8 @@ struct ServiceConfig
     SF_LIST* udp_services[RNA_SERVICE_MAX_PORT];
     SF_LIST* udp_reversed_services[RNA_SERVICE_MAX_PORT];
 
-    SearchTool* tcp_patterns;
     ServicePatternData* tcp_pattern_data;
     int tcp_pattern_count;
-    SearchTool* udp_patterns;
     ServicePatternData* udp_pattern_data;
     int udp_pattern_count;
 };
@@ -72,7 +72,7 @@
 static THREAD_LOCAL Packet* g_tmp_pkt = NULL;
 static THREAD_LOCAL FILE* g_logfile = NULL;
 
-THREAD_LOCAL SimpleStats spstats;
+THREAD_LOCAL PsStats spstats;
 THREAD_LOCAL ProfileStats psPerfStats;
 
 /*
@@ -33,6 +33,8 @@
 */
 #include "ps_detect.h"
 #include "ps_inspect.h"
+#include "ps_module.h"
+#include "ps_table.h"
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -46,7 +48,6 @@
 #include "main/snort_config.h"
 #include "protocols/packet.h"
 #include "time/packet_time.h"
-#include "hash/sfxhash.h"
 #include "protocols/tcp.h"
 #include "protocols/udp.h"
 #include "protocols/icmp4.h"
@@ -55,13 +56,6 @@
 #include "sfip/sf_ip.h"
 #include "stream/stream.h"
 
-typedef struct s_PS_HASH_KEY
-{
-    int protocol;
-    sfip_t scanner;
-    sfip_t scanned;
-} PS_HASH_KEY;
-
 typedef struct s_PS_ALERT_CONF
 {
     short connection_count;
@@ -70,7 +64,7 @@ typedef struct s_PS_ALERT_CONF
     short u_port_count;
 } PS_ALERT_CONF;
 
-static THREAD_LOCAL SFXHASH* portscan_hash = NULL;
+static THREAD_LOCAL PsTable* portscan_table = nullptr;
 
 /*
 **  Scanning configurations.  This is where we configure what the thresholds
@@ -155,66 +149,19 @@ PortscanConfig::~PortscanConfig()
         ipset_free(watch_ip);
 }
 
-/*
-**  NAME
-**    ps_tracker_free::
-*/
-/**
-**  This function is passed into the hash algorithm, so that
-**  we only reuse nodes that aren't priority nodes.  We have to make
-**  sure that we only track so many priority nodes, otherwise we could
-**  have all priority nodes and not be able to allocate more.
-*/
-static int ps_tracker_free(void* key, void* data)
-{
-    PS_TRACKER* tracker;
-
-    if (!key || !data)
-        return 0;
-
-    tracker = (PS_TRACKER*)data;
-    if (!tracker->priority_node)
-        return 0;
-
-    /*
-    **  Cycle through the protos to see if it's past the time.
-    **  We only get here if we ARE a priority node.
-    */
-    if (tracker->proto.window >= packet_time())
-        return 1;
-
-    return 0;
-}
-
 void ps_cleanup()
 {
-    if (portscan_hash != NULL)
-    {
-        sfxhash_delete(portscan_hash);
-        portscan_hash = NULL;
-    }
+    delete portscan_table;
+    portscan_table = nullptr;
 }
 
 void ps_init_hash(unsigned long memcap)
 {
-    if ( portscan_hash )
+    if ( portscan_table )
         return;
 
-    int rows = 0;
-    int factor = 0;
-#if SIZEOF_LONG_INT == 8
-    factor = 125;
-#else
-    factor = 250;
-#endif
-
-    rows = memcap/factor;
-
-    portscan_hash = sfxhash_new(rows, sizeof(PS_HASH_KEY), sizeof(PS_TRACKER),
-        memcap, 1, ps_tracker_free, NULL, 1);
-
-    if (portscan_hash == NULL)
-        FatalError("Failed to initialize portscan hash table.\n");
+    portscan_table = new PsTable(memcap);
+    spstats.memory += portscan_table->get_memory();
 }
 
 /*
@@ -226,8 +173,8 @@ void ps_init_hash(unsigned long memcap)
 */
 void ps_reset()
 {
-    if (portscan_hash != NULL)
-        sfxhash_make_empty(portscan_hash);
+    if ( portscan_table )
+        portscan_table->clear();
 }
 
 /*
@@ -375,21 +322,6 @@ int PortScan::ps_filter_ignore(PS_PKT* ps_pkt)
     return 0;
 }
 
-/*
-**  NAME
-**    ps_tracker_init::
-*/
-/**
-**  Right now all we do is memset, but just in case we want to do more
-**  initialization has been extracted.
-*/
-static int ps_tracker_init(PS_TRACKER* tracker)
-{
-    memset(tracker, 0x00, sizeof(PS_TRACKER));
-
-    return 0;
-}
-
 /*
 **  NAME
 **    ps_tracker_get::
@@ -400,25 +332,10 @@ static int ps_tracker_init(PS_TRACKER* tracker)
 */
 static int ps_tracker_get(PS_TRACKER** ht, PS_HASH_KEY* key)
 {
-    int iRet;
+    *ht = portscan_table->get(*key);
 
-    *ht = (PS_TRACKER*)sfxhash_find(portscan_hash, (void*)key);
-    if (!(*ht))
-    {
-        iRet = sfxhash_add(portscan_hash, (void*)key, NULL);
-        if (iRet == SFXHASH_OK)
-        {
-            *ht = (PS_TRACKER*)sfxhash_mru(portscan_hash);
-            if (!(*ht))
-                return -1;
-
-            ps_tracker_init(*ht);
-        }
-        else
-        {
-            return -1;
-        }
-    }
+    if ( !*ht )
+        return -1;
 
     return 0;
 }
@@ -1624,6 +1541,10 @@ int PortScan::ps_detect(PS_PKT* ps_pkt)
 
     p = (Packet*)ps_pkt->pkt;
 
+    // expire and evict before any lookups so trackers stay put for
+    // the rest of this packet
+    portscan_table->begin(packet_time());
+
     do
     {
         if (ps_tracker_lookup(ps_pkt, &scanner, &scanned))
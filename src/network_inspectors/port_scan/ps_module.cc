@@ -209,6 +209,17 @@ static const Parameter psg_params[] =
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+static const PegInfo ps_pegs[] =
+{
+    { "packets", "total packets" },
+    { "trackers", "trackers allocated" },
+    { "expired", "trackers released when their window elapsed" },
+    { "evicted", "trackers released to make room for new ones" },
+    { "alloc fails", "tracker lookups that failed because the table was full" },
+    { "memory", "bytes allocated for tracker tables" },
+    { nullptr, nullptr }
+};
+
 PortScanGlobalModule::PortScanGlobalModule() :
     Module(PSG_NAME, PSG_HELP, psg_params)
 {
@@ -250,7 +261,7 @@ PsCommon* PortScanGlobalModule::get_data()
 }
 
 const PegInfo* PortScanGlobalModule::get_pegs() const
-{ return simple_pegs; }
+{ return ps_pegs; }
 
 PegCount* PortScanGlobalModule::get_counts() const
 { return (PegCount*)&spstats; }
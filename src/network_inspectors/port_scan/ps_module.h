@@ -31,7 +31,17 @@
 #define PSG_NAME "port_scan_global"
 #define PSG_HELP "shared settings for port_scan inspectors for use with port_scan"
 
-extern THREAD_LOCAL SimpleStats spstats;
+struct PsStats
+{
+    PegCount total_packets;
+    PegCount trackers;
+    PegCount expired;
+    PegCount evicted;
+    PegCount alloc_fails;
+    PegCount memory;
+};
+
+extern THREAD_LOCAL PsStats spstats;
 extern THREAD_LOCAL ProfileStats psPerfStats;
 
 //-------------------------------------------------------------------------
@@ -0,0 +1,348 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// ps_table.cc
+
+#include "ps_table.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "ps_module.h"
+#include "utils/util.h"
+
+//-------------------------------------------------------------------------
+// the wheel has 2 levels of 64 buckets.  level 0 has 1 second resolution
+// and level 1 has 64 second resolution so it covers a bit over an hour,
+// which is more than the longest (high sense) window.  each entry is on
+// exactly one bucket list, linked by slot index.  when a bucket comes due
+// its trackers are either refiled to their current window or released.
+//-------------------------------------------------------------------------
+
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_SPAN (WHEEL_SIZE * WHEEL_SIZE)
+
+#define NIL 0xFFFFFFFF
+#define MIN_SLOTS 64
+
+// a packet looks up at most 2 trackers per direction
+#define RESERVE 4
+
+struct PsEntry
+{
+    PS_HASH_KEY key;
+    time_t expire;
+    uint32_t prev;
+    uint32_t next;
+    uint32_t bucket;
+    PS_TRACKER tracker;
+};
+
+static inline uint32_t ps_hash(const PS_HASH_KEY& key)
+{
+    static_assert(sizeof(key) % 4 == 0, "key is hashed by word");
+    const uint8_t* k = (const uint8_t*)&key;
+    uint64_t h = 0;
+
+    for ( unsigned i = 0; i < sizeof(key); i += 4 )
+    {
+        uint32_t w;
+        memcpy(&w, k + i, 4);
+        h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+    }
+    uint32_t hv = (uint32_t)(h ^ (h >> 32));
+    return hv ? hv : 1;
+}
+
+//-------------------------------------------------------------------------
+// table
+//-------------------------------------------------------------------------
+
+PsTable::PsTable(unsigned long memcap)
+{
+    const size_t slot_size = sizeof(PsEntry) + sizeof(*hashes);
+    uint32_t slots = MIN_SLOTS;
+
+    while ( (size_t)slots * 2 * slot_size <= memcap and slots < 0x40000000 )
+        slots *= 2;
+
+    mask = slots - 1;
+    max_count = slots - (slots >> 2);  // 75% load factor
+    count = 0;
+    clock = 0;
+
+    entries = (PsEntry*)snort_calloc(slots, sizeof(*entries));
+    hashes = (uint32_t*)snort_calloc(slots, sizeof(*hashes));
+    wheel = (uint32_t*)snort_calloc(2 * WHEEL_SIZE, sizeof(*wheel));
+
+    for ( unsigned i = 0; i < 2 * WHEEL_SIZE; ++i )
+        wheel[i] = NIL;
+}
+
+PsTable::~PsTable()
+{
+    snort_free(entries);
+    snort_free(hashes);
+    snort_free(wheel);
+}
+
+size_t PsTable::get_memory() const
+{
+    return (size_t)(mask + 1) * (sizeof(*entries) + sizeof(*hashes)) +
+        2 * WHEEL_SIZE * sizeof(*wheel);
+}
+
+void PsTable::clear()
+{
+    memset(hashes, 0, (size_t)(mask + 1) * sizeof(*hashes));
+
+    for ( unsigned i = 0; i < 2 * WHEEL_SIZE; ++i )
+        wheel[i] = NIL;
+
+    count = 0;
+    clock = 0;
+}
+
+PS_TRACKER* PsTable::get(const PS_HASH_KEY& key)
+{
+    uint32_t hv = ps_hash(key);
+    uint32_t i = hv & mask;
+
+    while ( hashes[i] )
+    {
+        if ( hashes[i] == hv and !memcmp(&entries[i].key, &key, sizeof(key)) )
+            return &entries[i].tracker;
+
+        i = (i + 1) & mask;
+    }
+
+    if ( count >= max_count )
+    {
+        ++spstats.alloc_fails;
+        return nullptr;
+    }
+
+    PsEntry& e = entries[i];
+    hashes[i] = hv;
+    e.key = key;
+    memset(&e.tracker, 0, sizeof(e.tracker));
+
+    // new trackers are revisited on the next tick; by then the window has
+    // been set if the tracker was updated, and the entry is refiled to it
+    e.expire = clock + 1;
+    link(i);
+
+    ++count;
+    ++spstats.trackers;
+
+    return &e.tracker;
+}
+
+// backward shift deletion keeps probe sequences intact without tombstones
+void PsTable::remove(uint32_t i)
+{
+    unlink(i);
+    --count;
+
+    uint32_t j = i;
+
+    while ( true )
+    {
+        j = (j + 1) & mask;
+
+        if ( !hashes[j] )
+            break;
+
+        uint32_t k = hashes[j] & mask;
+
+        // skip entries whose home slot is cyclically in (i, j]
+        if ( i <= j ? (i < k and k <= j) : (i < k or k <= j) )
+            continue;
+
+        move(j, i);
+        i = j;
+    }
+    hashes[i] = 0;
+}
+
+void PsTable::move(uint32_t from, uint32_t to)
+{
+    PsEntry& e = entries[to];
+    e = entries[from];
+    hashes[to] = hashes[from];
+
+    if ( e.prev != NIL )
+        entries[e.prev].next = to;
+    else
+        wheel[e.bucket] = to;
+
+    if ( e.next != NIL )
+        entries[e.next].prev = to;
+}
+
+//-------------------------------------------------------------------------
+// wheel
+//-------------------------------------------------------------------------
+
+void PsTable::link(uint32_t i)
+{
+    PsEntry& e = entries[i];
+
+    // only cascade() can file an entry due now; it lands in the level 0
+    // bucket that is expired next in the same tick
+    if ( e.expire < clock )
+        e.expire = clock;
+
+    time_t delta = e.expire - clock;
+
+    if ( delta < WHEEL_SIZE )
+        e.bucket = e.expire & WHEEL_MASK;
+
+    else if ( delta < WHEEL_SPAN )
+        e.bucket = WHEEL_SIZE + ((e.expire >> WHEEL_BITS) & WHEEL_MASK);
+
+    else
+        e.bucket = WHEEL_SIZE + (((clock >> WHEEL_BITS) + WHEEL_MASK) & WHEEL_MASK);
+
+    e.prev = NIL;
+    e.next = wheel[e.bucket];
+
+    if ( e.next != NIL )
+        entries[e.next].prev = i;
+
+    wheel[e.bucket] = i;
+}
+
+void PsTable::unlink(uint32_t i)
+{
+    PsEntry& e = entries[i];
+
+    if ( e.prev != NIL )
+        entries[e.prev].next = e.next;
+    else
+        wheel[e.bucket] = e.next;
+
+    if ( e.next != NIL )
+        entries[e.next].prev = e.prev;
+}
+
+void PsTable::begin(time_t now)
+{
+    if ( !clock )
+        clock = now;
+
+    // after a long gap every level 1 bucket is visited once which
+    // refiles or releases everything
+    if ( now - clock > WHEEL_SPAN )
+        clock = now - WHEEL_SPAN;
+
+    while ( clock < now )
+    {
+        ++clock;
+
+        if ( !(clock & WHEEL_MASK) )
+            cascade(WHEEL_SIZE + ((clock >> WHEEL_BITS) & WHEEL_MASK));
+
+        expire(clock & WHEEL_MASK);
+    }
+
+    while ( count + RESERVE > max_count )
+    {
+        if ( !evict() )
+            break;
+    }
+}
+
+void PsTable::cascade(unsigned bucket)
+{
+    // nothing is removed here so the list can be detached and walked
+    uint32_t i = wheel[bucket];
+    wheel[bucket] = NIL;
+
+    while ( i != NIL )
+    {
+        uint32_t next = entries[i].next;
+        link(i);
+        i = next;
+    }
+}
+
+// trackers are reset once the packet time passes the window so there
+// is nothing to keep; priority nodes get the same treatment since they
+// are only protected while inside their window
+void PsTable::expire(unsigned bucket)
+{
+    uint32_t i;
+
+    // refiled entries always land in a later bucket.  removal may shift
+    // entries between slots so the list is consumed from the head.
+    while ( (i = wheel[bucket]) != NIL )
+    {
+        PsEntry& e = entries[i];
+
+        if ( e.tracker.proto.window >= clock )
+        {
+            unlink(i);
+            e.expire = e.tracker.proto.window + 1;
+            link(i);
+        }
+        else
+        {
+            remove(i);
+            ++spstats.expired;
+        }
+    }
+}
+
+// release the tracker that is next due, skipping priority nodes still
+// inside their window.  this replaces lru recycling.
+bool PsTable::evict()
+{
+    const unsigned max_tries = 16;
+    unsigned tries = 0;
+
+    for ( unsigned n = 1; n <= 2 * WHEEL_SIZE; ++n )
+    {
+        unsigned bucket;
+
+        if ( n <= WHEEL_SIZE )
+            bucket = (clock + n) & WHEEL_MASK;
+        else
+            bucket = WHEEL_SIZE + (((clock >> WHEEL_BITS) + n) & WHEEL_MASK);
+
+        for ( uint32_t i = wheel[bucket]; i != NIL; i = entries[i].next )
+        {
+            const PS_TRACKER& t = entries[i].tracker;
+
+            if ( !t.priority_node or t.proto.window < clock )
+            {
+                remove(i);
+                ++spstats.evicted;
+                return true;
+            }
+            if ( ++tries >= max_tries )
+                return false;
+        }
+    }
+    return false;
+}
+
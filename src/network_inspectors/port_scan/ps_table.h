@@ -0,0 +1,92 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// ps_table.h
+
+#ifndef PS_TABLE_H
+#define PS_TABLE_H
+
+// PsTable is a fixed capacity, open addressed tracker table.  it replaces
+// the generic hash for port scan so that lookups touch a single array and
+// expiry is done in bulk with a 2 level time wheel instead of walking an
+// lru list.  the table size is derived from the configured memcap and
+// never grows.
+
+#include <stdint.h>
+#include <time.h>
+
+#include "ps_detect.h"
+
+struct PS_HASH_KEY
+{
+    int protocol;
+    sfip_t scanner;
+    sfip_t scanned;
+};
+
+struct PsEntry;
+
+class PsTable
+{
+public:
+    PsTable(unsigned long memcap);
+    ~PsTable();
+
+    // advance the wheel and make room for the trackers of the next
+    // packet.  this is the only call that releases entries so tracker
+    // pointers stay valid until the next packet.
+    void begin(time_t now);
+
+    // find or add the tracker for key; returns nullptr if the table is
+    // full and nothing could be evicted.
+    PS_TRACKER* get(const PS_HASH_KEY&);
+
+    void clear();
+
+    unsigned get_count() const
+    { return count; }
+
+    unsigned get_max() const
+    { return max_count; }
+
+    size_t get_memory() const;
+
+private:
+    void cascade(unsigned bucket);
+    void expire(unsigned bucket);
+
+    void link(uint32_t);
+    void unlink(uint32_t);
+    void move(uint32_t from, uint32_t to);
+
+    void remove(uint32_t);
+    bool evict();
+
+private:
+    PsEntry* entries;
+    uint32_t* hashes;    // 0 means the slot is free
+    uint32_t mask;
+
+    unsigned count;
+    unsigned max_count;
+
+    time_t clock;        // last second processed by the wheel
+    uint32_t* wheel;     // list heads, 2 levels
+};
+
+#endif
+
@@ -0,0 +1,238 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// ps_table_test.cc
+// unit test main
+
+#include "network_inspectors/port_scan/ps_table.cc"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+THREAD_LOCAL PsStats spstats;
+
+// a table with the minimum of 64 slots holds up to 48 trackers
+static const unsigned SLOTS = 64;
+static const unsigned MAX = 48;
+
+static const time_t T0 = 1000000 * WHEEL_SIZE;
+
+static PS_HASH_KEY make_key(int n)
+{
+    PS_HASH_KEY key;
+    memset(&key, 0, sizeof(key));
+    key.protocol = n;
+    return key;
+}
+
+static unsigned home(const PS_HASH_KEY& key)
+{ return ps_hash(key) & (SLOTS - 1); }
+
+// returns the next key after n with the given home slot
+static int next_key(int n, unsigned slot)
+{
+    while ( home(make_key(++n)) != slot );
+    return n;
+}
+
+static PS_TRACKER* add(PsTable& table, int n, time_t window, int mark)
+{
+    PS_TRACKER* t = table.get(make_key(n));
+    CHECK(t != nullptr);
+    t->proto.window = window;
+    t->proto.connection_count = mark;
+    return t;
+}
+
+// get the tracker and make sure it was already there
+static void check_found(PsTable& table, int n, int mark)
+{
+    unsigned count = table.get_count();
+    PS_TRACKER* t = table.get(make_key(n));
+    CHECK(t != nullptr);
+    CHECK(t->proto.connection_count == mark);
+    CHECK(table.get_count() == count);
+}
+
+TEST_GROUP(ps_table)
+{
+    void setup()
+    {
+        memset(&spstats, 0, sizeof(spstats));
+    }
+};
+
+TEST(ps_table, size)
+{
+    PsTable table(0);
+    CHECK(table.get_max() == MAX);
+    CHECK(table.get_count() == 0);
+}
+
+// a and b live at the end of the table, c and d probe past it to the
+// start.  removing a shifts the others back across the wrap.
+TEST(ps_table, wraparound_delete)
+{
+    PsTable table(0);
+    table.begin(T0);
+
+    int a = next_key(0, SLOTS - 1);
+    int b = next_key(a, SLOTS - 1);
+    int c = next_key(b, SLOTS - 1);
+    int d = next_key(0, 0);
+
+    add(table, a, T0, 1);       // slot 63
+    add(table, b, T0 + 100, 2); // slot 0
+    add(table, c, T0 + 100, 3); // slot 1
+    add(table, d, T0 + 100, 4); // slot 2, home 0
+
+    CHECK(table.get_count() == 4);
+    check_found(table, a, 1);
+    check_found(table, d, 4);
+
+    table.begin(T0 + 1);
+    CHECK(table.get_count() == 3);
+    CHECK(spstats.expired == 1);
+
+    check_found(table, b, 2);
+    check_found(table, c, 3);
+    check_found(table, d, 4);
+
+    // a is gone so it comes back fresh
+    PS_TRACKER* t = table.get(make_key(a));
+    CHECK(t != nullptr);
+    CHECK(t->proto.connection_count == 0);
+    CHECK(table.get_count() == 4);
+}
+
+// removing a middle entry of a wrapped run must not strand the tail
+TEST(ps_table, wraparound_delete_middle)
+{
+    PsTable table(0);
+    table.begin(T0);
+
+    int a = next_key(0, SLOTS - 2);
+    int b = next_key(0, SLOTS - 1);
+    int c = next_key(a, SLOTS - 2);
+    int d = next_key(0, 1);
+
+    add(table, a, T0 + 100, 1); // slot 62
+    add(table, b, T0, 2);       // slot 63
+    add(table, c, T0 + 100, 3); // slot 0, home 62
+    add(table, d, T0 + 100, 4); // slot 1, home 1
+
+    table.begin(T0 + 1);
+    CHECK(table.get_count() == 3);
+
+    check_found(table, a, 1);
+    check_found(table, c, 3);
+    check_found(table, d, 4);
+}
+
+// windows just either side of the level 0 / level 1 boundary and of the
+// span of the wheel, starting on and just before a level 1 tick
+TEST(ps_table, expiry_boundaries)
+{
+    const time_t windows[] =
+    { 1, 62, 63, 64, 65, 4094, 4095, 4096, 4097, 5000 };
+
+    const time_t starts[] = { T0, T0 + WHEEL_SIZE - 1 };
+
+    for ( auto start : starts )
+    {
+        for ( auto w : windows )
+        {
+            PsTable table(0);
+            table.begin(start);
+            add(table, 1, start + w, 1);
+
+            // refiled to the window on the first tick
+            table.begin(start + 1);
+            CHECK(table.get_count() == 1);
+
+            table.begin(start + w);
+            CHECK(table.get_count() == 1);
+            check_found(table, 1, 1);
+
+            table.begin(start + w + 1);
+            CHECK(table.get_count() == 0);
+        }
+    }
+}
+
+// the same boundaries when time advances a second at a time
+TEST(ps_table, expiry_stepped)
+{
+    const time_t windows[] = { 63, 64, 127, 128, 4095, 4096, 4097 };
+
+    for ( auto w : windows )
+    {
+        PsTable table(0);
+        table.begin(T0);
+        add(table, 1, T0 + w, 1);
+
+        for ( time_t now = T0 + 1; now <= T0 + w; ++now )
+            table.begin(now);
+
+        CHECK(table.get_count() == 1);
+
+        table.begin(T0 + w + 1);
+        CHECK(table.get_count() == 0);
+    }
+}
+
+// a full table evicts the trackers due soonest, skipping priority nodes
+// still inside their window
+TEST(ps_table, eviction_order)
+{
+    PsTable table(0);
+    table.begin(T0);
+
+    for ( unsigned i = 0; i < MAX; ++i )
+        add(table, i + 1, T0 + 10 + i, i + 1);
+
+    CHECK(table.get_count() == MAX);
+    CHECK(table.get(make_key(MAX + 1)) == nullptr);
+    CHECK(spstats.alloc_fails == 1);
+
+    // the second is protected
+    table.get(make_key(2))->priority_node = 1;
+
+    table.begin(T0 + 1);
+    CHECK(table.get_count() == MAX - RESERVE);
+    CHECK(spstats.evicted == RESERVE);
+    CHECK(spstats.expired == 0);
+
+    check_found(table, 2, 2);
+
+    for ( unsigned i = RESERVE + 2; i <= MAX; ++i )
+        check_found(table, i, i);
+
+    for ( int n : { 1, 3, 4, 5 } )
+    {
+        PS_TRACKER* t = table.get(make_key(n));
+        CHECK(t != nullptr);
+        CHECK(t->proto.connection_count == 0);
+    }
+    CHECK(table.get_count() == MAX);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -20,6 +20,8 @@
 #ifndef REPUTATION_CONFIG_H
 #define REPUTATION_CONFIG_H
 
+#include <memory>
+
 #include "main/snort_types.h"
 #include "sfrt/sfrt_flat.h"
 #include "main/snort_debug.h"
@@ -60,6 +62,16 @@ struct ListInfo
     uint32_t listId;
 };
 
+class ReputationImage;
+struct poptrie_table_t;
+
+// what the packet threads look up, built from the lists or an image
+struct ReputationTable
+{
+    table_flat_t* iplist = nullptr;
+    poptrie_table_t* poptrie = nullptr;
+};
+
 struct ReputationConfig
 {
     uint32_t memcap = 500;
@@ -73,10 +85,18 @@ struct ReputationConfig
     uint8_t* reputation_segment = nullptr;
     char* blacklist_path = nullptr;
     char* whitelist_path = nullptr;
+    char* image_path = nullptr;
     bool memCapReached = false;
+    bool poptrie = false;
+    uint32_t segment_size = 0;
     table_flat_t* iplist = nullptr;
     ListInfo* listInfo = nullptr;
 
+    ReputationTable table;
+
+    // set when iplist was loaded from image_path instead of the lists
+    std::shared_ptr<ReputationImage> image;
+
     ~ReputationConfig();
 };
 
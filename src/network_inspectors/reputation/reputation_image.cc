@@ -0,0 +1,237 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reputation_image.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "reputation_image.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "log/messages.h"
+#include "sfrt/sfrt_poptrie.h"
+#include "utils/segment_mem.h"
+
+#include "reputation_module.h"
+#include "reputation_parse.h"
+
+static_assert(sizeof(ReputationImageHeader) == 80, "reputation image header must be 80 bytes");
+
+ReputationImage::~ReputationImage()
+{
+    sfrt_poptrie_free(table.poptrie);
+
+    if ( map )
+        munmap(map, map_size);
+}
+
+// fnv-1a of the full path so that an image built from other lists isn't
+// taken as current just because it is newer
+static uint64_t list_hash(char* list)
+{
+    if ( !list )
+        return 0;
+
+    char full_path[PATH_MAX+1];
+    UpdatePathToFile(full_path, PATH_MAX, list);
+
+    uint64_t h = 0xcbf29ce484222325ull;
+
+    for ( const char* s = full_path; *s; ++s )
+    {
+        h ^= (uint8_t)*s;
+        h *= 0x100000001b3ull;
+    }
+    return h ? h : 1;
+}
+
+static bool valid_offset(MEM_OFFSET off, uint64_t size)
+{ return off < size; }
+
+ReputationImage* ReputationImage::load(const char* path, WhiteAction wa, bool poptrie)
+{
+    int fd = open(path, O_RDONLY);
+
+    if ( fd < 0 )
+        return nullptr;
+
+    struct stat st;
+
+    if ( fstat(fd, &st) or (size_t)st.st_size < sizeof(ReputationImageHeader) )
+    {
+        WarningMessage("reputation image %s is truncated\n", path);
+        close(fd);
+        return nullptr;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ( map == MAP_FAILED )
+    {
+        WarningMessage("can't map reputation image %s: %s\n", path, strerror(errno));
+        return nullptr;
+    }
+
+    ReputationImage* ri = new ReputationImage;
+    ri->map = map;
+    ri->map_size = st.st_size;
+
+    const ReputationImageHeader* h = (ReputationImageHeader*)map;
+    const char* why = nullptr;
+
+    if ( memcmp(h->magic, REPUTATION_IMAGE_MAGIC, sizeof(h->magic)) )
+        why = "not a reputation image";
+
+    else if ( h->version != REPUTATION_IMAGE_VERSION or h->header_size != sizeof(*h) )
+        why = "unsupported version";
+
+    else if ( h->segment_size != (uint64_t)st.st_size - h->header_size or
+        h->segment_size < sizeof(table_flat_t) )
+        why = "size mismatch";
+
+    else if ( h->white_action != wa )
+        why = "built with a different white action";
+
+    if ( !why )
+    {
+        table_flat_t* t = (table_flat_t*)((uint8_t*)map + h->header_size);
+
+        if ( !valid_offset(t->data, h->segment_size) or !valid_offset(t->rt, h->segment_size) or
+            !valid_offset(t->rt6, h->segment_size) or !valid_offset(t->list_info, h->segment_size) )
+            why = "corrupt table";
+        else
+        {
+            ri->header = h;
+            ri->table.iplist = t;
+
+            if ( poptrie )
+                ri->table.poptrie = sfrt_poptrie_new(t);
+
+            return ri;
+        }
+    }
+
+    WarningMessage("ignoring reputation image %s: %s\n", path, why);
+    delete ri;
+    return nullptr;
+}
+
+bool ReputationImage::save(const char* path, const ReputationConfig* config)
+{
+    // the table must be the first thing in the segment so that lookups
+    // relative to the table also work relative to the mapped segment
+    if ( !config->iplist or (uint8_t*)config->iplist != config->reputation_segment )
+        return false;
+
+    ReputationImageHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, REPUTATION_IMAGE_MAGIC, sizeof(h.magic));
+
+    h.version = REPUTATION_IMAGE_VERSION;
+    h.header_size = sizeof(h);
+    h.segment_size = config->segment_size - segment_unusedmem();
+    h.build_time = time(nullptr);
+
+    h.entries = sfrt_flat_num_entries(config->iplist);
+    h.invalid = total_invalids;
+    h.duplicates = total_duplicates;
+    h.memory = sfrt_flat_usage(config->iplist);
+
+    h.blacklist = list_hash(config->blacklist_path);
+    h.whitelist = list_hash(config->whitelist_path);
+
+    h.memcap = config->memcap;
+    h.white_action = config->whiteAction;
+
+    std::string tmp = std::string(path) + "." + std::to_string(getpid()) + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if ( fd < 0 )
+    {
+        WarningMessage("can't write reputation image %s\n", tmp.c_str());
+        return false;
+    }
+
+    bool ok = write(fd, &h, sizeof(h)) == (ssize_t)sizeof(h) and
+        write(fd, config->reputation_segment, h.segment_size) == (ssize_t)h.segment_size;
+
+    close(fd);
+
+    // rename so that a concurrent load or swap never sees a partial image
+    if ( !ok or rename(tmp.c_str(), path) )
+    {
+        WarningMessage("can't write reputation image %s\n", path);
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool newer(const struct stat& img, char* list)
+{
+    if ( !list )
+        return true;
+
+    char full_path[PATH_MAX+1];
+    UpdatePathToFile(full_path, PATH_MAX, list);
+
+    struct stat st;
+
+    if ( stat(full_path, &st) )
+        return true;
+
+    return img.st_mtime >= st.st_mtime;
+}
+
+bool ReputationImage::is_current(const char* path, const ReputationConfig* config)
+{
+    int fd = open(path, O_RDONLY);
+
+    if ( fd < 0 )
+        return false;
+
+    struct stat st;
+    ReputationImageHeader h;
+
+    bool ok = !fstat(fd, &st) and read(fd, &h, sizeof(h)) == (ssize_t)sizeof(h);
+    close(fd);
+
+    if ( !ok or memcmp(h.magic, REPUTATION_IMAGE_MAGIC, sizeof(h.magic)) or
+        h.version != REPUTATION_IMAGE_VERSION or h.header_size != sizeof(h) )
+        return false;
+
+    if ( h.blacklist != list_hash(config->blacklist_path) or
+        h.whitelist != list_hash(config->whitelist_path) or
+        h.memcap != config->memcap or h.white_action != config->whiteAction )
+        return false;
+
+    return newer(st, config->blacklist_path) and newer(st, config->whitelist_path);
+}
+
@@ -0,0 +1,92 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reputation_image.h
+
+#ifndef REPUTATION_IMAGE_H
+#define REPUTATION_IMAGE_H
+
+// A reputation image is the flat sfrt segment built from the ip lists
+// written to a file with a header recording how it was built.  Since the
+// segment only contains offsets relative to the table, the file can be
+// mapped read only at any address and shared by all packet threads.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "reputation_config.h"
+
+#define REPUTATION_IMAGE_MAGIC "SNREPIMG"
+#define REPUTATION_IMAGE_VERSION 2
+
+struct ReputationImageHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+
+    uint64_t segment_size;  // bytes of segment following the header
+    uint64_t build_time;    // seconds since the epoch
+
+    uint32_t entries;
+    uint32_t invalid;
+    uint32_t duplicates;
+    uint32_t memory;        // as sfrt_flat_usage()
+
+    uint64_t blacklist;     // hash of the full list paths or 0 if none
+    uint64_t whitelist;
+
+    uint32_t memcap;
+    uint8_t white_action;
+    uint8_t reserved[11];
+};
+
+class ReputationImage
+{
+public:
+    ~ReputationImage();
+
+    // main thread: returns nullptr and logs the reason if the image can't be
+    // used with the given white action; builds a poptrie for the table if
+    // requested
+    static ReputationImage* load(const char* path, WhiteAction, bool poptrie);
+
+    // main thread: write the segment built by the parser for config
+    static bool save(const char* path, const ReputationConfig*);
+
+    // true if path was built from the configured list files, memcap, and
+    // white action and is newer than the list files
+    static bool is_current(const char* path, const ReputationConfig*);
+
+    const ReputationTable& get_table() const
+    { return table; }
+
+    const ReputationImageHeader* get_header() const
+    { return header; }
+
+private:
+    ReputationImage() = default;
+
+    void* map = nullptr;
+    size_t map_size = 0;
+
+    const ReputationImageHeader* header = nullptr;
+    ReputationTable table;
+};
+
+#endif
+
@@ -21,8 +21,10 @@
 
 #include "reputation_inspect.h"
 
+#include "reputation_image.h"
 #include "reputation_module.h"
 #include "reputation_parse.h"
+#include "sfrt/sfrt_poptrie.h"
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -33,11 +35,21 @@
 #include <stdio.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 #include "protocols/packet.h"
 #include "sfip/sf_ip.h"
 #include "events/event_queue.h"
 #include "main/snort_types.h"
+#include "main/snort_config.h"
 #include "main/snort_debug.h"
+#include "main/policy.h"
+#include "main/thread.h"
+#include "main/thread_config.h"
+#include "managers/inspector_manager.h"
 #include "profiler/profiler.h"
 #include "file_api/file_api.h"
 #include "parser/parser.h"
@@ -79,7 +91,20 @@ const char* WhiteActionOption[] =
 /*
  * Function prototype(s)
  */
-static void snort_reputation(ReputationConfig* GlobalConf, Packet* p);
+static void snort_reputation(ReputationConfig*, const ReputationTable&, Packet*);
+
+static void LogImageStats(const ReputationImageHeader* h)
+{
+    time_t t = (time_t)h->build_time;
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&t));
+
+    LogMessage("    Reputation image built: %s\n", buf);
+    LogMessage("    Reputation image size: " STDu64 " bytes\n", h->segment_size);
+    LogMessage("    Reputation total memory usage: %u bytes\n", h->memory);
+    LogMessage("    Reputation total entries loaded: %u, invalid: %u, re-defined: %u\n",
+        h->entries, h->invalid, h->duplicates);
+}
 
 unsigned ReputationFlowData::flow_id = 0;
 
@@ -128,6 +153,14 @@ static void DisableReputation(Flow* flow)
 
 static void PrintIPlistStats(ReputationConfig* config)
 {
+    if ( config->image )
+    {
+        LogMessage("    Reputation image: %s\n", config->image_path);
+        LogImageStats(config->image->get_header());
+        config->numEntries = config->image->get_header()->entries;
+        return;
+    }
+
     /*Print out the summary*/
     LogMessage("    Reputation total memory usage: " STDu64 " bytes\n",
         reputationstats.memory_allocated);
@@ -165,35 +198,59 @@ static void PrintReputationConf(ReputationConfig* config)
     LogMessage("\n");
 }
 
-static inline IPrepInfo* ReputationLookup(ReputationConfig* config, const sfip_t* ip)
+static inline bool ReputationSkip(ReputationConfig* config, const sfip_t* ip)
 {
-    IPrepInfo* result;
-
     DEBUG_WRAP(DebugFormat(DEBUG_REPUTATION, "Lookup address: %s \n",sfip_to_str(ip) ); );
     if (!config->scanlocal)
     {
         if (sfip_is_private(ip) )
         {
             DEBUG_WRAP(DebugMessage(DEBUG_REPUTATION, "Private address\n"); );
-            return nullptr;
+            return true;
         }
     }
+    return false;
+}
+
+static inline void ReputationLookup(ReputationConfig* config, const ReputationTable& table,
+    const sfip_t** ips, IPrepInfo** results, unsigned n)
+{
+    if ( !table.poptrie )
+    {
+        for ( unsigned i = 0; i < n; ++i )
+            results[i] = ReputationSkip(config, ips[i]) ? nullptr :
+                (IPrepInfo*)sfrt_flat_dir8x_lookup((void*)ips[i], table.iplist);
+        return;
+    }
+
+    const sfip_t* batch[2];
+    GENERIC found[2];
+    unsigned m = 0;
 
-    result = (IPrepInfo*)sfrt_flat_dir8x_lookup((void*)ip, config->iplist);
+    assert(n <= 2);
 
-    return (result);
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        if ( !ReputationSkip(config, ips[i]) )
+            batch[m++] = ips[i];
+    }
+
+    sfrt_poptrie_lookup_batch(batch, found, m, table.poptrie);
+
+    for ( unsigned i = 0, j = 0; i < n; ++i )
+        results[i] = (j < m and batch[j] == ips[i]) ? (IPrepInfo*)found[j++] : nullptr;
 }
 
-static inline IPdecision GetReputation(ReputationConfig* config, IPrepInfo* repInfo,
-    uint32_t* listid)
+static inline IPdecision GetReputation(ReputationConfig* config, table_flat_t* iplist,
+    IPrepInfo* repInfo, uint32_t* listid)
 {
     IPdecision decision = DECISION_NULL;
     uint8_t* base;
     ListInfo* listInfo;
 
     /*Walk through the IPrepInfo lists*/
-    base = (uint8_t*)config->iplist;
-    listInfo =  (ListInfo*)(&base[config->iplist->list_info]);
+    base = (uint8_t*)iplist;
+    listInfo =  (ListInfo*)(&base[iplist->list_info]);
 
     while (repInfo)
     {
@@ -226,38 +283,31 @@ static inline IPdecision GetReputation(ReputationConfig* config, IPrepInfo* repI
     return decision;
 }
 
-static bool ReputationDecisionPerLayer(ReputationConfig* config, Packet* p, ip::IpApi ip_api, IPdecision* decision_final)
+static bool ReputationDecisionPerLayer(ReputationConfig* config, const ReputationTable& table,
+    Packet* p, ip::IpApi ip_api, IPdecision* decision_final)
 {
-    const sfip_t* ip;
     IPdecision decision;
-    IPrepInfo* result;
+    const sfip_t* ips[2] = { ip_api.get_src(), ip_api.get_dst() };
+    IPrepInfo* results[2];
 
-    ip = ip_api.get_src();
-    result = ReputationLookup(config, ip);
-    if (result)
-    {
-        decision = GetReputation(config, result, &p->iplist_id);
-
-        *decision_final = decision;
-        if ( config->priority == decision)
-            return true;
-    }
+    ReputationLookup(config, table, ips, results, 2);
 
-    ip = ip_api.get_dst();
-    result = ReputationLookup(config, ip);
-    if (result)
+    for ( unsigned i = 0; i < 2; ++i )
     {
-        decision = GetReputation(config, result, &p->iplist_id);
+        if (results[i])
+        {
+            decision = GetReputation(config, table.iplist, results[i], &p->iplist_id);
 
-        *decision_final = decision;
-        if ( config->priority == decision)
-            return true;
+            *decision_final = decision;
+            if ( config->priority == decision)
+                return true;
+        }
     }
 
     return false;
 }
 
-static IPdecision ReputationDecision(ReputationConfig* config, Packet* p)
+static IPdecision ReputationDecision(ReputationConfig* config, const ReputationTable& table, Packet* p)
 {
     IPdecision decision_final = DECISION_NULL;
 
@@ -272,7 +322,7 @@ static IPdecision ReputationDecision(ReputationConfig* config, Packet* p)
     {
         outer_layer = true;
 
-        if(ReputationDecisionPerLayer(config, p, p->ptrs.ip_api, &decision_final))
+        if(ReputationDecisionPerLayer(config, table, p, p->ptrs.ip_api, &decision_final))
             return decision_final;
 
         if(outer_layer_only)
@@ -289,20 +339,20 @@ static IPdecision ReputationDecision(ReputationConfig* config, Packet* p)
     /*Check INNER IP, when configured or only one layer*/
     if (!outer_layer || (config->nestedIP == INNER) || (config->nestedIP == ALL))
     {
-        ReputationDecisionPerLayer(config, p, p->ptrs.ip_api, &decision_final);
+        ReputationDecisionPerLayer(config, table, p, p->ptrs.ip_api, &decision_final);
     }
 
     return (decision_final);
 }
 
-static void snort_reputation(ReputationConfig* config, Packet* p)
+static void snort_reputation(ReputationConfig* config, const ReputationTable& table, Packet* p)
 {
     IPdecision decision;
 
-    if (!config->iplist)
+    if (!table.iplist)
         return;
 
-    decision = ReputationDecision(config, p);
+    decision = ReputationDecision(config, table, p);
 
     if (DECISION_NULL == decision)
         return;
@@ -346,6 +396,17 @@ static void snort_reputation(ReputationConfig* config, Packet* p)
 // class stuff
 //-------------------------------------------------------------------------
 
+//-------------------------------------------------------------------------
+// image swapping
+//
+// each inspector holds the image it was configured with so a reload only
+// takes effect when the packet threads move to the new config.  swap_image()
+// replaces the image under the mutex and bumps the generation.  each packet
+// thread keeps its own reference in its slot and only takes the mutex when
+// the generation changes, so the old image is unmapped once the last packet
+// thread has moved on.
+//-------------------------------------------------------------------------
+
 class Reputation : public Inspector
 {
 public:
@@ -355,24 +416,96 @@ public:
     void show(SnortConfig*) override;
     void eval(Packet*) override;
 
+    bool swap_image();
+
 private:
+    const ReputationTable& get_table();
+
+private:
+    struct ThreadImage
+    {
+        std::shared_ptr<ReputationImage> image;
+        unsigned gen = 0;
+    };
+
     ReputationConfig* config;
+
+    std::mutex image_mutex;
+    std::shared_ptr<ReputationImage> image;
+    std::atomic<unsigned> image_gen { 0 };
+    ThreadImage* thread_images;
 };
 
 Reputation::Reputation(ReputationConfig* pc)
 {
     config = pc;
-    reputationstats.memory_allocated = sfrt_flat_usage(config->iplist);
+
+    if ( config->image )
+        reputationstats.memory_allocated = config->image->get_header()->memory;
+    else
+        reputationstats.memory_allocated = sfrt_flat_usage(config->iplist);
+
+    if ( config->table.poptrie )
+        reputationstats.memory_allocated += sfrt_poptrie_usage(config->table.poptrie);
+
+    image = config->image;
+    thread_images = new ThreadImage[ThreadConfig::get_instance_max()];
 }
 
 Reputation::~Reputation()
 {
+    delete[] thread_images;
+
     if ( config )
     {
         delete config;
     }
 }
 
+const ReputationTable& Reputation::get_table()
+{
+    ThreadImage& ti = thread_images[get_instance_id()];
+    unsigned gen = image_gen.load(std::memory_order_acquire);
+
+    if ( ti.gen != gen )
+    {
+        std::lock_guard<std::mutex> lock(image_mutex);
+        ti.image = image;
+        ti.gen = image_gen;
+    }
+
+    if ( ti.image )
+        return ti.image->get_table();
+
+    return config->table;
+}
+
+bool Reputation::swap_image()
+{
+    if ( !config->image_path )
+    {
+        LogMessage("reputation: no image configured\n");
+        return false;
+    }
+
+    ReputationImage* ri = ReputationImage::load(
+        config->image_path, config->whiteAction, config->poptrie);
+
+    if ( !ri )
+    {
+        LogMessage("reputation: image %s not swapped\n", config->image_path);
+        return false;
+    }
+
+    LogMessage("reputation: swapped in image %s\n", config->image_path);
+    LogImageStats(ri->get_header());
+
+    std::lock_guard<std::mutex> lock(image_mutex);
+    image.reset(ri);
+    ++image_gen;
+    return true;
+}
+
 void Reputation::show(SnortConfig*)
 {
     PrintReputationConf(config);
@@ -387,12 +520,43 @@ void Reputation::eval(Packet* p)
 
     if (!p->is_rebuilt() && !IsReputationDisabled(p->flow))
     {
-        snort_reputation(config, p);
+        snort_reputation(config, get_table(), p);
         DisableReputation(p->flow);
         ++reputationstats.packets;
     }
 }
 
+// main thread: swap the image of each reputation inspector in the
+// active config; the inspectors of a pending reload are left alone
+bool reputation_swap_image()
+{
+    PolicyMap* pm = snort_conf->policy_map;
+    std::vector<Reputation*> done;
+    bool ok = true;
+
+    for ( unsigned i = 0; i < pm->shells.size(); ++i )
+    {
+        set_policies(snort_conf, i);
+        Reputation* ins = (Reputation*)InspectorManager::get_inspector(REPUTATION_NAME);
+
+        if ( !ins or std::find(done.begin(), done.end(), ins) != done.end() )
+            continue;
+
+        done.push_back(ins);
+
+        if ( !ins->swap_image() )
+            ok = false;
+    }
+    set_default_policy();
+
+    if ( done.empty() )
+    {
+        LogMessage("reputation: not configured\n");
+        return false;
+    }
+    return ok;
+}
+
 //-------------------------------------------------------------------------
 // api stuff
 //-------------------------------------------------------------------------
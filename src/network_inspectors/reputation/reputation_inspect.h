@@ -44,5 +44,9 @@ public:
     ReputationData session;
 };
 
+// main thread: load the configured image again for each inspector in the
+// active config; returns false and keeps the current table on failure
+bool reputation_swap_image();
+
 #endif
 
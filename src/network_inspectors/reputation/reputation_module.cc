@@ -22,9 +22,16 @@
 
 #include "utils/util.h"
 #include <assert.h>
+#include <limits.h>
 #include <sstream>
 
+#include <lua.hpp>
+
+#include "log/messages.h"
+#include "reputation_image.h"
+#include "reputation_inspect.h"
 #include "reputation_parse.h"
+#include "sfrt/sfrt_poptrie.h"
 
 using namespace std;
 
@@ -40,6 +47,14 @@ static const Parameter s_params[] =
     { "blacklist", Parameter::PT_STRING, nullptr, nullptr,
       "blacklist file name with ip lists" },
 
+    { "image", Parameter::PT_STRING, nullptr, nullptr,
+      "compiled image of the lists; loaded instead of the lists unless older and "
+      "written after loading the lists otherwise" },
+
+    { "lookup", Parameter::PT_ENUM, "dir|poptrie", "dir",
+      "dir uses the list table directly; poptrie compiles it for faster lookups of "
+      "large lists using 64M or more" },
+
     { "memcap", Parameter::PT_INT, "1:4095", "500",
       "maximum total memory allocated" },
 
@@ -61,6 +76,18 @@ static const Parameter s_params[] =
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+static int swap_image(lua_State*)
+{
+    reputation_swap_image();
+    return 0;
+}
+
+static const Command reputation_cmds[] =
+{
+    { "swap_image", swap_image, nullptr, "load the image file again and use it for lookups" },
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 static const RuleMap reputation_rules[] =
 {
     { REPUTATION_EVENT_BLACKLIST, REPUTATION_EVENT_BLACKLIST_STR },
@@ -87,6 +114,9 @@ ReputationModule::~ReputationModule()
     }
 }
 
+const Command* ReputationModule::get_commands() const
+{ return reputation_cmds; }
+
 const RuleMap* ReputationModule::get_rules() const
 { return reputation_rules; }
 
@@ -104,6 +134,12 @@ bool ReputationModule::set(const char*, Value& v, SnortConfig*)
     if ( v.is("blacklist") )
         conf->blacklist_path = snort_strdup(v.get_string());
 
+    else if ( v.is("image") )
+        conf->image_path = snort_strdup(v.get_string());
+
+    else if ( v.is("lookup") )
+        conf->poptrie = v.get_long() == 1;
+
     else if ( v.is("memcap") )
         conf->memcap = v.get_long();
 
@@ -144,16 +180,18 @@ bool ReputationModule::begin(const char*, int, SnortConfig*)
 
 bool ReputationModule::end(const char*, int, SnortConfig*)
 {
-    EstimateNumEntries(conf);
-    if (conf->numEntries <= 0)
+    if ( conf->image_path )
     {
-        ParseWarning(WARN_CONF, "Can't find any whitelist/blacklist entries. "
-            "Reputation Preprocessor disabled.\n");
-        return true;
+        char full_path[PATH_MAX+1];
+        UpdatePathToFile(full_path, PATH_MAX, conf->image_path);
+        snort_free(conf->image_path);
+        conf->image_path = snort_strdup(full_path);
+
+        if ( ReputationImage::is_current(conf->image_path, conf) )
+            conf->image.reset(
+                ReputationImage::load(conf->image_path, conf->whiteAction, conf->poptrie));
     }
 
-    IpListInit(conf->numEntries + 1, conf);
-
     if ( (conf->priority == WHITELISTED_TRUST) && (conf->whiteAction == UNBLACK) )
     {
         ParseWarning(WARN_CONF, "Keyword \"whitelist\" for \"priority\" is "
@@ -161,8 +199,34 @@ bool ReputationModule::end(const char*, int, SnortConfig*)
             conf->priority = WHITELISTED_UNBLACK;
     }
 
+    if ( conf->image )
+    {
+        conf->table = conf->image->get_table();
+        conf->iplist = conf->table.iplist;
+        return true;
+    }
+
+    EstimateNumEntries(conf);
+    if (conf->numEntries <= 0)
+    {
+        ParseWarning(WARN_CONF, "Can't find any whitelist/blacklist entries. "
+            "Reputation Preprocessor disabled.\n");
+        return true;
+    }
+
+    IpListInit(conf->numEntries + 1, conf);
+
     LoadListFile(conf->blacklist_path, conf->local_black_ptr, conf);
     LoadListFile(conf->whitelist_path, conf->local_white_ptr, conf);
+
+    if ( conf->image_path )
+        ReputationImage::save(conf->image_path, conf);
+
+    conf->table.iplist = conf->iplist;
+
+    if ( conf->poptrie )
+        conf->table.poptrie = sfrt_poptrie_new(conf->iplist);
+
     return true;
 }
 
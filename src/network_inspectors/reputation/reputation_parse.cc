@@ -25,6 +25,7 @@
 #include "parser/config_file.h"
 #include "utils/util.h"
 #include "main/snort_debug.h"
+#include "sfrt/sfrt_poptrie.h"
 
 using namespace std;
 
@@ -60,6 +61,13 @@ ReputationConfig::~ReputationConfig()
 
     if (whitelist_path)
         snort_free(whitelist_path);
+
+    if (image_path)
+        snort_free(image_path);
+
+    // otherwise the image owns it
+    if (!image)
+        sfrt_poptrie_free(table.poptrie);
 }
 
 
@@ -100,6 +108,7 @@ void IpListInit(uint32_t maxEntries, ReputationConfig* config)
         uint32_t mem_size;
         mem_size = estimateSizeFromEntries(maxEntries, config->memcap);
         config->reputation_segment = (uint8_t*)snort_alloc(mem_size);
+        config->segment_size = mem_size;
 
         segment_meminit(config->reputation_segment, mem_size);
         base = config->reputation_segment;
@@ -551,7 +560,7 @@ static int ProcessLine(char* line, INFO info, ReputationConfig* config)
     return AddIPtoList(&address, info, config);
 }
 
-static int UpdatePathToFile(char* full_path_filename, unsigned int max_size, char* filename)
+int UpdatePathToFile(char* full_path_filename, unsigned int max_size, char* filename)
 {
     const char* snort_conf_dir = get_snort_conf_dir();
 
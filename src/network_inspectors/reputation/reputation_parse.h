@@ -25,5 +25,6 @@
 void IpListInit(uint32_t,ReputationConfig *config);
 void EstimateNumEntries(ReputationConfig* config);
 void LoadListFile(char* filename, INFO info, ReputationConfig* config);
+int UpdatePathToFile(char* full_path_filename, unsigned int max_size, char* filename);
 
 #endif
@@ -56,6 +56,7 @@ static const int DEFAULT_PKT_SNAPLEN = 1514;
 static const DAQ_Module_t* daq_mod = nullptr;
 static DAQ_Mode daq_mode = DAQ_MODE_PASSIVE;
 static uint32_t snap = DEFAULT_PKT_SNAPLEN;
+static unsigned batch_size = 0;
 static bool loaded = false;
 
 // specific for each thread / instance
@@ -157,6 +158,7 @@ void SFDAQ::init(const SnortConfig* sc)
         FatalError("Can't find %s DAQ\n", type);
 
     snap = (sc->daq_config->mru_size > 0) ? sc->daq_config->mru_size : DEFAULT_PKT_SNAPLEN;
+    batch_size = sc->daq_config->batch_size;
 
     if (SnortConfig::adaptor_inline_mode())
         daq_mode = DAQ_MODE_INLINE;
@@ -197,6 +199,13 @@ uint32_t SFDAQ::get_snap_len()
     return snap;
 }
 
+// Max packets pulled per acquire call; 0 means acquire until the loop is
+// broken and do housekeeping per packet.
+unsigned SFDAQ::get_batch_size()
+{
+    return batch_size;
+}
+
 bool SFDAQ::unprivileged()
 {
     return !(daq_get_type(daq_mod) & DAQ_TYPE_NO_UNPRIV);
@@ -76,6 +76,7 @@ public:
     static bool forwarding_packet(const DAQ_PktHdr_t*);
     static const char* get_type();
     SO_PUBLIC static uint32_t get_snap_len();
+    static unsigned get_batch_size();
     static bool unprivileged();
     static const char* get_input_spec(const SnortConfig*, unsigned instance_id);
     static const char* default_type();
@@ -60,6 +60,9 @@ struct PortGroup
     // detection option tree
     void* nfp_tree;
 
+    // nfp rules with header only options, screened before evaluation
+    class HeaderClassifier* nfp_classifier;
+
     unsigned rule_count;
     unsigned nfp_rule_count;
 
@@ -327,11 +327,11 @@ void reset_rule_profiler_stats()
 
 void RuleContext::stop(bool match)
 {
-    if ( finished )
+    if ( finished or !stats )
         return;
 
     finished = true;
-    stats.update(sw.get(), match);
+    stats->update(sw.get(), match);
 }
 
 #ifdef UNIT_TEST
@@ -674,7 +674,7 @@ TEST_CASE( "rule profiler sorting", "[profiler][rule_profiler]" )
 
 TEST_CASE( "rule profiler time context", "[profiler][rule_profiler]" )
 {
-    dot_node_state_t stats;
+    dot_node_profile_t stats;
 
     stats.elapsed = 0_ticks;
     stats.checks = 0;
@@ -683,7 +683,7 @@ TEST_CASE( "rule profiler time context", "[profiler][rule_profiler]" )
     SECTION( "automatically updates stats" )
     {
         {
-            RuleContext ctx(stats);
+            RuleContext ctx(&stats);
             avoid_optimization();
         }
 
@@ -696,12 +696,12 @@ TEST_CASE( "rule profiler time context", "[profiler][rule_profiler]" )
 
     SECTION( "explicitly calling stop" )
     {
-        dot_node_state_t save;
+        dot_node_profile_t save;
 
         SECTION( "stop(true)" )
         {
             {
-                RuleContext ctx(stats);
+                RuleContext ctx(&stats);
                 avoid_optimization();
                 ctx.stop(true);
 
@@ -716,7 +716,7 @@ TEST_CASE( "rule profiler time context", "[profiler][rule_profiler]" )
         SECTION( "stop(false)" )
         {
             {
-                RuleContext ctx(stats);
+                RuleContext ctx(&stats);
                 avoid_optimization();
                 ctx.stop(false);
 
@@ -737,8 +737,8 @@ TEST_CASE( "rule profiler time context", "[profiler][rule_profiler]" )
 
 TEST_CASE( "rule pause", "[profiler][rule_profiler]" )
 {
-    dot_node_state_t stats;
-    RuleContext ctx(stats);
+    dot_node_profile_t stats;
+    RuleContext ctx(&stats);
 
     {
         RulePause pause(ctx);
@@ -24,7 +24,7 @@
 #include "detection/treenodes.h"
 #include "time_profiler_defs.h"
 
-struct dot_node_state_t;
+struct dot_node_profile_t;
 
 struct RuleProfilerConfig
 {
@@ -44,10 +44,11 @@ struct RuleProfilerConfig
     unsigned count = 0;
 };
 
+// stats is null when rule profiling is not configured; then this does nothing
 class RuleContext
 {
 public:
-    RuleContext(dot_node_state_t& stats) :
+    RuleContext(dot_node_profile_t* stats) :
         stats(stats)
     { start(); }
 
@@ -55,10 +56,10 @@ public:
     { stop(); }
 
     void start()
-    { sw.start(); }
+    { if ( stats ) sw.start(); }
 
     void pause()
-    { sw.stop(); }
+    { if ( stats ) sw.stop(); }
 
     void stop(bool = false);
 
@@ -66,7 +67,7 @@ public:
     { return sw.active(); }
 
 private:
-    dot_node_state_t& stats;
+    dot_node_profile_t* stats;
     Stopwatch<SnortClock> sw;
     bool finished = false;
 };
@@ -76,6 +76,17 @@ public:
         return bnfaCompile(sc, obj);
     }
 
+    int prep_compile(SnortConfig*) override
+    {
+        return bnfaCompileStates(obj);
+    }
+
+    int prep_trees(SnortConfig* sc) override
+    {
+        bnfaCompileTrees(sc, obj);
+        return 0;
+    }
+
     int _search(
         const uint8_t* T, int n, MpseMatch match,
         void* context, int* current_state) override
@@ -85,6 +96,29 @@ public:
             obj, T, n, match, context, 0 /* start-state */, current_state);
     }
 
+    void _search_batch(MpseBatchItem* items, unsigned count, MpseMatch match) override
+    {
+        bnfa_struct_t* nfa[BNFA_BATCH_MAX];
+        const uint8_t* buf[BNFA_BATCH_MAX];
+        int len[BNFA_BATCH_MAX];
+        void* ctx[BNFA_BATCH_MAX];
+
+        for ( unsigned i = 0; i < count; i += BNFA_BATCH_MAX )
+        {
+            unsigned n = 0;
+
+            for ( ; n < BNFA_BATCH_MAX and i + n < count; ++n )
+            {
+                MpseBatchItem& item = items[i + n];
+                nfa[n] = ((AcBnfaMpse*)item.so)->obj;
+                buf[n] = item.buf;
+                len[n] = item.len;
+                ctx[n] = item.context;
+            }
+            _bnfa_search_csparse_nfa_batch(nfa, buf, len, ctx, n, match);
+        }
+    }
+
     //  FIXIT-L: Implement search_all method for AC_BNFA.
 
     int print_info() override
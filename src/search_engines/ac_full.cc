@@ -72,6 +72,48 @@ public:
         return acsm_search_nfa(obj, T, n, match, context, current_state);
     }
 
+    void _search_batch(MpseBatchItem* items, unsigned count, MpseMatch match) override
+    {
+        ACSM_STRUCT2* dfa[ACSM_BATCH_MAX];
+        const uint8_t* buf[ACSM_BATCH_MAX];
+        int len[ACSM_BATCH_MAX];
+        void* ctx[ACSM_BATCH_MAX];
+        unsigned n = 0;
+
+        for ( unsigned i = 0; i < count; ++i )
+        {
+            MpseBatchItem& item = items[i];
+            AcfMpse* acf = (AcfMpse*)item.so;
+
+            if ( !acf->obj->dfa_enabled() )
+            {
+                int state = 0;
+                acsm_search_nfa(acf->obj, item.buf, item.len, match, item.context, &state);
+                continue;
+            }
+
+            // long buffers are split across simd lanes, the rest are interleaved
+            int found;
+
+            if ( acsm_search_dfa_full_simd(
+                acf->obj, item.buf, item.len, match, item.context, &found) )
+                continue;
+
+            dfa[n] = acf->obj;
+            buf[n] = item.buf;
+            len[n] = item.len;
+            ctx[n] = item.context;
+
+            if ( ++n == ACSM_BATCH_MAX )
+            {
+                acsm_search_dfa_full_batch(dfa, buf, len, ctx, n, match);
+                n = 0;
+            }
+        }
+        if ( n )
+            acsm_search_dfa_full_batch(dfa, buf, len, ctx, n, match);
+    }
+
     int search_all(
         const uint8_t* T, int n, MpseMatch match,
         void* context, int* current_state) override
@@ -0,0 +1,125 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#include "acsmx2.h"
+
+#include "main/snort_debug.h"
+#include "main/snort_types.h"
+#include "main/snort_config.h"
+#include "utils/util.h"
+#include "profiler/profiler.h"
+#include "framework/mpse.h"
+
+//-------------------------------------------------------------------------
+// "ac_packed"
+//-------------------------------------------------------------------------
+
+class AcpMpse : public Mpse
+{
+private:
+    ACSM_STRUCT2* obj;
+
+public:
+    AcpMpse(SnortConfig*, bool use_gc, const MpseAgent* agent)
+        : Mpse("ac_packed", use_gc)
+    {
+        // the packed format is only built from a dfa
+        obj = acsmNew2(agent, ACF_PACKED);
+        obj->enable_dfa();
+    }
+
+    ~AcpMpse()
+    { acsmFree2(obj); }
+
+    int add_pattern(
+        SnortConfig*, const uint8_t* P, unsigned m,
+        const PatternDescriptor& desc, void* user) override
+    {
+        return acsmAddPattern2(obj, P, m, desc.no_case, desc.negated, user);
+    }
+
+    int prep_patterns(SnortConfig* sc) override
+    { return acsmCompile2(sc, obj); }
+
+    int _search(
+        const uint8_t* T, int n, MpseMatch match,
+        void* context, int* current_state) override
+    {
+        return acsm_search_dfa_packed(obj, T, n, match, context, current_state);
+    }
+
+    int print_info() override
+    { return acsmPrintDetailInfo2(obj); }
+
+    int get_pattern_count() override
+    { return acsmPatternCount2(obj); }
+};
+
+//-------------------------------------------------------------------------
+// api
+//-------------------------------------------------------------------------
+
+static Mpse* acp_ctor(
+    SnortConfig* sc, class Module*, bool use_gc, const MpseAgent* agent)
+{
+    return new AcpMpse(sc, use_gc, agent);
+}
+
+static void acp_dtor(Mpse* p)
+{
+    delete p;
+}
+
+static void acp_init()
+{
+    acsmx2_init_xlatcase();
+    acsm_init_summary();
+}
+
+static void acp_print()
+{
+    acsmPrintSummaryInfo2();
+}
+
+static const MpseApi acp_api =
+{
+    {
+        PT_SEARCH_ENGINE,
+        sizeof(MpseApi),
+        SEAPI_VERSION,
+        0,
+        API_RESERVED,
+        API_OPTIONS,
+        "ac_packed",
+        "Aho-Corasick Packed (low memory, high performance) MPSE with byte classes",
+        nullptr,
+        nullptr
+    },
+    false,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    acp_ctor,
+    acp_dtor,
+    acp_init,
+    acp_print,
+};
+
+const BaseApi* se_ac_packed = &acp_api.base;
+
@@ -117,12 +117,20 @@
 #include "config.h"
 #endif
 
+#include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
 #include <list>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ACSM_SIMD
+#endif
 
 #define ACSMX2_TRACK_Q
 
@@ -139,14 +147,14 @@
 
 #define MEMASSERT(p,s) if (!p) { FatalError("ACSM-No Memory: %s\n",s); }
 
-static int acsm2_total_memory = 0;
+static size_t acsm2_total_memory = 0;
 static int acsm2_pattern_memory = 0;
 static int acsm2_matchlist_memory = 0;
 static int acsm2_transtable_memory = 0;
-static int acsm2_dfa_memory = 0;
-static int acsm2_dfa1_memory = 0;
-static int acsm2_dfa2_memory = 0;
-static int acsm2_dfa4_memory = 0;
+static size_t acsm2_dfa_memory = 0;
+static size_t acsm2_dfa1_memory = 0;
+static size_t acsm2_dfa2_memory = 0;
+static size_t acsm2_dfa4_memory = 0;
 static int acsm2_failstate_memory = 0;
 
 struct acsm_summary_t
@@ -160,6 +168,8 @@ struct acsm_summary_t
     unsigned num_1byte_instances;
     unsigned num_2byte_instances;
     unsigned num_4byte_instances;
+    unsigned num_packed_classes;
+    unsigned num_hot_bytes;
     ACSM_STRUCT2 acsm;
 };
 
@@ -176,6 +186,8 @@ void acsm_init_summary()
     summary.num_1byte_instances = 0;
     summary.num_2byte_instances = 0;
     summary.num_4byte_instances = 0;
+    summary.num_packed_classes = 0;
+    summary.num_hot_bytes = 0;
     memset(&summary.acsm, 0, sizeof(ACSM_STRUCT2));
     acsm2_total_memory = 0;
     acsm2_pattern_memory = 0;
@@ -189,6 +201,10 @@ void acsm_init_summary()
 ** Case Translation Table
 */
 static uint8_t xlatcase[256];
+
+// set at init if the avx2 full dfa search can be used on this cpu
+static bool acsm_simd = false;
+
 /*
 *
 */
@@ -199,6 +215,9 @@ void acsmx2_init_xlatcase()
     {
         xlatcase[i] = (uint8_t)toupper(i);
     }
+#ifdef ACSM_SIMD
+    acsm_simd = __builtin_cpu_supports("avx2");
+#endif
 }
 
 /*
@@ -278,7 +297,7 @@ static void* AC_MALLOC(int n, Acsm2MemoryType type)
     return p;
 }
 
-static void* AC_MALLOC_DFA(int n, int sizeofstate)
+static void* AC_MALLOC_DFA(size_t n, int sizeofstate)
 {
     void* p = snort_calloc(n);
 
@@ -330,7 +349,7 @@ static void AC_FREE(void* p, int n, Acsm2MemoryType type)
     }
 }
 
-static void AC_FREE_DFA(void* p, int n, int sizeofstate)
+static void AC_FREE_DFA(void* p, size_t n, int sizeofstate)
 {
     if (p != NULL)
     {
@@ -354,6 +373,15 @@ static void AC_FREE_DFA(void* p, int n, int sizeofstate)
     }
 }
 
+// bytes needed for rows * row_size + pad or 0 if that overflows
+static size_t dfa_table_size(size_t rows, size_t row_size, size_t pad)
+{
+    if ( row_size and rows > (SIZE_MAX - pad) / row_size )
+        return 0;
+
+    return rows * row_size + pad;
+}
+
 static void queue_add(std::list<int>& q, int s)
 {
     for ( auto qs : q )
@@ -746,12 +774,25 @@ static int Conv_List_To_Full(ACSM_STRUCT2* acsm)
     acstate_t* p;
     acstate_t** NextState = acsm->acsmNextState;
 
+    // rows are carved from one block so the table can also be indexed by
+    // state number.  the pad keeps a 4 byte gather of the last entry in
+    // bounds for 1 and 2 byte states.
+    size_t row = (size_t)acsm->sizeofstate * (acsm->acsmAlphabetSize + 2);
+    size_t size = dfa_table_size(acsm->acsmNumStates, row, sizeof(acstate_t));
+
+    if ( !size )
+        return -1;
+
+    uint8_t* table = (uint8_t*)AC_MALLOC_DFA(size, acsm->sizeofstate);
+
+    if (table == NULL)
+        return -1;
+
+    acsm->acsmFullTable = table;
+
     for (k = 0; k < (acstate_t)acsm->acsmNumStates; k++)
     {
-        p = (acstate_t*)AC_MALLOC_DFA(acsm->sizeofstate * (acsm->acsmAlphabetSize + 2),
-            acsm->sizeofstate);
-        if (p == NULL)
-            return -1;
+        p = (acstate_t*)(table + (size_t)k * row);
 
         switch (acsm->sizeofstate)
         {
@@ -778,6 +819,202 @@ static int Conv_List_To_Full(ACSM_STRUCT2* acsm)
     return 0;
 }
 
+/*
+*   Convert the DFA lists to the packed format which is designed to keep
+*   the working set of the table in cache:
+*
+*   1. bytes with the same transition from every state are merged into a
+*      class so each row has one entry per class instead of one per byte.
+*      the class map also folds in the case translation.
+*   2. states are renumbered in breadth first order so the shallow states,
+*      which take nearly all transitions on real traffic, are packed into a
+*      prefix of the table.
+*   3. entries are 16 bits if the state count allows.  the high bit of an
+*      entry is set if the next state has matches so the match list is only
+*      touched on a hit.
+*/
+static void Get_Full_Row(ACSM_STRUCT2* acsm, acstate_t state, acstate_t* row)
+{
+    memset(row, 0, sizeof(acstate_t) * acsm->acsmAlphabetSize);
+
+    for ( trans_node_t* t = acsm->acsmTransTable[state]; t; t = t->next )
+        row[t->key] = t->next_state;
+}
+
+static void Make_Byte_Classes(ACSM_STRUCT2* acsm, std::vector<int>& reps)
+{
+    const int nsyms = acsm->acsmAlphabetSize;
+    std::vector<acstate_t> row(nsyms);
+    std::vector<uint64_t> hash(nsyms, 0xcbf29ce484222325ull);
+
+    for ( int k = 0; k < acsm->acsmNumStates; k++ )
+    {
+        Get_Full_Row(acsm, k, &row[0]);
+
+        for ( int b = 0; b < nsyms; b++ )
+            hash[b] = (hash[b] ^ row[b]) * 0x100000001b3ull;
+    }
+
+    // only bytes which survive case translation are ever looked up
+    std::vector<int> cls(nsyms, -1);
+
+    for ( int b = 0; b < nsyms; b++ )
+    {
+        if ( xlatcase[b] != b )
+            continue;
+
+        for ( unsigned c = 0; c < reps.size(); c++ )
+        {
+            if ( hash[reps[c]] == hash[b] )
+            {
+                cls[b] = c;
+                break;
+            }
+        }
+        if ( cls[b] < 0 )
+        {
+            cls[b] = reps.size();
+            reps.push_back(b);
+        }
+    }
+
+    // verify the classes; a hash collision just costs a class
+    std::vector<bool> split(nsyms, false);
+
+    for ( int k = 0; k < acsm->acsmNumStates; k++ )
+    {
+        Get_Full_Row(acsm, k, &row[0]);
+
+        for ( int b = 0; b < nsyms; b++ )
+        {
+            if ( cls[b] >= 0 and row[b] != row[reps[cls[b]]] )
+                split[b] = true;
+        }
+    }
+    for ( int b = 0; b < nsyms; b++ )
+    {
+        if ( split[b] )
+        {
+            cls[b] = reps.size();
+            reps.push_back(b);
+        }
+    }
+
+    for ( int b = 0; b < nsyms; b++ )
+        acsm->acsmClassMap[b] = (uint8_t)cls[xlatcase[b]];
+
+    acsm->acsmNumClasses = reps.size();
+}
+
+static void Order_States(ACSM_STRUCT2* acsm, std::vector<acstate_t>& new_id)
+{
+    const acstate_t unset = ACSM_FAIL_STATE2;
+    std::vector<acstate_t> order;
+    std::vector<uint8_t> depth(acsm->acsmNumStates, 0);
+
+    new_id.assign(acsm->acsmNumStates, unset);
+    order.reserve(acsm->acsmNumStates);
+
+    new_id[0] = 0;
+    order.push_back(0);
+    acsm->acsmHotStates = 0;
+
+    for ( unsigned i = 0; i < order.size(); i++ )
+    {
+        acstate_t s = order[i];
+
+        if ( depth[s] <= 2 )
+            acsm->acsmHotStates++;
+
+        for ( trans_node_t* t = acsm->acsmTransTable[s]; t; t = t->next )
+        {
+            if ( new_id[t->next_state] != unset )
+                continue;
+
+            new_id[t->next_state] = order.size();
+            depth[t->next_state] = depth[s] < 255 ? depth[s] + 1 : 255;
+            order.push_back(t->next_state);
+        }
+    }
+
+    // every trie state is reachable but be safe
+    for ( int k = 0; k < acsm->acsmNumStates; k++ )
+    {
+        if ( new_id[k] == unset )
+            new_id[k] = order.size(), order.push_back(k);
+    }
+}
+
+template <typename entry_t>
+static int Fill_Packed_Table(
+    ACSM_STRUCT2* acsm, const std::vector<int>& reps, const std::vector<acstate_t>& new_id)
+{
+    const int nclasses = acsm->acsmNumClasses;
+    const entry_t flag = (entry_t)1 << (8 * sizeof(entry_t) - 1);
+
+    size_t size = dfa_table_size(
+        acsm->acsmNumStates, sizeof(entry_t) * (size_t)nclasses, 0);
+
+    if ( !size )
+        return -1;
+
+    entry_t* table = (entry_t*)AC_MALLOC_DFA(size, sizeof(entry_t));
+
+    if ( !table )
+        return -1;
+
+    std::vector<acstate_t> row(acsm->acsmAlphabetSize);
+
+    for ( int k = 0; k < acsm->acsmNumStates; k++ )
+    {
+        entry_t* pr = table + (size_t)new_id[k] * nclasses;
+        Get_Full_Row(acsm, k, &row[0]);
+
+        for ( int c = 0; c < nclasses; c++ )
+        {
+            acstate_t next = row[reps[c]];
+            pr[c] = (entry_t)new_id[next];
+
+            if ( acsm->acsmMatchList[next] )
+                pr[c] |= flag;
+        }
+    }
+    acsm->acsmPackedTable = table;
+    acsm->sizeofstate = sizeof(entry_t);
+    return 0;
+}
+
+static int Conv_List_To_Packed(ACSM_STRUCT2* acsm)
+{
+    std::vector<int> reps;
+    std::vector<acstate_t> new_id;
+
+    Make_Byte_Classes(acsm, reps);
+    Order_States(acsm, new_id);
+
+    int rval;
+
+    if ( acsm->acsmNumStates <= INT16_MAX )
+        rval = Fill_Packed_Table<uint16_t>(acsm, reps, new_id);
+    else
+        rval = Fill_Packed_Table<acstate_t>(acsm, reps, new_id);
+
+    if ( rval )
+        return rval;
+
+    // the match lists follow the states
+    ACSM_PATTERN2** MatchList = acsm->acsmMatchList;
+    std::vector<ACSM_PATTERN2*> ml(MatchList, MatchList + acsm->acsmNumStates);
+
+    for ( int k = 0; k < acsm->acsmNumStates; k++ )
+        MatchList[new_id[k]] = ml[k];
+
+    summary.num_packed_classes += acsm->acsmNumClasses;
+    summary.num_hot_bytes += acsm->acsmHotStates * acsm->acsmNumClasses * acsm->sizeofstate;
+
+    return 0;
+}
+
 /*
 *   Convert DFA memory usage from list based storage to a sparse-row storage.
 *
@@ -1129,7 +1366,12 @@ static void acsmUpdateMatchStates(ACSM_STRUCT2* acsm)
     {
         acstate_t* p = NextState[state];
 
-        if (MatchList[state])
+        if (MatchList[state] && !p)
+        {
+            // packed format flags matches in the transitions
+            summary.num_match_states++;
+        }
+        else if (MatchList[state])
         {
             switch (acsm->sizeofstate)
             {
@@ -1199,8 +1441,13 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
 
     /* Count number of possible states */
     for (plist = acsm->acsmPatterns; plist != NULL; plist = plist->next)
+    {
         acsm->acsmMaxStates += plist->n;
 
+        if ( plist->n > acsm->max_pattern_len )
+            acsm->max_pattern_len = plist->n;
+    }
+
     acsm->acsmMaxStates++; /* one extra */
 
     /* Alloc a List based State Transition table */
@@ -1305,6 +1552,11 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
         if ( Conv_List_To_Full(acsm) )
             return -1;
     }
+    else if ( acsm->acsmFormat == ACF_PACKED )
+    {
+        if ( !acsm->dfa or Conv_List_To_Packed(acsm) )
+            return -1;
+    }
 
     /* load boolean match flags into state table */
     acsmUpdateMatchStates(acsm);
@@ -1691,6 +1943,322 @@ int acsm_search_dfa_full(
     return nfound;
 }
 
+/*
+*   Batched full format DFA search
+*   Each lane is an independent acsm_search_dfa_full.  Lanes are advanced
+*   one byte at a time in round robin so that the dependent next state load
+*   of one lane is overlapped with those of the others.  Lanes are grouped
+*   by state size so the inner loop has a fixed table type.
+*/
+struct AcsmLane
+{
+    ACSM_STRUCT2* acsm;
+    const uint8_t* Tx;
+    const uint8_t* T;
+    const uint8_t* Tend;
+    void* context;
+    acstate_t state;
+};
+
+// returns true when the lane is done
+static inline bool acsm_lane_match(AcsmLane& l, MpseMatch match, int& nfound)
+{
+    ACSM_PATTERN2* mlist = l.acsm->acsmMatchList[l.state];
+
+    if ( !mlist )
+        return false;
+
+    nfound++;
+
+    return match(mlist->udata, mlist->rule_option_tree, l.T - l.Tx, l.context,
+        mlist->neg_list) > 0;
+}
+
+template <typename state_t>
+static int acsm_search_dfa_full_lanes(AcsmLane* lane, unsigned active, MpseMatch match)
+{
+    int nfound = 0;
+
+    while ( active )
+    {
+        for ( unsigned i = 0; i < active; )
+        {
+            AcsmLane& l = lane[i];
+            bool done;
+
+            if ( l.T < l.Tend )
+            {
+                state_t* ps = ((state_t**)l.acsm->acsmNextState)[l.state];
+                unsigned sindex = xlatcase[l.T[0]];
+
+                done = ps[1] and acsm_lane_match(l, match, nfound);
+
+                if ( !done )
+                {
+                    l.state = ps[2u + sindex];
+                    l.T++;
+                }
+            }
+            else
+            {
+                // check the last state for a pattern match
+                acsm_lane_match(l, match, nfound);
+                done = true;
+            }
+
+            if ( done )
+                lane[i] = lane[--active];
+            else
+                ++i;
+        }
+    }
+    return nfound;
+}
+
+int acsm_search_dfa_full_batch(
+    ACSM_STRUCT2** acsm, const uint8_t** Tx, const int* n, void** context,
+    unsigned count, MpseMatch match)
+{
+    AcsmLane lane[3][ACSM_BATCH_MAX];
+    unsigned active[3] = { 0, 0, 0 };
+
+    assert(count <= ACSM_BATCH_MAX);
+
+    for ( unsigned i = 0; i < count; ++i )
+    {
+        unsigned k = (acsm[i]->sizeofstate == 1) ? 0 : (acsm[i]->sizeofstate == 2) ? 1 : 2;
+        AcsmLane& l = lane[k][active[k]++];
+
+        l.acsm = acsm[i];
+        l.Tx = l.T = Tx[i];
+        l.Tend = Tx[i] + n[i];
+        l.context = context[i];
+        l.state = 0;
+    }
+
+    int nfound = 0;
+    nfound += acsm_search_dfa_full_lanes<uint8_t>(lane[0], active[0], match);
+    nfound += acsm_search_dfa_full_lanes<uint16_t>(lane[1], active[1], match);
+    nfound += acsm_search_dfa_full_lanes<acstate_t>(lane[2], active[2], match);
+
+    return nfound;
+}
+
+/*
+*   SIMD full format DFA search
+*   The buffer is split into 8 chunks of S bytes, each starting D = S - ov
+*   bytes after the last where ov is the longest pattern.  All chunks are
+*   walked at once, one byte per step, with the next states fetched by a
+*   single avx2 gather from the contiguous full table.  After ov bytes a
+*   chunk is in the same state a serial walk would be (no state is deeper
+*   than the longest pattern), so chunk i > 0 only reports matches from
+*   step ov on and each position is reported exactly once.  The last chunk
+*   then finishes the tail of the buffer serially.
+*/
+#ifdef ACSM_SIMD
+
+#define ACSM_SIMD_LANES 8
+#define ACSM_SIMD_MIN_LEN 512
+
+template <typename state_t>
+__attribute__((target("avx2")))
+static int acsm_search_dfa_full_avx2(
+    ACSM_STRUCT2* acsm, const uint8_t* Tx, int n, MpseMatch match, void* context)
+{
+    const int ov = acsm->max_pattern_len;
+    const int D = (n - ov) / ACSM_SIMD_LANES;
+    const int S = D + ov;
+
+    const int* table = (const int*)acsm->acsmFullTable;
+    ACSM_PATTERN2** MatchList = acsm->acsmMatchList;
+    ACSM_PATTERN2* mlist;
+
+    const __m256i vrow = _mm256_set1_epi32(acsm->acsmAlphabetSize + 2);
+    const __m256i vmask = _mm256_set1_epi32(
+        sizeof(state_t) == 4 ? -1 : (int)((1u << (8 * sizeof(state_t))) - 1));
+    const __m256i vone = _mm256_set1_epi32(1);
+    const __m256i vtwo = _mm256_set1_epi32(2);
+    const __m256i vzero = _mm256_setzero_si256();
+
+    __m256i vstate = vzero;
+    alignas(32) int32_t st[ACSM_SIMD_LANES];
+
+    const uint8_t* T[ACSM_SIMD_LANES];
+    int report[ACSM_SIMD_LANES];
+    int nfound = 0;
+
+    for ( int i = 0; i < ACSM_SIMD_LANES; ++i )
+    {
+        T[i] = Tx + i * D;
+        report[i] = i ? ov : 0;
+    }
+
+    for ( int k = 0; k < S; ++k )
+    {
+        __m256i vps = _mm256_mullo_epi32(vstate, vrow);
+
+        // ps[1] is the match flag
+        __m256i vflag = _mm256_and_si256(
+            _mm256_i32gather_epi32(table, _mm256_add_epi32(vps, vone), sizeof(state_t)), vmask);
+
+        unsigned hits = ~_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(vflag, vzero))) & 0xff;
+
+        if ( hits )
+        {
+            _mm256_store_si256((__m256i*)st, vstate);
+
+            for ( int i = 0; i < ACSM_SIMD_LANES; ++i )
+            {
+                if ( !(hits & (1u << i)) or k < report[i] )
+                    continue;
+
+                mlist = MatchList[st[i]];
+
+                if ( mlist )
+                {
+                    nfound++;
+                    if ( match(mlist->udata, mlist->rule_option_tree, T[i] + k - Tx,
+                        context, mlist->neg_list) > 0 )
+                        return nfound;
+                }
+            }
+        }
+
+        __m256i vsym = _mm256_setr_epi32(
+            xlatcase[T[0][k]], xlatcase[T[1][k]], xlatcase[T[2][k]], xlatcase[T[3][k]],
+            xlatcase[T[4][k]], xlatcase[T[5][k]], xlatcase[T[6][k]], xlatcase[T[7][k]]);
+
+        vps = _mm256_add_epi32(vps, _mm256_add_epi32(vsym, vtwo));
+        vstate = _mm256_and_si256(_mm256_i32gather_epi32(table, vps, sizeof(state_t)), vmask);
+    }
+
+    // the last lane picks up the remainder
+    _mm256_store_si256((__m256i*)st, vstate);
+    acstate_t state = st[ACSM_SIMD_LANES - 1];
+
+    state_t** NextState = (state_t**)acsm->acsmNextState;
+    const uint8_t* Tp = T[ACSM_SIMD_LANES - 1] + S;
+    const uint8_t* Tend = Tx + n;
+
+    for ( ; Tp < Tend; Tp++ )
+    {
+        state_t* ps = NextState[state];
+
+        if ( ps[1] and (mlist = MatchList[state]) )
+        {
+            nfound++;
+            if ( match(mlist->udata, mlist->rule_option_tree, Tp - Tx, context,
+                mlist->neg_list) > 0 )
+                return nfound;
+        }
+        state = ps[2u + xlatcase[Tp[0]]];
+    }
+
+    // check the last state for a pattern match
+    if ( (mlist = MatchList[state]) )
+    {
+        nfound++;
+        match(mlist->udata, mlist->rule_option_tree, Tp - Tx, context, mlist->neg_list);
+    }
+    return nfound;
+}
+#endif
+
+bool acsm_search_dfa_full_simd(
+    ACSM_STRUCT2* acsm, const uint8_t* Tx, int n, MpseMatch match, void* context, int* nfound)
+{
+#ifdef ACSM_SIMD
+    if ( !acsm_simd or !acsm->acsmFullTable or !acsm->dfa )
+        return false;
+
+    // each chunk must be at least twice the overlap to be worthwhile
+    if ( n < ACSM_SIMD_MIN_LEN or n < acsm->max_pattern_len * (2 * ACSM_SIMD_LANES + 1) )
+        return false;
+
+    // gather indices are signed 32 bit entries
+    if ( (int64_t)acsm->acsmNumStates * (acsm->acsmAlphabetSize + 2) >= INT32_MAX )
+        return false;
+
+    switch ( acsm->sizeofstate )
+    {
+    case 1:
+        *nfound = acsm_search_dfa_full_avx2<uint8_t>(acsm, Tx, n, match, context);
+        break;
+    case 2:
+        *nfound = acsm_search_dfa_full_avx2<uint16_t>(acsm, Tx, n, match, context);
+        break;
+    default:
+        *nfound = acsm_search_dfa_full_avx2<acstate_t>(acsm, Tx, n, match, context);
+        break;
+    }
+    return true;
+#else
+    UNUSED(acsm);
+    UNUSED(Tx);
+    UNUSED(n);
+    UNUSED(match);
+    UNUSED(context);
+    UNUSED(nfound);
+    return false;
+#endif
+}
+
+/*
+*   Packed format DFA search
+*   Matches are flagged in the transition so the match is reported right
+*   after the byte that completes it, which is the same index the full
+*   format reports before the next byte.
+*/
+template <typename entry_t>
+static int acsm_search_packed(
+    ACSM_STRUCT2* acsm, const uint8_t* Tx, int n, MpseMatch match,
+    void* context, int* current_state)
+{
+    const entry_t* table = (const entry_t*)acsm->acsmPackedTable;
+    const uint8_t* cls = acsm->acsmClassMap;
+    const unsigned nclasses = acsm->acsmNumClasses;
+    const entry_t flag = (entry_t)1 << (8 * sizeof(entry_t) - 1);
+
+    ACSM_PATTERN2** MatchList = acsm->acsmMatchList;
+    const uint8_t* T = Tx;
+    const uint8_t* Tend = Tx + n;
+    acstate_t state = *current_state;
+    int nfound = 0;
+
+    for ( ; T < Tend; T++ )
+    {
+        entry_t next = table[(size_t)state * nclasses + cls[T[0]]];
+        state = next & ~flag;
+
+        if ( next & flag )
+        {
+            ACSM_PATTERN2* mlist = MatchList[state];
+            nfound++;
+
+            if ( match(mlist->udata, mlist->rule_option_tree, T - Tx + 1, context,
+                mlist->neg_list) > 0 )
+                break;
+        }
+    }
+
+    *current_state = state;
+    return nfound;
+}
+
+int acsm_search_dfa_packed(
+    ACSM_STRUCT2* acsm, const uint8_t* Tx, int n, MpseMatch match,
+    void* context, int* current_state)
+{
+    if ( !current_state )
+        return 0;
+
+    if ( acsm->sizeofstate == 2 )
+        return acsm_search_packed<uint16_t>(acsm, Tx, n, match, context, current_state);
+
+    return acsm_search_packed<acstate_t>(acsm, Tx, n, match, context, current_state);
+}
+
 /*
 *   Full format DFA search
 *   Do not change anything here without testing, caching and prefetching
@@ -1960,7 +2528,8 @@ void acsmFree2(ACSM_STRUCT2* acsm)
             AC_FREE(ilist, 0, ACSM2_MEMORY_TYPE__NONE);
         }
 
-        AC_FREE_DFA(acsm->acsmNextState[i], 0, 0);
+        if ( !acsm->acsmFullTable )
+            AC_FREE_DFA(acsm->acsmNextState[i], 0, 0);
     }
 
     for (plist = acsm->acsmPatterns; plist; )
@@ -1977,6 +2546,8 @@ void acsmFree2(ACSM_STRUCT2* acsm)
         plist = tmpPlist;
     }
 
+    AC_FREE_DFA(acsm->acsmFullTable, 0, 0);
+    AC_FREE_DFA(acsm->acsmPackedTable, 0, 0);
     AC_FREE_DFA(acsm->acsmNextState, 0, 0);
     AC_FREE(acsm->acsmFailState, 0, ACSM2_MEMORY_TYPE__NONE);
     AC_FREE(acsm->acsmMatchList, 0, ACSM2_MEMORY_TYPE__NONE);
@@ -2083,6 +2654,20 @@ static void Print_DFA(ACSM_STRUCT2* acsm)
 
 int acsmPrintDetailInfo2(ACSM_STRUCT2* acsm)
 {
+    if ( acsm->acsmFormat == ACF_PACKED )
+    {
+        uint64_t row = acsm->acsmNumClasses * acsm->sizeofstate;
+
+        LogCount("states", acsm->acsmNumStates);
+        LogCount("byte classes", acsm->acsmNumClasses);
+        LogCount("sizeof state", acsm->sizeofstate);
+        LogCount("table bytes", row * acsm->acsmNumStates);
+        LogCount("full table bytes", (uint64_t)sizeof(acstate_t) * (acsm->acsmAlphabetSize + 2) *
+            acsm->acsmNumStates);
+        LogCount("hot states", acsm->acsmHotStates);
+        LogCount("hot bytes", row * acsm->acsmHotStates);
+        return 0;
+    }
     Print_DFA(acsm);
     return 0;
 }
@@ -2102,6 +2687,7 @@ int acsmPrintSummaryInfo2()
         "sparse",
         "banded",
         "sparse-bands",
+        "packed",
     };
 
     ACSM_STRUCT2* p = &summary.acsm;
@@ -2111,6 +2697,10 @@ int acsmPrintSummaryInfo2()
 
     LogValue("storage format", sf[p->acsmFormat]);
     LogValue("finite automaton", p->dfa ? "DFA" : "NFA");
+
+    if ( p->acsmFormat == ACF_FULL and p->dfa )
+        LogValue("batch search", acsm_simd ? "avx2" : "interleaved");
+
     LogCount("alphabet size", p->acsmAlphabetSize);
 
     LogCount("instances", summary.num_instances);
@@ -2155,6 +2745,13 @@ int acsmPrintSummaryInfo2()
     LogStat("transition memory", acsm2_transtable_memory/scale);
     LogStat("fail state memory", acsm2_failstate_memory/scale);
 
+    if ( p->acsmFormat == ACF_PACKED )
+    {
+        LogStat("table memory", acsm2_dfa_memory/scale);
+        LogStat("hot table memory", summary.num_hot_bytes/scale);
+        LogStat("average classes", (double)summary.num_packed_classes/summary.num_instances);
+    }
+
 #if 0  // FIXIT-L clean up format; not all this should be printed all the time
     if (acsm2_dfa_memory > 0)
     {
@@ -92,6 +92,7 @@ enum
     ACF_SPARSE,
     ACF_BANDED,
     ACF_SPARSE_BANDS,
+    ACF_PACKED,
 };
 
 /*
@@ -108,6 +109,13 @@ struct ACSM_STRUCT2
        the transition lists */
     trans_node_t** acsmTransTable;
     acstate_t** acsmNextState;
+    void* acsmFullTable;  // all full format rows in one block, indexed by state
+
+    // packed format: one row of acsmNumClasses entries per state
+    void* acsmPackedTable;
+    uint8_t acsmClassMap[256];
+    int acsmNumClasses;
+    int acsmHotStates;  // states within 2 transitions of the start state
     const MpseAgent* agent;
 
     int acsmMaxStates;
@@ -123,6 +131,7 @@ struct ACSM_STRUCT2
 
     int sizeofstate;
     int compress_states;
+    int max_pattern_len;
 
     bool dfa;
 
@@ -161,6 +170,23 @@ int acsm_search_dfa_full(
 int acsm_search_dfa_full_all(
     ACSM_STRUCT2*, const uint8_t* Tx, int n, MpseMatch, void* context, int* current_state);
 
+int acsm_search_dfa_packed(
+    ACSM_STRUCT2*, const uint8_t* Tx, int n, MpseMatch, void* context, int* current_state);
+
+// walk up to ACSM_BATCH_MAX full format dfas in lockstep, one buffer and
+// context each, so the state lookups of one walk overlap the others
+#define ACSM_BATCH_MAX 4
+
+int acsm_search_dfa_full_batch(
+    ACSM_STRUCT2**, const uint8_t** T, const int* n, void** context,
+    unsigned count, MpseMatch);
+
+// split one long buffer into overlapping chunks and walk them with simd
+// gathers.  returns false without searching if the cpu or dfa does not
+// support it or the buffer is too short.  matches are reported out of order.
+bool acsm_search_dfa_full_simd(
+    ACSM_STRUCT2*, const uint8_t* T, int n, MpseMatch, void* context, int* nfound);
+
 void acsmFree2(ACSM_STRUCT2*);
 int acsmPatternCount2(ACSM_STRUCT2*);
 void acsmCompressStates(ACSM_STRUCT2*, int);
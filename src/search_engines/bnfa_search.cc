@@ -145,6 +145,7 @@
 #include "config.h"
 #endif
 
+#include <assert.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -1456,9 +1457,21 @@ static inline int _bnfaCompile(bnfa_struct_t* bnfa)
 
     bnfa->bnfaMatchStates = cntMatchStates;
 
+    return 0;
+}
+
+int bnfaCompileStates(bnfa_struct_t* bnfa)
+{
+    return _bnfaCompile(bnfa);
+}
+
+/* summary and trees are shared so this must be done on the main thread */
+void bnfaCompileTrees(SnortConfig* sc, bnfa_struct_t* bnfa)
+{
     bnfaAccumInfo(bnfa);
 
-    return 0;
+    if ( bnfa->agent )
+        bnfaBuildMatchStateTrees(sc, bnfa);
 }
 
 int bnfaCompile(
@@ -1467,9 +1480,7 @@ int bnfaCompile(
     if ( int rval = _bnfaCompile (bnfa) )
         return rval;
 
-    if ( bnfa->agent )
-        bnfaBuildMatchStateTrees(sc, bnfa);
-
+    bnfaCompileTrees(sc, bnfa);
     return 0;
 }
 
@@ -1908,6 +1919,94 @@ unsigned _bnfa_search_csparse_nfa(
     return nfound;
 }
 
+struct BnfaLane
+{
+    bnfa_struct_t* bnfa;
+    const uint8_t* Tx;
+    const uint8_t* T;
+    const uint8_t* Tend;
+    void* context;
+    unsigned sindex;
+    unsigned last_match;
+    unsigned last_match_saved;
+};
+
+/*
+ *  Advance one lane by one byte - same logic as _bnfa_search_csparse_nfa
+ *  returns true when the lane is done
+ */
+static inline bool _bnfa_lane_step(BnfaLane& l, MpseMatch match, unsigned& nfound)
+{
+    bnfa_state_t* transList = l.bnfa->bnfaTransList;
+    const uint8_t* T = l.T++;
+
+    l.sindex = _bnfa_get_next_state_csparse_nfa(transList, l.sindex, xlatcase[*T]);
+
+    if ( l.sindex && (transList[l.sindex+1] & BNFA_SPARSE_MATCH_BIT) &&
+        l.sindex != l.last_match )
+    {
+        l.last_match_saved = l.last_match;
+        l.last_match = l.sindex;
+
+        bnfa_match_node_t* mlist = l.bnfa->bnfaMatchList[ transList[l.sindex] ];
+
+        if ( !mlist )
+            return true;
+
+        bnfa_pattern_t* patrn = (bnfa_pattern_t*)mlist->data;
+        unsigned index = T - l.Tx + 1;
+        nfound++;
+
+        int res = match(patrn->userdata, mlist->rule_option_tree, index,
+            l.context, mlist->neg_list);
+
+        if ( res > 0 )
+            return true;
+
+        else if ( res < 0 )
+            l.last_match = l.last_match_saved;
+    }
+    return l.T >= l.Tend;
+}
+
+unsigned _bnfa_search_csparse_nfa_batch(
+    bnfa_struct_t** bnfa, const uint8_t** Tx, const int* n, void** context,
+    unsigned count, MpseMatch match)
+{
+    BnfaLane lane[BNFA_BATCH_MAX];
+    unsigned active = 0;
+    unsigned nfound = 0;
+
+    assert(count <= BNFA_BATCH_MAX);
+
+    for ( unsigned i = 0; i < count; ++i )
+    {
+        if ( n[i] <= 0 )
+            continue;
+
+        BnfaLane& l = lane[active++];
+        l.bnfa = bnfa[i];
+        l.Tx = l.T = Tx[i];
+        l.Tend = Tx[i] + n[i];
+        l.context = context[i];
+        l.sindex = 0;
+        l.last_match = l.last_match_saved = LAST_STATE_INIT;
+    }
+
+    // finished lanes are replaced by the last active lane
+    while ( active )
+    {
+        for ( unsigned i = 0; i < active; )
+        {
+            if ( _bnfa_lane_step(lane[i], match, nfound) )
+                lane[i] = lane[--active];
+            else
+                ++i;
+        }
+    }
+    return nfound;
+}
+
 #ifdef BNFA_MAIN
 /*
  * Case specific search, global to all patterns
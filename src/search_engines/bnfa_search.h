@@ -168,10 +168,25 @@ int bnfaAddPattern(
 
 int bnfaCompile(struct SnortConfig*, bnfa_struct_t*);
 
+// bnfaCompile() in two steps; the first touches only the given instance
+int bnfaCompileStates(bnfa_struct_t*);
+void bnfaCompileTrees(struct SnortConfig*, bnfa_struct_t*);
+
 unsigned _bnfa_search_csparse_nfa(
     bnfa_struct_t * pstruct, const uint8_t* t, int tlen, MpseMatch,
     void* context, unsigned sindex, int* current_state);
 
+/*
+*   Batch search - walk up to BNFA_BATCH_MAX buffers in lockstep, each with
+*   its own nfa and context, so the state lookups of one walk overlap the
+*   cache misses of the others.
+*/
+#define BNFA_BATCH_MAX 4
+
+unsigned _bnfa_search_csparse_nfa_batch(
+    bnfa_struct_t** pstruct, const uint8_t** t, const int* tlen, void** context,
+    unsigned count, MpseMatch);
+
 int bnfaPatternCount(bnfa_struct_t* p);
 
 void bnfaPrint(bnfa_struct_t* pstruct);   /* prints the nfa states-verbose!! */
@@ -22,7 +22,12 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <stdlib.h>
+#include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <string>
 #include <vector>
@@ -30,9 +35,12 @@
 #include <hs_compile.h>
 #include <hs_runtime.h>
 
+#include "detection/fp_config.h"
+#include "flow/flow.h"
 #include "framework/mpse.h"
 #include "log/messages.h"
 #include "main/snort_config.h"
+#include "memory/memory_cap.h"
 #include "utils/stats.h"
 
 struct Pattern
@@ -99,6 +107,197 @@ typedef std::vector<Pattern> PatternVector;
 
 static hs_scratch_t* s_scratch = nullptr;
 
+// bytes of open stream state on this packet thread
+static THREAD_LOCAL uint64_t s_stream_memory = 0;
+
+// bumped by hyperscan_setup() once a configuration's databases are built so
+// every database created for a configuration has the same generation
+static unsigned s_generation = 0;
+
+//-------------------------------------------------------------------------
+// stream state
+//-------------------------------------------------------------------------
+
+// streaming searches carry automaton state across reassembled flushes so
+// each byte of the stream is scanned once.  a flow may be searched by more
+// than one database (eg client and server port groups) so state is kept per
+// database and direction.  the database id is unique across reloads so a
+// stream opened against a stale database is never resumed with a new one.
+// a stream is only resumed by the flush that starts at next_seq; anything
+// else (a gap, an overlap, or a flush that was only partly searched) closes
+// it so matches never span bytes that were not adjacent.  stream state is
+// charged to the memcap and a search falls back to block mode without it.
+
+struct HyperscanStream
+{
+    unsigned db_id;
+    unsigned gen;
+    unsigned size;
+    hs_stream_t* hs[2];
+    unsigned long long base[2];
+    uint32_t next_seq[2];
+};
+
+class HyperscanFlowData : public FlowData
+{
+public:
+    HyperscanFlowData() : FlowData(flow_id) { }
+    ~HyperscanFlowData();
+
+    static void init()
+    { if ( !flow_id ) flow_id = FlowData::get_flow_id(); }
+
+    HyperscanStream& get_stream(unsigned db_id, unsigned gen, unsigned size);
+
+    static void close(HyperscanStream&, unsigned dir);
+    static unsigned flow_id;
+
+private:
+    static void close(HyperscanStream&);
+
+private:
+    std::vector<HyperscanStream> streams;
+};
+
+unsigned HyperscanFlowData::flow_id = 0;
+
+HyperscanFlowData::~HyperscanFlowData()
+{
+    for ( auto& st : streams )
+        close(st);
+}
+
+void HyperscanFlowData::close(HyperscanStream& st, unsigned dir)
+{
+    if ( !st.hs[dir] )
+        return;
+
+    // null scratch and callback; pending end of data matches are dropped
+    hs_close_stream(st.hs[dir], nullptr, nullptr, nullptr);
+    memory::MemoryCap::update_deallocations(st.size);
+    s_stream_memory -= st.size;
+    st.hs[dir] = nullptr;
+}
+
+void HyperscanFlowData::close(HyperscanStream& st)
+{
+    for ( unsigned i = 0; i < 2; ++i )
+        close(st, i);
+}
+
+HyperscanStream& HyperscanFlowData::get_stream(unsigned db_id, unsigned gen, unsigned size)
+{
+    for ( auto& st : streams )
+        if ( st.db_id == db_id )
+            return st;
+
+    // databases from before a reload are never searched again so their
+    // streams are closed now instead of lingering until the flow ends
+    for ( auto it = streams.begin(); it != streams.end(); )
+    {
+        if ( it->gen < gen )
+        {
+            close(*it);
+            it = streams.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    HyperscanStream st = { db_id, gen, size, { nullptr, nullptr }, { 0, 0 }, { 0, 0 } };
+    streams.push_back(st);
+    return streams.back();
+}
+
+//-------------------------------------------------------------------------
+// database cache
+//-------------------------------------------------------------------------
+
+// compiling large pattern sets dominates startup and reload time.  when
+// search_engine.cache_dir is set, each compiled database is serialized to
+// a file named by a hash of everything that went into the compile.  an
+// unchanged group is then mapped and deserialized instead of compiled.
+// hyperscan validates the platform and version of a serialized database so
+// a stale or foreign file just fails to load and is rebuilt.
+
+static uint64_t s_cache_hits = 0;
+static uint64_t s_cache_misses = 0;
+
+static uint64_t cache_hash(uint64_t h, const void* pv, size_t n)
+{
+    const uint8_t* p = (const uint8_t*)pv;
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;  // 64 bit FNV-1a prime
+    }
+    return h;
+}
+
+static std::string cache_file(const char* dir, uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/hs_%016llx.db", (unsigned long long)key);
+    return std::string(dir) + name;
+}
+
+static bool cache_load(const std::string& file, hs_database_t** db)
+{
+    int fd = open(file.c_str(), O_RDONLY);
+
+    if ( fd < 0 )
+        return false;
+
+    struct stat st;
+    bool ok = false;
+
+    if ( !fstat(fd, &st) and st.st_size > 0 )
+    {
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if ( p != MAP_FAILED )
+        {
+            ok = hs_deserialize_database((const char*)p, st.st_size, db) == HS_SUCCESS;
+            munmap(p, st.st_size);
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+// write to a unique temporary and rename so concurrent instances sharing
+// the directory never see a partial file.  this runs on the compile
+// threads so failure is returned for the main thread to log.
+static bool cache_save(const std::string& file, const hs_database_t* db)
+{
+    char* bytes = nullptr;
+    size_t len = 0;
+
+    if ( hs_serialize_database(db, &bytes, &len) != HS_SUCCESS )
+        return false;
+
+    std::string tmp = file + ".XXXXXX";
+    int fd = mkstemp(&tmp[0]);
+
+    if ( fd < 0 )
+    {
+        free(bytes);
+        return false;
+    }
+
+    bool ok = !fchmod(fd, 0644) and write(fd, bytes, len) == (ssize_t)len;
+    close(fd);
+    free(bytes);
+
+    if ( !ok or rename(tmp.c_str(), file.c_str()) )
+    {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
 //-------------------------------------------------------------------------
 // mpse
 //-------------------------------------------------------------------------
@@ -106,10 +305,13 @@ static hs_scratch_t* s_scratch = nullptr;
 class HyperscanMpse : public Mpse
 {
 public:
-    HyperscanMpse(SnortConfig*, bool use_gc, const MpseAgent* a)
-        : Mpse("hyperscan", use_gc)
+    HyperscanMpse(SnortConfig*, bool use_gc, const MpseAgent* a, bool stream)
+        : Mpse(stream ? "hyperscan_stream" : "hyperscan", use_gc)
     {
         agent = a;
+        stream_mode = stream;
+        db_id = ++databases;
+        gen = s_generation;
         ++instances;
     }
 
@@ -118,6 +320,9 @@ public:
         if ( hs_db )
             hs_free_database(hs_db);
 
+        if ( hs_sdb )
+            hs_free_database(hs_sdb);
+
         user_dtor();
     }
 
@@ -132,29 +337,55 @@ public:
     }
 
     int prep_patterns(SnortConfig*) override;
+    int prep_compile(SnortConfig*) override;
+    int prep_trees(SnortConfig*) override;
 
     int _search(const uint8_t*, int, MpseMatch, void*, int*) override;
 
+    int _search_stream(
+        Flow*, bool, uint32_t, const uint8_t*, int, MpseMatch, void*, int*) override;
+
     int get_pattern_count() override
     { return pvector.size(); }
 
+    uint64_t get_compile_key(SnortConfig*) override;
+
     int match(unsigned id, unsigned long long to);
 
     static int match(
         unsigned id, unsigned long long from, unsigned long long to,
         unsigned flags, void*);
 
+    static int stream_match(
+        unsigned id, unsigned long long from, unsigned long long to,
+        unsigned flags, void*);
+
 private:
     void user_ctor(SnortConfig*);
     void user_dtor();
+    int compile(unsigned mode, bool single, hs_database_t**, const char* cache_dir);
+    uint64_t get_cache_key(unsigned mode, bool single);
 
     const MpseAgent* agent;
     PatternVector pvector;
 
     hs_database_t* hs_db = nullptr;
+    hs_database_t* hs_sdb = nullptr;
+
+    bool stream_mode;
+    unsigned db_id;
+    unsigned gen;
+    size_t stream_size = 0;
+
+    unsigned cache_hits = 0;
+    unsigned cache_misses = 0;
+    std::string cache_failed;
 
     static THREAD_LOCAL MpseMatch match_cb;
     static THREAD_LOCAL void* match_ctx;
+    static THREAD_LOCAL unsigned long long match_base;
+
+    static unsigned databases;
 
 public:
     static uint64_t instances;
@@ -163,7 +394,9 @@ public:
 
 THREAD_LOCAL MpseMatch HyperscanMpse::match_cb = nullptr;
 THREAD_LOCAL void* HyperscanMpse::match_ctx = nullptr;
+THREAD_LOCAL unsigned long long HyperscanMpse::match_base = 0;
 
+unsigned HyperscanMpse::databases = 0;
 uint64_t HyperscanMpse::instances = 0;
 uint64_t HyperscanMpse::patterns = 0;
 
@@ -173,8 +406,13 @@ uint64_t HyperscanMpse::patterns = 0;
 // pattern is considered to be in a distinct match state.  the resulting
 // detection option trees for hyperscan are thus just single option chains.
 
+// SearchTool instances have no agent and only use the pattern's user data
+
 void HyperscanMpse::user_ctor(SnortConfig* sc)
 {
+    if ( !agent )
+        return;
+
     for ( auto& p : pvector )
     {
         if ( p.user )
@@ -190,6 +428,9 @@ void HyperscanMpse::user_ctor(SnortConfig* sc)
 
 void HyperscanMpse::user_dtor()
 {
+    if ( !agent )
+        return;
+
     for ( auto& p : pvector )
     {
         if ( p.user )
@@ -203,8 +444,55 @@ void HyperscanMpse::user_dtor()
     }
 }
 
-int HyperscanMpse::prep_patterns(SnortConfig* sc)
+// the key covers the library version, mode, and each expression with its
+// flags and id (the position in pvector)
+uint64_t HyperscanMpse::get_cache_key(unsigned mode, bool single)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;  // 64 bit FNV-1a offset basis
+    const char* ver = hs_version();
+
+    h = cache_hash(h, ver, strlen(ver));
+    h = cache_hash(h, &mode, sizeof(mode));
+    h = cache_hash(h, &single, sizeof(single));
+
+    for ( auto& p : pvector )
+    {
+        unsigned flags = single ? p.flags : (p.flags & ~HS_FLAG_SINGLEMATCH);
+        h = cache_hash(h, p.pat.c_str(), p.pat.size() + 1);
+        h = cache_hash(h, &flags, sizeof(flags));
+    }
+    return h;
+}
+
+// every cache file of this instance is named by a hash of the same pattern
+// set so that is what must not be compiled concurrently
+uint64_t HyperscanMpse::get_compile_key(SnortConfig* sc)
+{
+    if ( !sc or !sc->fast_pattern_config or !sc->fast_pattern_config->get_cache_dir() )
+        return 0;
+
+    return get_cache_key(HS_MODE_STREAM, false);
+}
+
+// this may run on any thread so errors are returned rather than logged and
+// shared scratch is allocated later by prep_trees()
+int HyperscanMpse::compile(
+    unsigned mode, bool single, hs_database_t** db, const char* cache_dir)
 {
+    std::string file;
+
+    if ( cache_dir )
+    {
+        file = cache_file(cache_dir, get_cache_key(mode, single));
+
+        if ( cache_load(file, db) )
+        {
+            ++cache_hits;
+            return 0;
+        }
+        ++cache_misses;
+    }
+
     hs_compile_error_t* errptr = nullptr;
     std::vector<const char*> pats;
     std::vector<unsigned> flags;
@@ -215,29 +503,85 @@ int HyperscanMpse::prep_patterns(SnortConfig* sc)
     for ( auto& p : pvector )
     {
         pats.push_back(p.pat.c_str());
-        flags.push_back(p.flags);
+        flags.push_back(single ? p.flags : (p.flags & ~HS_FLAG_SINGLEMATCH));
         ids.push_back(id++);
     }
 
-    if ( hs_compile_multi(&pats[0], &flags[0], &ids[0], pvector.size(), HS_MODE_BLOCK,
-            nullptr, &hs_db, &errptr) or !hs_db )
+    if ( hs_compile_multi(&pats[0], &flags[0], &ids[0], pvector.size(), mode,
+            nullptr, db, &errptr) or !*db )
     {
         // FIXIT-L emit data from errptr
-        ParseError("can't compile pattern database '%s'", "hs_compile_multi");
         hs_free_compile_error(errptr);
         return -1;
     }
 
-    if ( hs_error_t err = hs_alloc_scratch(hs_db, &s_scratch) )
+    if ( !file.empty() and !cache_save(file, *db) )
+        cache_failed = file;
+
+    return 0;
+}
+
+int HyperscanMpse::prep_compile(SnortConfig* sc)
+{
+    const char* cache_dir = (sc and sc->fast_pattern_config) ?
+        sc->fast_pattern_config->get_cache_dir() : nullptr;
+
+    // rule databases only need the first hit of each pattern.  SearchTool
+    // databases (no agent) report every hit like ac_full since users such as
+    // AppId check each hit's offset and count repeats.
+    if ( int err = compile(HS_MODE_BLOCK, agent != nullptr, &hs_db, cache_dir) )
+        return err;
+
+    // single match is per stream, not per flush, so the stream database
+    // reports every match and the detection stash drops the duplicates
+    if ( stream_mode )
+    {
+        if ( int err = compile(HS_MODE_STREAM, false, &hs_sdb, cache_dir) )
+            return err;
+
+        hs_stream_size(hs_sdb, &stream_size);
+    }
+    return 0;
+}
+
+// grow the prototype scratch to fit each database
+int HyperscanMpse::prep_trees(SnortConfig* sc)
+{
+    s_cache_hits += cache_hits;
+    s_cache_misses += cache_misses;
+
+    if ( !cache_failed.empty() )
+    {
+        WarningMessage("can't write search engine cache %s\n", cache_failed.c_str());
+        cache_failed.clear();
+    }
+
+    for ( auto db : { hs_db, hs_sdb } )
     {
-        ParseError("can't allocate search scratch space (%d)", err);
-        return -2;
+        if ( !db )
+            continue;
+
+        if ( hs_error_t err = hs_alloc_scratch(db, &s_scratch) )
+        {
+            ParseError("can't allocate search scratch space (%d)", err);
+            return -2;
+        }
     }
 
     user_ctor(sc);
     return 0;
 }
 
+int HyperscanMpse::prep_patterns(SnortConfig* sc)
+{
+    if ( int err = prep_compile(sc) )
+    {
+        ParseError("can't compile pattern database '%s'", "hs_compile_multi");
+        return err;
+    }
+    return prep_trees(sc);
+}
+
 int HyperscanMpse::match(unsigned id, unsigned long long to)
 {
     assert(id < pvector.size());
@@ -253,6 +597,20 @@ int HyperscanMpse::match(
     return  h->match(id, to);
 }
 
+// stream offsets are relative to the start of the flow so they must be
+// rebased to the current buffer.  matches which started in a prior flush
+// are still reported with the end index in the current buffer.  rule
+// options are only evaluated against the current buffer though, so such a
+// match can only alert if the rule does not check the fast pattern content
+// again (eg fast_pattern:only); otherwise the content option fails.
+int HyperscanMpse::stream_match(
+    unsigned id, unsigned long long /*from*/, unsigned long long to,
+    unsigned /*flags*/, void* pv)
+{
+    HyperscanMpse* h = (HyperscanMpse*)pv;
+    return h->match(id, to - match_base);
+}
+
 int HyperscanMpse::_search(
     const uint8_t* buf, int n, MpseMatch mf, void* pv, int* current_state)
 {
@@ -272,12 +630,76 @@ int HyperscanMpse::_search(
     return 0;
 }
 
+int HyperscanMpse::_search_stream(
+    Flow* flow, bool to_server, uint32_t seq, const uint8_t* buf, int n, MpseMatch mf,
+    void* pv, int* current_state)
+{
+    if ( !hs_sdb )
+        return _search(buf, n, mf, pv, current_state);
+
+    *current_state = 0;
+
+    HyperscanFlowData* fd =
+        (HyperscanFlowData*)flow->get_flow_data(HyperscanFlowData::flow_id);
+
+    if ( !fd )
+    {
+        fd = new HyperscanFlowData;
+        flow->set_flow_data(fd);
+    }
+
+    HyperscanStream& st = fd->get_stream(db_id, gen, stream_size);
+    unsigned dir = to_server ? 1 : 0;
+
+    if ( st.hs[dir] and seq != st.next_seq[dir] )
+    {
+        HyperscanFlowData::close(st, dir);
+        pc.stream_restarts++;
+    }
+
+    if ( !st.hs[dir] )
+    {
+        if ( !memory::MemoryCap::free_space(stream_size) or
+            hs_open_stream(hs_sdb, 0, &st.hs[dir]) != HS_SUCCESS )
+        {
+            st.hs[dir] = nullptr;
+            return _search(buf, n, mf, pv, current_state);
+        }
+
+        memory::MemoryCap::update_allocations(stream_size);
+        s_stream_memory += stream_size;
+        st.base[dir] = 0;
+
+        // a peak for this thread; pc_accum() keeps the max over threads
+        if ( s_stream_memory > pc.stream_memory )
+            pc.stream_memory = s_stream_memory;
+    }
+    else
+        pc.stream_searches++;
+
+    match_cb = mf;
+    match_ctx = pv;
+    match_base = st.base[dir];
+
+    SnortState* ss = snort_conf->state + get_instance_id();
+    assert(ss->hyperscan_scratch);
+
+    hs_scan_stream(st.hs[dir], (const char*)buf, n, 0,
+        (hs_scratch_t*)ss->hyperscan_scratch, HyperscanMpse::stream_match, this);
+
+    st.base[dir] += n;
+    st.next_seq[dir] = seq + n;
+    return 0;
+}
+
 //-------------------------------------------------------------------------
 // public methods
 //-------------------------------------------------------------------------
 
 void hyperscan_setup(SnortConfig* sc)
 {
+    ++s_generation;
+
     for ( unsigned i = 0; i < sc->num_slots; ++i )
     {
         SnortState* ss = sc->state + i;
@@ -315,7 +737,13 @@ void hyperscan_cleanup(SnortConfig* sc)
 static Mpse* hs_ctor(
     SnortConfig* sc, class Module*, bool use_gc, const MpseAgent* a)
 {
-    return new HyperscanMpse(sc, use_gc, a);
+    return new HyperscanMpse(sc, use_gc, a, false);
+}
+
+static Mpse* hs_stream_ctor(
+    SnortConfig* sc, class Module*, bool use_gc, const MpseAgent* a)
+{
+    return new HyperscanMpse(sc, use_gc, a, true);
 }
 
 static void hs_dtor(Mpse* p)
@@ -327,12 +755,21 @@ static void hs_init()
 {
     HyperscanMpse::instances = 0;
     HyperscanMpse::patterns = 0;
+    s_cache_hits = s_cache_misses = 0;
+}
+
+static void hs_stream_init()
+{
+    hs_init();
+    HyperscanFlowData::init();
 }
 
 static void hs_print()
 {
     LogCount("instances", HyperscanMpse::instances);
     LogCount("patterns", HyperscanMpse::patterns);
+    LogCount("cache hits", s_cache_hits);
+    LogCount("cache misses", s_cache_misses);
 }
 
 static const MpseApi hs_api =
@@ -360,13 +797,40 @@ static const MpseApi hs_api =
     hs_print,
 };
 
+static const MpseApi hs_stream_api =
+{
+    {
+        PT_SEARCH_ENGINE,
+        sizeof(MpseApi),
+        SEAPI_VERSION,
+        0,
+        API_RESERVED,
+        API_OPTIONS,
+        "hyperscan_stream",
+        "hyperscan mpse which scans reassembled tcp payload as a stream",
+        nullptr,
+        nullptr
+    },
+    false,
+    nullptr,  // activate
+    nullptr,  // setup
+    nullptr,  // start
+    nullptr,  // stop
+    hs_stream_ctor,
+    hs_dtor,
+    hs_stream_init,
+    hs_print,
+};
+
 //#ifdef BUILDING_SO
 //SO_PUBLIC const BaseApi* snort_plugins[] =
 //{
 //    &hs_api.base,
+//    &hs_stream_api.base,
 //    nullptr
 //};
 //#else
 const BaseApi* se_hyperscan = &hs_api.base;
+const BaseApi* se_hyperscan_stream = &hs_stream_api.base;
 //#endif
 
@@ -32,11 +32,13 @@ extern const BaseApi* se_intel_cpm;
 
 #ifdef HAVE_HYPERSCAN
 extern const BaseApi* se_hyperscan;
+extern const BaseApi* se_hyperscan_stream;
 #endif
 
 #ifdef STATIC_SEARCH_ENGINES
 extern const BaseApi* se_ac_banded;
 extern const BaseApi* se_ac_full;
+extern const BaseApi* se_ac_packed;
 extern const BaseApi* se_ac_sparse;
 extern const BaseApi* se_ac_sparse_bands;
 extern const BaseApi* se_ac_std;
@@ -52,11 +54,13 @@ const BaseApi* search_engines[] =
 
 #ifdef HAVE_HYPERSCAN
     se_hyperscan,
+    se_hyperscan_stream,
 #endif
 
 #ifdef STATIC_SEARCH_ENGINES
     se_ac_banded,
     se_ac_full,
+    se_ac_packed,
     se_ac_sparse,
     se_ac_sparse_bands,
     se_ac_std,
@@ -59,7 +59,8 @@ void SearchTool::add(const uint8_t* pat, unsigned len, int id, bool no_case)
 
 void SearchTool::add(const uint8_t* pat, unsigned len, void* id, bool no_case)
 {
-    Mpse::PatternDescriptor desc(no_case);
+    // tools search for plain strings so engines that take regex must escape them
+    Mpse::PatternDescriptor desc(no_case, false, true);
 
     if ( mpse )
         mpse->add_pattern(nullptr,  pat, len, desc, id);
@@ -22,9 +22,12 @@
 
 #include <string.h>
 
+#include "flow/flow.h"
 #include "framework/base_api.h"
 #include "framework/mpse.h"
 #include "main/snort_config.h"
+#include "memory/memory_cap.h"
+#include "utils/stats.h"
 
 // must appear after snort_config.h to avoid broken c++ map include
 #include <CppUTest/CommandLineTestRunner.h>
@@ -43,6 +46,16 @@ int Mpse::search(
     return _search(T, n, match, context, current_state);
 }
 
+int Mpse::search_stream(
+    Flow* flow, bool to_server, uint32_t seq, const unsigned char* T, int n,
+    MpseMatch match, void* context, int* current_state)
+{
+    if ( !flow )
+        return _search(T, n, match, context, current_state);
+
+    return _search_stream(flow, to_server, seq, T, n, match, context, current_state);
+}
+
 int Mpse::search_all(
     const unsigned char* T, int n, MpseMatch match,
     void* context, int* current_state)
@@ -50,6 +63,21 @@ int Mpse::search_all(
     return _search(T, n, match, context, current_state);
 }
 
+void Mpse::search_batch(MpseBatchItem* items, unsigned count, MpseMatch match)
+{
+    if ( count )
+        items[0].so->_search_batch(items, count, match);
+}
+
+void Mpse::_search_batch(MpseBatchItem* items, unsigned count, MpseMatch match)
+{
+    for ( unsigned i = 0; i < count; ++i )
+    {
+        int state = 0;
+        items[i].so->_search(items[i].buf, items[i].len, match, items[i].context, &state);
+    }
+}
+
 uint64_t Mpse::get_pattern_byte_count()
 { return 0; }
 
@@ -115,6 +143,39 @@ static MpseAgent s_agent =
     [](void** ppl) { CHECK(*ppl == s_list); }
 };
 
+THREAD_LOCAL PacketCount pc;
+
+static size_t s_mem_cap = 0;
+static size_t s_mem_used = 0;
+
+bool memory::MemoryCap::free_space(size_t n)
+{ return !s_mem_cap or s_mem_used + n <= s_mem_cap; }
+
+void memory::MemoryCap::update_allocations(size_t n)
+{ s_mem_used += n; }
+
+void memory::MemoryCap::update_deallocations(size_t n)
+{ s_mem_used -= n; }
+
+// a single flow data slot is all the stream tests need
+static FlowData* s_flow_data = nullptr;
+
+unsigned FlowData::flow_id = 0;
+
+FlowData::FlowData(unsigned u, Inspector*)
+{ id = u; handler = nullptr; prev = next = nullptr; }
+
+FlowData::~FlowData() { }
+
+Flow::Flow() { }
+Flow::~Flow() { }
+
+FlowData* Flow::get_flow_data(unsigned id)
+{ return (s_flow_data and s_flow_data->get_id() == id) ? s_flow_data : nullptr; }
+
+int Flow::set_flow_data(FlowData* fd)
+{ s_flow_data = fd; return 0; }
+
 FileIdentifier::~FileIdentifier() { }
 
 FileVerdict FilePolicy::type_lookup(Flow*, FileContext*)
@@ -369,6 +430,189 @@ TEST(mpse_hs_multi, single)
     CHECK(hits == 1);
 }
 
+//-------------------------------------------------------------------------
+// stream tests
+//-------------------------------------------------------------------------
+
+extern const BaseApi* se_hyperscan_stream;
+
+TEST_GROUP(mpse_hs_stream)
+{
+    Mpse* hs = nullptr;
+    const MpseApi* mpse_api = (MpseApi*)se_hyperscan_stream;
+
+    void setup()
+    {
+        // FIXIT-L cpputest hangs or crashes in the leak detector
+        MemoryLeakWarningPlugin::turnOffNewDeleteOverloads();
+        CHECK(se_hyperscan_stream);
+        mpse_api->init();
+        hs = mpse_api->ctor(snort_conf, nullptr, false, &s_agent);
+        CHECK(hs);
+        hits = 0;
+        parse_errors = 0;
+        memset(&pc, 0, sizeof(pc));
+        s_mem_cap = s_mem_used = 0;
+    }
+    void teardown()
+    {
+        delete s_flow_data;
+        s_flow_data = nullptr;
+        CHECK(s_mem_used == 0);
+        mpse_api->dtor(hs);
+        hyperscan_cleanup(snort_conf);
+        MemoryLeakWarningPlugin::turnOnNewDeleteOverloads();
+    }
+};
+
+TEST(mpse_hs_stream, base)
+{
+    CHECK(!strcmp(se_hyperscan_stream->name, "hyperscan_stream"));
+    CHECK(!strcmp(hs->get_method(), "hyperscan_stream"));
+}
+
+TEST(mpse_hs_stream, straddle)
+{
+    Mpse::PatternDescriptor desc;
+
+    CHECK(hs->add_pattern(nullptr, (uint8_t*)"foobar", 6, desc, s_user) == 0);
+    CHECK(hs->prep_patterns(snort_conf) == 0);
+    hyperscan_setup(snort_conf);
+
+    Flow flow;
+    int state = 0;
+
+    CHECK(hs->search_stream(&flow, true, 100, (uint8_t*)"xxfoo", 5, match, nullptr, &state) == 0);
+    CHECK(hits == 0);
+    CHECK(s_flow_data);
+    CHECK(pc.stream_memory > 0);
+    CHECK(s_mem_used == pc.stream_memory);
+
+    CHECK(hs->search_stream(&flow, true, 105, (uint8_t*)"barxx", 5, match, nullptr, &state) == 0);
+    CHECK(hits == 1);
+    CHECK(pc.stream_searches == 1);
+
+    // the other direction has its own stream
+    CHECK(hs->search_stream(&flow, false, 105, (uint8_t*)"barxx", 5, match, nullptr, &state) == 0);
+    CHECK(hits == 1);
+}
+
+TEST(mpse_hs_stream, repeat)
+{
+    Mpse::PatternDescriptor desc;
+
+    CHECK(hs->add_pattern(nullptr, (uint8_t*)"foo", 3, desc, s_user) == 0);
+    CHECK(hs->prep_patterns(snort_conf) == 0);
+    hyperscan_setup(snort_conf);
+
+    Flow flow;
+    int state = 0;
+
+    CHECK(hs->search_stream(&flow, true, 0, (uint8_t*)"foo", 3, match, nullptr, &state) == 0);
+    CHECK(hs->search_stream(&flow, true, 3, (uint8_t*)"foo", 3, match, nullptr, &state) == 0);
+    CHECK(hits == 2);
+}
+
+TEST(mpse_hs_stream, gap)
+{
+    Mpse::PatternDescriptor desc;
+
+    CHECK(hs->add_pattern(nullptr, (uint8_t*)"foobar", 6, desc, s_user) == 0);
+    CHECK(hs->prep_patterns(snort_conf) == 0);
+    hyperscan_setup(snort_conf);
+
+    Flow flow;
+    int state = 0;
+
+    // the second flush does not follow the first so they are not joined
+    CHECK(hs->search_stream(&flow, true, 100, (uint8_t*)"xxfoo", 5, match, nullptr, &state) == 0);
+    CHECK(hs->search_stream(&flow, true, 110, (uint8_t*)"barxx", 5, match, nullptr, &state) == 0);
+    CHECK(hits == 0);
+    CHECK(pc.stream_restarts == 1);
+    CHECK(pc.stream_searches == 0);
+
+    // nor is a retransmission or an overlap
+    CHECK(hs->search_stream(&flow, true, 120, (uint8_t*)"xxfoo", 5, match, nullptr, &state) == 0);
+    CHECK(hs->search_stream(&flow, true, 120, (uint8_t*)"xxfoo", 5, match, nullptr, &state) == 0);
+    CHECK(hs->search_stream(&flow, true, 122, (uint8_t*)"foobar", 6, match, nullptr, &state) == 0);
+    CHECK(hits == 1);
+    CHECK(pc.stream_restarts == 4);
+
+    // but the restarted stream resumes from there
+    CHECK(hs->search_stream(&flow, true, 128, (uint8_t*)"xfoo", 4, match, nullptr, &state) == 0);
+    CHECK(hs->search_stream(&flow, true, 132, (uint8_t*)"bar", 3, match, nullptr, &state) == 0);
+    CHECK(hits == 2);
+    CHECK(pc.stream_searches == 2);
+}
+
+TEST(mpse_hs_stream, memcap)
+{
+    Mpse::PatternDescriptor desc;
+
+    CHECK(hs->add_pattern(nullptr, (uint8_t*)"foobar", 6, desc, s_user) == 0);
+    CHECK(hs->prep_patterns(snort_conf) == 0);
+    hyperscan_setup(snort_conf);
+
+    Flow flow;
+    int state = 0;
+
+    // no room for stream state so each flush is searched on its own
+    s_mem_cap = 1;
+    CHECK(hs->search_stream(&flow, true, 100, (uint8_t*)"xxfoo", 5, match, nullptr, &state) == 0);
+    CHECK(hs->search_stream(&flow, true, 105, (uint8_t*)"barxx", 5, match, nullptr, &state) == 0);
+    CHECK(hits == 0);
+    CHECK(pc.stream_memory == 0);
+    CHECK(s_mem_used == 0);
+}
+
+TEST(mpse_hs_stream, reload)
+{
+    Mpse::PatternDescriptor desc;
+
+    CHECK(hs->add_pattern(nullptr, (uint8_t*)"foo", 3, desc, s_user) == 0);
+    CHECK(hs->prep_patterns(snort_conf) == 0);
+    hyperscan_setup(snort_conf);
+
+    // a database built for the next configuration.  both share the test
+    // config's scratch here so it is regrown to fit the first one too.
+    hyperscan_cleanup(snort_conf);
+    Mpse* hs2 = mpse_api->ctor(snort_conf, nullptr, false, &s_agent);
+    CHECK(hs2->add_pattern(nullptr, (uint8_t*)"bar", 3, desc, s_user) == 0);
+    CHECK(hs2->prep_patterns(snort_conf) == 0);
+    CHECK(hs->prep_trees(snort_conf) == 0);
+    hyperscan_setup(snort_conf);
+
+    Flow flow;
+    int state = 0;
+
+    CHECK(hs->search_stream(&flow, true, 0, (uint8_t*)"foo", 3, match, nullptr, &state) == 0);
+    CHECK(hs2->search_stream(&flow, true, 0, (uint8_t*)"bar", 3, match, nullptr, &state) == 0);
+    CHECK(hits == 2);
+
+    // opening the new stream closed the old one so this starts over
+    CHECK(hs->search_stream(&flow, true, 3, (uint8_t*)"foo", 3, match, nullptr, &state) == 0);
+    CHECK(hits == 3);
+    CHECK(pc.stream_searches == 0);
+
+    delete s_flow_data;
+    s_flow_data = nullptr;
+    mpse_api->dtor(hs2);
+}
+
+TEST(mpse_hs_stream, no_flow)
+{
+    Mpse::PatternDescriptor desc;
+
+    CHECK(hs->add_pattern(nullptr, (uint8_t*)"foo", 3, desc, s_user) == 0);
+    CHECK(hs->prep_patterns(snort_conf) == 0);
+    hyperscan_setup(snort_conf);
+
+    int state = 0;
+    CHECK(hs->search_stream(nullptr, true, 0, (uint8_t*)"foo", 3, match, nullptr, &state) == 0);
+    CHECK(hits == 1);
+    CHECK(!s_flow_data);
+}
+
 //-------------------------------------------------------------------------
 // main
 //-------------------------------------------------------------------------
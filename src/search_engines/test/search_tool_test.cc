@@ -151,6 +151,15 @@ int Mpse::search_all(
     return _search(T, n, match, context, current_state);
 }
 
+void Mpse::search_batch(MpseBatchItem* items, unsigned count, MpseMatch match)
+{
+    if ( count )
+        items[0].so->_search_batch(items, count, match);
+}
+
+void Mpse::_search_batch(MpseBatchItem*, unsigned, MpseMatch)
+{ }
+
 uint64_t Mpse::get_pattern_byte_count()
 { return 0; }
 
@@ -235,6 +244,134 @@ TEST(search_tool_tests, search_all_ac_full)
     delete stool;
 }
 
+//-------------------------------------------------------------------------
+// batch tests
+//-------------------------------------------------------------------------
+
+static int batch_hits[3];
+
+static int batch_match(void*, void*, int, void* context, void*)
+{
+    ++batch_hits[(long)context];
+    return 0;
+}
+
+TEST_GROUP(search_batch_tests)
+{
+    Mpse* m1 = nullptr;
+    Mpse* m2 = nullptr;
+
+    void setup()
+    {
+        CHECK(se_ac_full);
+        mpse_api->init();
+        m1 = mpse_api->ctor(nullptr, nullptr, false, &s_agent);
+        m2 = mpse_api->ctor(nullptr, nullptr, false, &s_agent);
+        memset(batch_hits, 0, sizeof(batch_hits));
+    }
+    void teardown()
+    {
+        mpse_api->dtor(m1);
+        mpse_api->dtor(m2);
+    }
+};
+
+TEST(search_batch_tests, ac_full)
+{
+    Mpse::PatternDescriptor desc;
+
+    m1->add_pattern(nullptr, (const uint8_t*)"tuba", 4, desc, nullptr);
+    m1->add_pattern(nullptr, (const uint8_t*)"away", 4, desc, nullptr);
+    m1->prep_patterns(nullptr);
+
+    m2->add_pattern(nullptr, (const uint8_t*)"ran", 3, desc, nullptr);
+    m2->prep_patterns(nullptr);
+
+    const char* s1 = "the tuba ran away";
+    const char* s2 = "it ran and ran";
+    const char* s3 = "nothing";
+
+    MpseBatchItem items[] =
+    {
+        { m1, (const uint8_t*)s1, (int)strlen(s1), (void*)0, nullptr, false },
+        { m2, (const uint8_t*)s2, (int)strlen(s2), (void*)1, nullptr, false },
+        { m2, (const uint8_t*)s3, (int)strlen(s3), (void*)2, nullptr, false },
+    };
+
+    Mpse::search_batch(items, 3, batch_match);
+
+    // the same as searching each buffer individually
+    CHECK(batch_hits[0] == 2);
+    CHECK(batch_hits[1] == 2);
+    CHECK(batch_hits[2] == 0);
+}
+
+// long enough to be split across simd lanes where supported
+TEST(search_batch_tests, ac_full_split)
+{
+    Mpse::PatternDescriptor desc;
+
+    m1->set_opt(1);
+    m1->add_pattern(nullptr, (const uint8_t*)"tuba", 4, desc, nullptr);
+    m1->add_pattern(nullptr, (const uint8_t*)"ran", 3, desc, nullptr);
+    m1->prep_patterns(nullptr);
+
+    uint8_t buf[4000];
+
+    for ( unsigned i = 0; i < sizeof(buf); ++i )
+        buf[i] = "the tuba ran away "[i % 18];
+
+    int state = 0;
+    m1->search(buf, sizeof(buf), batch_match, (void*)0, &state);
+
+    MpseBatchItem item = { m1, buf, (int)sizeof(buf), (void*)1, nullptr, false };
+    Mpse::search_batch(&item, 1, batch_match);
+
+    CHECK(batch_hits[0] > 0);
+    CHECK(batch_hits[0] == batch_hits[1]);
+}
+
+extern const BaseApi* se_ac_packed;
+
+// the packed format must find exactly what the full format finds
+TEST(search_batch_tests, ac_packed)
+{
+    const MpseApi* papi = (MpseApi*)se_ac_packed;
+    CHECK(papi);
+
+    Mpse* mp = papi->ctor(nullptr, nullptr, false, &s_agent);
+    CHECK(mp);
+
+    Mpse::PatternDescriptor desc;
+    Mpse::PatternDescriptor nocase(true);
+    const char* pats[] = { "tuba", "ran", "AWAY", "a\xffb" };
+
+    for ( auto pat : pats )
+    {
+        m1->add_pattern(nullptr, (const uint8_t*)pat, strlen(pat), nocase, nullptr);
+        mp->add_pattern(nullptr, (const uint8_t*)pat, strlen(pat), nocase, nullptr);
+    }
+    m1->add_pattern(nullptr, (const uint8_t*)"Run", 3, desc, nullptr);
+    mp->add_pattern(nullptr, (const uint8_t*)"Run", 3, desc, nullptr);
+
+    m1->set_opt(1);
+    m1->prep_patterns(nullptr);
+    mp->prep_patterns(nullptr);
+
+    const char* s = "The Tuba RAN away. Run, run! a\xffb A\xffB";
+    int state = 0;
+
+    m1->search((const uint8_t*)s, strlen(s), batch_match, (void*)0, &state);
+    state = 0;
+    mp->search((const uint8_t*)s, strlen(s), batch_match, (void*)1, &state);
+
+    // case is checked by the rule tree so Run also matches run
+    CHECK(batch_hits[0] == 7);
+    CHECK(batch_hits[0] == batch_hits[1]);
+
+    papi->dtor(mp);
+}
+
 //-------------------------------------------------------------------------
 // main
 //-------------------------------------------------------------------------
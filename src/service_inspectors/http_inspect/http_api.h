@@ -24,6 +24,7 @@
 #include "framework/module.h"
 #include "framework/inspector.h"
 
+#include "http_char_class.h"
 #include "http_module.h"
 #include "http_flow_data.h"
 
@@ -39,7 +40,7 @@ private:
     static void http_mod_dtor(Module* m) { delete m; }
     static const char* http_my_name;
     static const char* http_help;
-    static void http_init() { HttpFlowData::init(); }
+    static void http_init() { HttpFlowData::init(); CharClass::init(); }
     static void http_term() { }
     static Inspector* http_ctor(Module* mod);
     static void http_dtor(Inspector* p) { delete p; }
@@ -0,0 +1,121 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http_arena.cc
+
+#include "http_arena.h"
+
+#include "utils/util.h"
+
+#include "http_enum.h"
+#include "http_module.h"
+
+using namespace HttpEnums;
+
+THREAD_LOCAL HttpArena::Block* HttpArena::block_cache[NUM_BLOCK_CLASSES] = { };
+THREAD_LOCAL unsigned HttpArena::num_cached[NUM_BLOCK_CLASSES] = { };
+
+uint8_t* HttpArena::alloc_slow(uint32_t size)
+{
+    // Each block is at least twice the size of the previous one and large enough for the request
+    unsigned block_class = next_class;
+    while ((block_class < NUM_BLOCK_CLASSES) && (block_data_size(block_class) < size))
+        block_class++;
+
+    Block* block;
+    if (block_class == OVERSIZE)
+    {
+        // Oversize requests get a private block that is freed on reset. It goes behind the
+        // current block so that the space remaining there is not abandoned.
+        HttpModule::increment_peg_counts(PEG_ARENA_OVERFLOW);
+        block = (Block*)snort_alloc(sizeof(Block) + size);
+        block->size = size;
+        capacity += sizeof(Block) + size;
+        if (head != nullptr)
+        {
+            block->next = head->next;
+            head->next = block;
+        }
+        else
+        {
+            block->next = nullptr;
+            head = block;
+        }
+    }
+    else
+    {
+        if (block_cache[block_class] != nullptr)
+        {
+            block = block_cache[block_class];
+            block_cache[block_class] = block->next;
+            num_cached[block_class]--;
+        }
+        else
+            block = (Block*)snort_alloc(block_size(block_class));
+        block->size = block_data_size(block_class);
+        block->next = head;
+        head = block;
+        capacity += block_size(block_class);
+        next_class = (block_class + 1 < NUM_BLOCK_CLASSES) ? block_class + 1 : block_class;
+    }
+
+    block->block_class = block_class;
+    block->used = size;
+    footprint += size;
+    return block->data();
+}
+
+void HttpArena::reset()
+{
+    if (head == nullptr)
+        return;
+
+    if (footprint > HttpModule::get_peg_count(PEG_ARENA_HIGH_WATER))
+        HttpModule::set_peg_count(PEG_ARENA_HIGH_WATER, footprint);
+
+    while (head != nullptr)
+    {
+        Block* const block = head;
+        head = block->next;
+        const unsigned block_class = block->block_class;
+        if ((block_class != OVERSIZE) && (num_cached[block_class] < MAX_CACHED_BLOCKS))
+        {
+            block->next = block_cache[block_class];
+            block_cache[block_class] = block;
+            num_cached[block_class]++;
+        }
+        else
+            snort_free(block);
+    }
+    footprint = 0;
+    capacity = 0;
+    next_class = 0;
+}
+
+void HttpArena::term()
+{
+    for (unsigned k = 0; k < NUM_BLOCK_CLASSES; k++)
+    {
+        while (block_cache[k] != nullptr)
+        {
+            Block* const block = block_cache[k];
+            block_cache[k] = block->next;
+            snort_free(block);
+        }
+        num_cached[k] = 0;
+    }
+}
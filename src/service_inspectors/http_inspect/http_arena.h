@@ -0,0 +1,125 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http_arena.h
+
+#ifndef HTTP_ARENA_H
+#define HTTP_ARENA_H
+
+#include <stdint.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "main/thread.h"
+
+//-------------------------------------------------------------------------
+// HttpArena class
+// Bump-pointer allocator for the just-in-time work products of a single message section.
+// Nothing allocated here is freed individually. Everything is released together when the arena
+// is reset, which normally happens when the owning message section is destroyed. Blocks start
+// small and double in size up to a limit so that a section which needs little memory holds
+// little. Standard size blocks are recycled through a small per-thread cache so that a busy
+// packet thread rarely calls malloc() or free() for HTTP processing.
+//-------------------------------------------------------------------------
+
+class HttpArena
+{
+public:
+    HttpArena() = default;
+    ~HttpArena() { reset(); }
+    HttpArena(const HttpArena&) = delete;
+    HttpArena& operator=(const HttpArena&) = delete;
+
+    // Returns uninitialized memory aligned for any of the work product types
+    uint8_t* alloc(uint32_t size)
+    {
+        size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        if ((head != nullptr) && (head->size - head->used >= size))
+        {
+            uint8_t* const ptr = head->data() + head->used;
+            head->used += size;
+            footprint += size;
+            return ptr;
+        }
+        return alloc_slow(size);
+    }
+
+    // Arena objects are never destroyed so only trivially destructible types may be placed here
+    template<typename T> T* alloc_array(uint32_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value,
+            "arena objects are not destroyed");
+        T* const array = reinterpret_cast<T*>(alloc(count * sizeof(T)));
+        for (uint32_t k=0; k < count; k++)
+            new (array + k) T;
+        return array;
+    }
+
+    template<typename T, typename... Args> T* create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value,
+            "arena objects are not destroyed");
+        return new (alloc(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Release everything allocated so far
+    void reset();
+
+    uint32_t get_footprint() const { return footprint; }
+
+    // Total size of the blocks currently held
+    uint32_t get_capacity() const { return capacity; }
+
+    // Free the blocks cached by the current packet thread
+    static void term();
+
+private:
+    struct Block
+    {
+        Block* next;
+        uint32_t size;
+        uint32_t used;
+        unsigned block_class;
+        uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    static const uint32_t ALIGNMENT = 8;
+
+    // Standard blocks are MIN_BLOCK_SIZE << block_class bytes including the Block header
+    static const unsigned NUM_BLOCK_CLASSES = 6;
+    static const uint32_t MIN_BLOCK_SIZE = 256;
+    static const unsigned MAX_CACHED_BLOCKS = 16;
+    static const unsigned OVERSIZE = NUM_BLOCK_CLASSES;
+
+    static uint32_t block_size(unsigned block_class) { return MIN_BLOCK_SIZE << block_class; }
+    static uint32_t block_data_size(unsigned block_class)
+        { return block_size(block_class) - sizeof(Block); }
+
+    uint8_t* alloc_slow(uint32_t size);
+
+    Block* head = nullptr;
+    uint32_t footprint = 0;
+    uint32_t capacity = 0;
+    unsigned next_class = 0;
+
+    static THREAD_LOCAL Block* block_cache[NUM_BLOCK_CLASSES];
+    static THREAD_LOCAL unsigned num_cached[NUM_BLOCK_CLASSES];
+};
+
+#endif
+
@@ -0,0 +1,183 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http_char_class.cc
+
+#include "http_char_class.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HTTP_SIMD
+#endif
+
+CharClass::SearchFunc* CharClass::search = CharClass::find_first_scalar;
+
+typedef void (LowerFunc)(const uint8_t*, int32_t, uint8_t*);
+static LowerFunc* lower = copy_to_lower_scalar;
+
+CharClass::CharClass(const char* members)
+{
+    for (; *members != '\0'; members++)
+        add((uint8_t)*members);
+}
+
+void CharClass::clear()
+{
+    memset(table, 0, sizeof(table));
+}
+
+int32_t CharClass::find_first_scalar(const CharClass& cc, const uint8_t* buf, int32_t length)
+{
+    int32_t k = 0;
+    for (; (k < length) && !cc.contains(buf[k]); k++);
+    return k;
+}
+
+void copy_to_lower_scalar(const uint8_t* in_buf, int32_t length, uint8_t* out_buf)
+{
+    for (int32_t k = 0; k < length; k++)
+    {
+        out_buf[k] = ((in_buf[k] < 'A') || (in_buf[k] > 'Z')) ? in_buf[k] : in_buf[k] - ('A' -
+            'a');
+    }
+}
+
+void copy_to_lower(const uint8_t* in_buf, int32_t length, uint8_t* out_buf)
+{
+    lower(in_buf, length, out_buf);
+}
+
+#ifdef HTTP_SIMD
+
+// The low nibble of each octet selects an entry from both tables with a byte shuffle. The top bit
+// of the octet picks which table applies and the remaining three bits of the high nibble select a
+// bit within the entry. An octet is a member when that bit is set.
+struct CharClassSimd
+{
+    __attribute__((target("sse4.2")))
+    static int32_t find_first_sse42(const CharClass& cc, const uint8_t* buf, int32_t length)
+    {
+        const __m128i low_table = _mm_load_si128((const __m128i*)cc.table[0]);
+        const __m128i high_table = _mm_load_si128((const __m128i*)cc.table[1]);
+        const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+            1, 2, 4, 8, 16, 32, 64, -128);
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+
+        int32_t k = 0;
+        for (; k + 16 <= length; k += 16)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(buf + k));
+            const __m128i lo = _mm_and_si128(v, nibble);
+            const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+            const __m128i entry = _mm_blendv_epi8(_mm_shuffle_epi8(low_table, lo),
+                _mm_shuffle_epi8(high_table, lo), v);
+            const __m128i hit = _mm_and_si128(entry, _mm_shuffle_epi8(bits, hi));
+            const unsigned miss = _mm_movemask_epi8(_mm_cmpeq_epi8(hit, _mm_setzero_si128()));
+            if (miss != 0xFFFF)
+                return k + __builtin_ctz(~miss);
+        }
+        return k + CharClass::find_first_scalar(cc, buf + k, length - k);
+    }
+
+    __attribute__((target("avx2")))
+    static int32_t find_first_avx2(const CharClass& cc, const uint8_t* buf, int32_t length)
+    {
+        const __m256i low_table =
+            _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)cc.table[0]));
+        const __m256i high_table =
+            _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)cc.table[1]));
+        const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+            1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+            1, 2, 4, 8, 16, 32, 64, -128);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+        int32_t k = 0;
+        for (; k + 32 <= length; k += 32)
+        {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)(buf + k));
+            const __m256i lo = _mm256_and_si256(v, nibble);
+            const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+            const __m256i entry = _mm256_blendv_epi8(_mm256_shuffle_epi8(low_table, lo),
+                _mm256_shuffle_epi8(high_table, lo), v);
+            const __m256i hit = _mm256_and_si256(entry, _mm256_shuffle_epi8(bits, hi));
+            const unsigned miss =
+                _mm256_movemask_epi8(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256()));
+            if (miss != 0xFFFFFFFF)
+                return k + __builtin_ctz(~miss);
+        }
+        return k + find_first_sse42(cc, buf + k, length - k);
+    }
+
+    __attribute__((target("sse4.2")))
+    static void copy_to_lower_sse42(const uint8_t* in_buf, int32_t length, uint8_t* out_buf)
+    {
+        const __m128i before_a = _mm_set1_epi8('A' - 1);
+        const __m128i after_z = _mm_set1_epi8('Z' + 1);
+        const __m128i case_bit = _mm_set1_epi8(0x20);
+
+        int32_t k = 0;
+        for (; k + 16 <= length; k += 16)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(in_buf + k));
+            const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, before_a),
+                _mm_cmplt_epi8(v, after_z));
+            _mm_storeu_si128((__m128i*)(out_buf + k),
+                _mm_or_si128(v, _mm_and_si128(upper, case_bit)));
+        }
+        copy_to_lower_scalar(in_buf + k, length - k, out_buf + k);
+    }
+
+    __attribute__((target("avx2")))
+    static void copy_to_lower_avx2(const uint8_t* in_buf, int32_t length, uint8_t* out_buf)
+    {
+        const __m256i before_a = _mm256_set1_epi8('A' - 1);
+        const __m256i after_z = _mm256_set1_epi8('Z' + 1);
+        const __m256i case_bit = _mm256_set1_epi8(0x20);
+
+        int32_t k = 0;
+        for (; k + 32 <= length; k += 32)
+        {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)(in_buf + k));
+            const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, before_a),
+                _mm256_cmpgt_epi8(after_z, v));
+            _mm256_storeu_si256((__m256i*)(out_buf + k),
+                _mm256_or_si256(v, _mm256_and_si256(upper, case_bit)));
+        }
+        copy_to_lower_sse42(in_buf + k, length - k, out_buf + k);
+    }
+};
+
+#endif
+
+void CharClass::init()
+{
+#ifdef HTTP_SIMD
+    if (__builtin_cpu_supports("avx2"))
+    {
+        search = CharClassSimd::find_first_avx2;
+        lower = CharClassSimd::copy_to_lower_avx2;
+    }
+    else if (__builtin_cpu_supports("sse4.2"))
+    {
+        search = CharClassSimd::find_first_sse42;
+        lower = CharClassSimd::copy_to_lower_sse42;
+    }
+#endif
+}
+
@@ -0,0 +1,71 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http_char_class.h
+
+#ifndef HTTP_CHAR_CLASS_H
+#define HTTP_CHAR_CLASS_H
+
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+// CharClass class
+// A set of octet values that can be searched for many bytes at a time. Most URIs and header
+// values contain nothing that needs attention so the common case is a fast scan that finds no
+// member of the class at all.
+//
+// Membership is stored as two 16-entry tables indexed by the low nibble of the octet. Each entry
+// has one bit for each of eight high nibble values. This layout can be searched with byte shuffle
+// instructions and is equally convenient for a scalar lookup.
+//-------------------------------------------------------------------------
+
+class CharClass
+{
+public:
+    CharClass() = default;
+    explicit CharClass(const char* members);
+
+    void clear();
+    void add(uint8_t octet)
+        { table[octet >> 7][octet & 0x0F] |= (uint8_t)(1 << ((octet >> 4) & 7)); }
+    bool contains(uint8_t octet) const
+        { return (table[octet >> 7][octet & 0x0F] >> ((octet >> 4) & 7)) & 1; }
+
+    // Offset of the first octet belonging to the class or length if there is none
+    int32_t find_first(const uint8_t* buf, int32_t length) const
+        { return search(*this, buf, length); }
+
+    // Select the widest search the CPU supports
+    static void init();
+
+    static int32_t find_first_scalar(const CharClass&, const uint8_t* buf, int32_t length);
+
+private:
+    typedef int32_t (SearchFunc)(const CharClass&, const uint8_t*, int32_t);
+    static SearchFunc* search;
+
+    friend struct CharClassSimd;
+
+    alignas(16) uint8_t table[2][16] = { };
+};
+
+// Copy length octets from in_buf to out_buf converting A-Z to lower case
+void copy_to_lower(const uint8_t* in_buf, int32_t length, uint8_t* out_buf);
+void copy_to_lower_scalar(const uint8_t* in_buf, int32_t length, uint8_t* out_buf);
+
+#endif
+
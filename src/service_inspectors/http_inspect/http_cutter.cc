@@ -18,14 +18,25 @@
 // http_cutter.cc author Tom Peters <thopeter@cisco.com>
 
 #include "http_cutter.h"
+#include "http_char_class.h"
 
 using namespace HttpEnums;
 
+static const CharClass line_end_chars("\r\n");
+
 ScanResult HttpStartCutter::cut(const uint8_t* buffer, uint32_t length,
     HttpInfractions& infractions, HttpEventGen& events, uint32_t, uint32_t)
 {
     for (uint32_t k = 0; k < length; k++)
     {
+        // Once the start of the line is validated only the line ending matters
+        if (validated && (num_crlf == 0))
+        {
+            k += line_end_chars.find_first(buffer + k, length - k);
+            if (k == length)
+                break;
+        }
+
         // Discard magic six white space characters CR, LF, Tab, VT, FF, and SP when they occur
         // before the start line.
         // If we have seen nothing but white space so far ...
@@ -138,6 +149,14 @@ ScanResult HttpHeaderCutter::cut(const uint8_t* buffer, uint32_t length,
     // discarded during reassemble().
     for (uint32_t k = 0; k < length; k++)
     {
+        // Ordinary header text only matters in that it resets the separator search
+        if (num_crlf == 0)
+        {
+            k += line_end_chars.find_first(buffer + k, length - k);
+            if (k == length)
+                break;
+        }
+
         if (buffer[k] == '\n')
         {
             num_crlf++;
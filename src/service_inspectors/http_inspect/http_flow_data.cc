@@ -17,6 +17,7 @@
 //--------------------------------------------------------------------------
 // http_flow_data.cc author Tom Peters <thopeter@cisco.com>
 
+#include "decompress/inflate_pool.h"
 #include "http_enum.h"
 #include "http_test_manager.h"
 #include "http_flow_data.h"
@@ -63,11 +64,7 @@ HttpFlowData::~HttpFlowData()
             delete[] section_buffer[k];
         HttpTransaction::delete_transaction(transaction[k]);
         delete cutter[k];
-        if (compress_stream[k] != nullptr)
-        {
-            inflateEnd(compress_stream[k]);
-            delete compress_stream[k];
-        }
+        InflatePool::release(compress_stream[k]);
     }
 
     if (mime_state != nullptr)
@@ -95,12 +92,8 @@ void HttpFlowData::half_reset(SourceId source_id)
     file_depth_remaining[source_id] = STAT_NOT_PRESENT;
     detect_depth_remaining[source_id] = STAT_NOT_PRESENT;
     compression[source_id] = CMP_NONE;
-    if (compress_stream[source_id] != nullptr)
-    {
-        inflateEnd(compress_stream[source_id]);
-        delete compress_stream[source_id];
-        compress_stream[source_id] = nullptr;
-    }
+    InflatePool::release(compress_stream[source_id]);
+    compress_stream[source_id] = nullptr;
     infractions[source_id].reset();
     events[source_id].reset();
     section_offset[source_id] = 0;
@@ -136,12 +129,8 @@ void HttpFlowData::trailer_prep(SourceId source_id)
 {
     type_expected[source_id] = SEC_TRAILER;
     compression[source_id] = CMP_NONE;
-    if (compress_stream[source_id] != nullptr)
-    {
-        inflateEnd(compress_stream[source_id]);
-        delete compress_stream[source_id];
-        compress_stream[source_id] = nullptr;
-    }
+    InflatePool::release(compress_stream[source_id]);
+    compress_stream[source_id] = nullptr;
     infractions[source_id].reset();
     events[source_id].reset();
 }
@@ -61,7 +61,8 @@ int32_t HeaderNormalizer::derive_header_content(const uint8_t* value, int32_t le
 // This method normalizes the header field value for headId.
 void HeaderNormalizer::normalize(const HeaderId head_id, const int count,
     HttpInfractions& infractions, HttpEventGen& events, const HeaderId header_name_id[],
-    const Field header_value[], const int32_t num_headers, Field& result_field) const
+    const Field header_value[], const int32_t num_headers, Field& result_field,
+    HttpArena& arena) const
 {
     if (result_field.length != STAT_NOT_COMPUTE)
     {
@@ -102,8 +103,8 @@ void HeaderNormalizer::normalize(const HeaderId head_id, const int count,
     // number of normalization functions is odd or even, the initial buffer is chosen so that the
     // final normalization leaves the normalized header value in norm_value.
 
-    uint8_t* const norm_value = new uint8_t[buffer_length];
-    uint8_t* const temp_space = new uint8_t[buffer_length];
+    uint8_t* const norm_value = arena.alloc(buffer_length);
+    uint8_t* const temp_space = arena.alloc(buffer_length);
     uint8_t* working = (num_normalizers%2 == 0) ? norm_value : temp_space;
     int32_t data_length = 0;
     for (int j=0; j < num_matches; j++)
@@ -131,7 +132,6 @@ void HeaderNormalizer::normalize(const HeaderId head_id, const int count,
             data_length = normalizer[i](norm_value, data_length, temp_space, infractions, events);
         }
     }
-    delete[] temp_space;
     result_field.set(data_length, norm_value);
     return;
 }
@@ -20,6 +20,7 @@
 #ifndef HTTP_HEAD_NORM_H
 #define HTTP_HEAD_NORM_H
 
+#include "http_arena.h"
 #include "http_field.h"
 #include "http_infractions.h"
 #include "http_normalizers.h"
@@ -46,7 +47,7 @@ public:
     void normalize(const HttpEnums::HeaderId head_id, const int count,
         HttpInfractions& infractions, HttpEventGen& events,
         const HttpEnums::HeaderId header_name_id[], const Field header_value[],
-        const int32_t num_headers, Field& result_field) const;
+        const int32_t num_headers, Field& result_field, HttpArena& arena) const;
 
 private:
     static int32_t derive_header_content(const uint8_t* value, int32_t length, uint8_t* buffer);
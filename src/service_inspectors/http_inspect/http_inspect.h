@@ -50,7 +50,7 @@ public:
     void eval(Packet*) override { }
     void clear(Packet* p) override;
     void tinit() override { }
-    void tterm() override { }
+    void tterm() override { HttpArena::term(); }
     HttpStreamSplitter* get_splitter(bool is_client_to_server) override
     {
         return new HttpStreamSplitter(is_client_to_server, this);
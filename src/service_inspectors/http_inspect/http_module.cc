@@ -74,6 +74,33 @@ const Parameter HttpModule::http_params[] =
 };
 
 THREAD_LOCAL PegCount HttpModule::peg_counts[PEG_COUNT_MAX] = { 0 };
+PegCount HttpModule::arena_high_water = 0;
+
+// Arena high water is the largest of any thread, not the sum. Each thread only adds the amount by
+// which it exceeds the threads summed before it.
+void HttpModule::sum_stats()
+{
+    // Module::sum_stats() would reset the sums after arena_high_water is updated
+    if (get_num_counts() < 0)
+        reset_stats();
+
+    PegCount& high_water = peg_counts[PEG_ARENA_HIGH_WATER];
+    if (high_water > arena_high_water)
+    {
+        const PegCount prior = arena_high_water;
+        arena_high_water = high_water;
+        high_water -= prior;
+    }
+    else
+        high_water = 0;
+    Module::sum_stats();
+}
+
+void HttpModule::reset_stats()
+{
+    arena_high_water = 0;
+    Module::reset_stats();
+}
 
 bool HttpModule::begin(const char*, int, SnortConfig*)
 {
@@ -206,6 +233,7 @@ bool HttpModule::end(const char*, int, SnortConfig*)
                 params->uri_param.iis_unicode_map_file.c_str(),
                 params->uri_param.iis_unicode_code_page);
     }
+    params->uri_param.build_char_classes();
     return true;
 }
 
@@ -266,5 +294,26 @@ HttpParaList::UriParam::UriParam() :
     CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,
     CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT,  CHAR_EIGHTBIT
   }
-{}
+{
+    build_char_classes();
+}
+
+void HttpParaList::UriParam::build_char_classes()
+{
+    norm_chars.clear();
+    norm_path_chars.clear();
+    bad_chars.clear();
+    for (unsigned k = 0; k < 256; k++)
+    {
+        if ((uri_char[k] == CHAR_PERCENT) || (uri_char[k] == CHAR_SUBSTIT))
+        {
+            norm_chars.add(k);
+            norm_path_chars.add(k);
+        }
+        else if (uri_char[k] == CHAR_PATH)
+            norm_path_chars.add(k);
+        if (bad_characters[k])
+            bad_chars.add(k);
+    }
+}
 
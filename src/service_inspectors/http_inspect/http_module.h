@@ -26,6 +26,7 @@
 #include "framework/module.h"
 
 #include "http_enum.h"
+#include "http_char_class.h"
 
 #define HTTP_NAME "http_inspect"
 #define HTTP_HELP "HTTP inspector"
@@ -58,6 +59,12 @@ public:
         std::bitset<256> bad_characters;
         std::bitset<256> unreserved_char;
         HttpEnums::CharAction uri_char[256];
+
+        // Derived from uri_char and bad_characters for fast scanning
+        CharClass norm_chars;        // percent and substitution characters
+        CharClass norm_path_chars;   // same plus path characters
+        CharClass bad_chars;
+        void build_char_classes();
     };
     UriParam uri_param;
 #ifdef REG_TEST
@@ -88,8 +95,15 @@ public:
 
     const PegInfo* get_pegs() const override { return peg_names; }
     PegCount* get_counts() const override { return peg_counts; }
+    void sum_stats() override;
+    void reset_stats() override;
     static void increment_peg_counts(HttpEnums::PEG_COUNT counter)
         { peg_counts[counter]++; return; }
+    static void add_peg_counts(HttpEnums::PEG_COUNT counter, PegCount value)
+        { peg_counts[counter] += value; }
+    static PegCount get_peg_count(HttpEnums::PEG_COUNT counter) { return peg_counts[counter]; }
+    static void set_peg_count(HttpEnums::PEG_COUNT counter, PegCount value)
+        { peg_counts[counter] = value; }
 
 #ifdef REG_TEST
     static const PegInfo* get_peg_names() { return peg_names; }
@@ -106,6 +120,7 @@ private:
     HttpParaList* params = nullptr;
     static const PegInfo peg_names[];
     static THREAD_LOCAL PegCount peg_counts[];
+    static PegCount arena_high_water;
 };
 
 #endif
@@ -43,19 +43,10 @@ HttpMsgBody::HttpMsgBody(const uint8_t* buffer, const uint16_t buf_size,
     transaction->set_body(this);
 }
 
-HttpMsgBody::~HttpMsgBody()
-{
-    if (classic_client_body_alloc)
-        classic_client_body.delete_buffer();
-
-    if (decoded_body_alloc)
-        decoded_body.delete_buffer();
-}
-
 void HttpMsgBody::analyze()
 {
-    do_utf_decoding(msg_text, decoded_body, decoded_body_alloc);
-    if ( decoded_body_alloc )
+    do_utf_decoding(msg_text, decoded_body);
+    if ( decoded_body.length > 0 )
     {
         detect_data.length = (decoded_body.length <= session_data->detect_depth_remaining[source_id]) ?
            decoded_body.length : session_data->detect_depth_remaining[source_id];
@@ -87,7 +78,7 @@ void HttpMsgBody::analyze()
     body_octets += msg_text.length;
 }
 
-void HttpMsgBody::do_utf_decoding(const Field& input, Field& output, bool& decoded_alloc)
+void HttpMsgBody::do_utf_decoding(const Field& input, Field& output)
 {
 
     if (!params->normalize_utf || source_id == SRC_CLIENT )
@@ -97,22 +88,16 @@ void HttpMsgBody::do_utf_decoding(const Field& input, Field& output, bool& decod
     {
         int bytes_copied;
         bool decoded;
-        uint8_t* buffer = new uint8_t[input.length];
+        uint8_t* buffer = arena.alloc(input.length);
         decoded = session_data->utf_state->decode_utf((const char*)input.start, input.length,
                             (char*)buffer, input.length, &bytes_copied);
         if (!decoded)
         {
-            delete[] buffer;
             infractions += INF_UTF_NORM_FAIL;
             events.create_event(EVENT_UTF_NORM_FAIL);
         }
         else if ( bytes_copied )
-        {
             output.set(bytes_copied, buffer);
-            decoded_alloc = true;
-        }
-        else
-            delete[] buffer;
     }
 
 }
@@ -182,8 +167,7 @@ void HttpMsgBody::do_file_processing()
 
 const Field& HttpMsgBody::get_classic_client_body()
 {
-    return classic_normalize(detect_data, classic_client_body, classic_client_body_alloc,
-        params->uri_param);
+    return classic_normalize(detect_data, classic_client_body, params->uri_param);
 }
 
 #ifdef REG_TEST
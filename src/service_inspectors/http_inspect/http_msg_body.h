@@ -30,7 +30,6 @@
 class HttpMsgBody : public HttpMsgSection
 {
 public:
-    virtual ~HttpMsgBody();
     void analyze() override;
     const Field& get_detect_buf() const override { return detect_data; }
     HttpEnums::InspectSection get_inspection_section() const override
@@ -50,15 +49,13 @@ protected:
 
 private:
     void do_file_processing();
-    void do_utf_decoding(const Field& input, Field& output, bool& decoded_alloc);
+    void do_utf_decoding(const Field& input, Field& output);
 
     Field detect_data;
     Field file_data;
     const bool detection_section;
     Field classic_client_body;   // URI normalization applied
-    bool classic_client_body_alloc = false;
     Field decoded_body;
-    bool decoded_body_alloc = false;
 };
 
 #endif
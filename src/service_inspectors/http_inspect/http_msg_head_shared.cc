@@ -22,33 +22,14 @@
 #include <stdio.h>
 
 #include "http_enum.h"
+#include "http_char_class.h"
 #include "http_normalizers.h"
 #include "http_uri_norm.h"
 #include "http_msg_head_shared.h"
 
 using namespace HttpEnums;
 
-HttpMsgHeadShared::~HttpMsgHeadShared()
-{
-    delete[] header_line;
-    delete[] header_name;
-    delete[] header_name_id;
-    delete[] header_value;
-    NormalizedHeader* list_ptr = norm_heads;
-    while (list_ptr != nullptr)
-    {
-        NormalizedHeader* temp_ptr = list_ptr;
-        list_ptr = list_ptr->next;
-        temp_ptr->norm.delete_buffer();
-        delete temp_ptr;
-    }
-    if (classic_raw_header_alloc)
-        classic_raw_header.delete_buffer();
-    if (classic_norm_header_alloc)
-        classic_norm_header.delete_buffer();
-    if (classic_norm_cookie_alloc)
-        classic_norm_cookie.delete_buffer();
-}
+static const CharClass lf_char("\n");
 
 // All the header processing that is done for every message (i.e. not just-in-time) is done here.
 void HttpMsgHeadShared::analyze()
@@ -79,7 +60,7 @@ void HttpMsgHeadShared::create_norm_head_list()
             {
                 headers_present[header_name_id[j]] = true;
                 NormalizedHeader* tmp_ptr = norm_heads;
-                norm_heads = new NormalizedHeader;
+                norm_heads = arena.create<NormalizedHeader>();
                 norm_heads->next = tmp_ptr;
                 norm_heads->id = header_name_id[j];
                 norm_heads->count = 1;
@@ -96,7 +77,7 @@ void HttpMsgHeadShared::parse_header_block()
     int num_seps;
     // session_data->num_head_lines is computed without consideration of wrapping and may overstate
     // actual number of headers. Rely on num_headers which is calculated correctly.
-    header_line = new Field[session_data->num_head_lines[source_id]];
+    header_line = arena.alloc_array<Field>(session_data->num_head_lines[source_id]);
     while (bytes_used < msg_text.length)
     {
         assert(num_headers < session_data->num_head_lines[source_id]);
@@ -138,7 +119,8 @@ uint32_t HttpMsgHeadShared::find_header_end(const uint8_t* buffer, int32_t lengt
     // k=1 because the splitter would not give us a header consisting solely of LF.
     for (int32_t k=1; k < length; k++)
     {
-        if (buffer[k] == '\n')
+        k += lf_char.find_first(buffer + k, length - k);
+        if (k < length)
         {
             // Check for wrapping
             if ((k+1 == length) || !is_sp_tab[buffer[k+1]])
@@ -160,9 +142,9 @@ uint32_t HttpMsgHeadShared::find_header_end(const uint8_t* buffer, int32_t lengt
 // Divide header field lines into field name and field value
 void HttpMsgHeadShared::parse_header_lines()
 {
-    header_name = new Field[num_headers];
-    header_value = new Field[num_headers];
-    header_name_id = new HeaderId[num_headers];
+    header_name = arena.alloc_array<Field>(num_headers);
+    header_value = arena.alloc_array<Field>(num_headers);
+    header_name_id = arena.alloc_array<HeaderId>(num_headers);
 
     int colon;
     for (int k=0; k < num_headers; k++)
@@ -201,23 +183,15 @@ void HttpMsgHeadShared::derive_header_name_id(int index)
     }
 
     // Normalize header field name to lower case and remove LWS for matching purposes
-    int32_t lower_length = 0;
-    uint8_t* lower_name = new uint8_t[length];
-    for (int32_t k=0; k < length; k++)
+    uint8_t* const lower_name = arena.alloc(length);
+    const int32_t lower_length = norm_remove_lws_to_lower(buffer, length, lower_name,
+        infractions, events);
+    if (lower_length < length)
     {
-        if (!is_sp_tab[buffer[k]])
-        {
-            lower_name[lower_length++] = ((buffer[k] < 'A') || (buffer[k] > 'Z')) ?
-                buffer[k] : buffer[k] - ('A' - 'a');
-        }
-        else
-        {
-            infractions += INF_HEAD_NAME_WHITESPACE;
-            events.create_event(EVENT_HEAD_NAME_WHITESPACE);
-        }
+        infractions += INF_HEAD_NAME_WHITESPACE;
+        events.create_event(EVENT_HEAD_NAME_WHITESPACE);
     }
     header_name_id[index] = (HeaderId)str_to_code(lower_name, lower_length, header_list);
-    delete[] lower_name;
 }
 
 HttpMsgHeadShared::NormalizedHeader* HttpMsgHeadShared::get_header_node(HeaderId header_id) const
@@ -263,7 +237,7 @@ const Field& HttpMsgHeadShared::get_classic_raw_header()
     }
 
     // Step through headers again and do the copying this time
-    uint8_t* const buffer = new uint8_t[length];
+    uint8_t* const buffer = arena.alloc(length);
     int32_t current = 0;
     for (int k = 0; k < num_headers; k++)
     {
@@ -277,14 +251,12 @@ const Field& HttpMsgHeadShared::get_classic_raw_header()
     assert(current == length);
 
     classic_raw_header.set(length, buffer);
-    classic_raw_header_alloc = true;
     return classic_raw_header;
 }
 
 const Field& HttpMsgHeadShared::get_classic_norm_header()
 {
-    return classic_normalize(get_classic_raw_header(), classic_norm_header,
-        classic_norm_header_alloc, params->uri_param);
+    return classic_normalize(get_classic_raw_header(), classic_norm_header, params->uri_param);
 }
 
 const Field& HttpMsgHeadShared::get_classic_raw_cookie()
@@ -295,8 +267,7 @@ const Field& HttpMsgHeadShared::get_classic_raw_cookie()
 
 const Field& HttpMsgHeadShared::get_classic_norm_cookie()
 {
-    return classic_normalize(get_classic_raw_cookie(), classic_norm_cookie,
-        classic_norm_cookie_alloc, params->uri_param);
+    return classic_normalize(get_classic_raw_cookie(), classic_norm_cookie, params->uri_param);
 }
 
 const Field& HttpMsgHeadShared::get_header_value_norm(HeaderId header_id)
@@ -305,7 +276,7 @@ const Field& HttpMsgHeadShared::get_header_value_norm(HeaderId header_id)
     if (node == nullptr)
         return Field::FIELD_NULL;
     header_norms[header_id]->normalize(header_id, node->count, infractions, events, header_name_id,
-        header_value, num_headers, node->norm);
+        header_value, num_headers, node->norm, arena);
     return node->norm;
 }
 
@@ -61,7 +61,6 @@ protected:
         const HttpParaList* params_)
         : HttpMsgSection(buffer, buf_size, session_data_, source_id_, buf_owner, flow_, params_)
         { }
-    ~HttpMsgHeadShared();
     // Get the next item in a comma-separated header value and convert it to an enum value
     static int32_t get_next_code(const Field& field, int32_t& offset, const StrCode table[]);
 
@@ -102,11 +101,8 @@ private:
     Field* header_value = nullptr;
 
     Field classic_raw_header;    // raw headers with cookies spliced out
-    bool classic_raw_header_alloc = false;
     Field classic_norm_header;   // URI normalization applied
-    bool classic_norm_header_alloc = false;
     Field classic_norm_cookie;   // URI normalization applied to concatenated cookie values
-    bool classic_norm_cookie_alloc = false;
 
     struct NormalizedHeader
     {
@@ -25,6 +25,7 @@
 #include "detection/detection_util.h"
 #include "file_api/file_service.h"
 #include "file_api/file_flows.h"
+#include "decompress/inflate_pool.h"
 
 #include "http_module.h"
 #include "http_api.h"
@@ -315,18 +316,15 @@ void HttpMsgHeader::setup_decompression()
     if (compression == CMP_NONE)
         return;
 
-    session_data->compress_stream[source_id] = new z_stream;
-    session_data->compress_stream[source_id]->zalloc = Z_NULL;
-    session_data->compress_stream[source_id]->zfree = Z_NULL;
-    session_data->compress_stream[source_id]->next_in = Z_NULL;
-    session_data->compress_stream[source_id]->avail_in = 0;
     const int window_bits = (compression == CMP_GZIP) ? GZIP_WINDOW_BITS : DEFLATE_WINDOW_BITS;
-    if (inflateInit2(session_data->compress_stream[source_id], window_bits) != Z_OK)
+    bool reused;
+    session_data->compress_stream[source_id] = InflatePool::acquire(window_bits, &reused);
+    if (session_data->compress_stream[source_id] == nullptr)
     {
         session_data->compression[source_id] = CMP_NONE;
-        delete session_data->compress_stream[source_id];
-        session_data->compress_stream[source_id] = nullptr;
+        return;
     }
+    HttpModule::increment_peg_counts(reused ? PEG_INFLATE_REUSE : PEG_INFLATE_INIT);
 }
 
 void HttpMsgHeader::setup_utf_decoding()
@@ -94,8 +94,8 @@ void HttpMsgRequest::parse_start_line()
 
     if (first_end < last_begin)
     {
-        uri = new HttpUri(start_line.start + first_end + 1, last_begin - first_end - 1,
-            method_id, params->uri_param, infractions, events);
+        uri = arena.create<HttpUri>(start_line.start + first_end + 1,
+            last_begin - first_end - 1, method_id, params->uri_param, infractions, events, arena);
     }
     else
     {
@@ -126,8 +126,8 @@ bool HttpMsgRequest::handle_zero_nine()
         {
             int32_t uri_end;
             for (uri_end = start_line.length - 1; is_sp_tab[start_line.start[uri_end]]; uri_end--);
-            uri = new HttpUri(start_line.start + uri_begin, uri_end - uri_begin + 1, method_id,
-                params->uri_param, infractions, events);
+            uri = arena.create<HttpUri>(start_line.start + uri_begin, uri_end - uri_begin + 1,
+                method_id, params->uri_param, infractions, events, arena);
         }
         else
         {
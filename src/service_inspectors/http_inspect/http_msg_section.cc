@@ -80,7 +80,7 @@ void HttpMsgSection::update_depth() const
     }
 }
 
-const Field& HttpMsgSection::classic_normalize(const Field& raw, Field& norm, bool& norm_alloc,
+const Field& HttpMsgSection::classic_normalize(const Field& raw, Field& norm,
     const HttpParaList::UriParam& uri_param)
 {
     if (norm.length != STAT_NOT_COMPUTE)
@@ -91,9 +91,8 @@ const Field& HttpMsgSection::classic_normalize(const Field& raw, Field& norm, bo
         norm.set(raw);
         return norm;
     }
-    uint8_t* buffer = new uint8_t[raw.length + UriNormalizer::URI_NORM_EXPANSION];
+    uint8_t* buffer = arena.alloc(raw.length + UriNormalizer::URI_NORM_EXPANSION);
     UriNormalizer::classic_normalize(raw, norm, buffer, uri_param);
-    norm_alloc = true;
     return norm;
 }
 
@@ -22,6 +22,7 @@
 
 #include "detection/detection_util.h"
 
+#include "http_arena.h"
 #include "http_field.h"
 #include "http_module.h"
 #include "http_flow_data.h"
@@ -79,9 +80,13 @@ protected:
     HttpEnums::MethodId method_id;
     int32_t status_code_num;
 
+    // All just-in-time work products of this section are allocated here and released together
+    // when the section is destroyed
+    HttpArena arena;
+
     // Convenience methods shared by multiple subclasses
     void update_depth() const;
-    static const Field& classic_normalize(const Field& raw, Field& norm, bool& norm_alloc,
+    const Field& classic_normalize(const Field& raw, Field& norm,
         const HttpParaList::UriParam& uri_param);
 #ifdef REG_TEST
     void print_section_title(FILE* output, const char* title) const;
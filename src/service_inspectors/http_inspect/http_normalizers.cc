@@ -21,11 +21,15 @@
 #include <sys/types.h>
 
 #include "http_enum.h"
+#include "http_char_class.h"
 #include "http_str_to_code.h"
 #include "http_normalizers.h"
 
 using namespace HttpEnums;
 
+static const CharClass lws_chars(" \t");
+static const CharClass quotes_lws_chars(" \t'\"");
+
 // Collection of stock normalization functions. This will probably grow throughout the life of the
 // software. New functions must follow the standard signature. The void* at the end is for any
 // special configuration data the function requires.
@@ -33,39 +37,47 @@ using namespace HttpEnums;
 int32_t norm_to_lower(const uint8_t* in_buf, int32_t in_length, uint8_t* out_buf,
     HttpInfractions&, HttpEventGen&)
 {
-    for (int32_t k=0; k < in_length; k++)
-    {
-        // FIXIT-P tolower() might perform better but must be sure <locale> cannot be pulled in
-        out_buf[k] = ((in_buf[k] < 'A') || (in_buf[k] > 'Z')) ? in_buf[k] : in_buf[k] - ('A' -
-            'a');
-    }
+    copy_to_lower(in_buf, in_length, out_buf);
     return in_length;
 }
 
-// Remove all space and tab characters (known as LWS or linear white space in the RFC)
-int32_t norm_remove_lws(const uint8_t* in_buf, int32_t in_length, uint8_t* out_buf,
-    HttpInfractions&, HttpEventGen&)
+// Copy the runs of octets between the members of the removal class. Header values rarely contain
+// many of them so most of the work is a few long copies.
+static int32_t remove_chars(const CharClass& removed, const uint8_t* in_buf, int32_t in_length,
+    uint8_t* out_buf, bool lower)
 {
     int32_t length = 0;
     for (int32_t k = 0; k < in_length; k++)
     {
-        if (!is_sp_tab[in_buf[k]])
-            out_buf[length++] = in_buf[k];
+        const int32_t run = removed.find_first(in_buf + k, in_length - k);
+        if (lower)
+            copy_to_lower(in_buf + k, run, out_buf + length);
+        else
+            memcpy(out_buf + length, in_buf + k, run);
+        length += run;
+        k += run;
     }
     return length;
 }
-//FIXIT - norm_remove_lws and norm_remove_quotes_lws could be combined into one function
+
+// Remove all space and tab characters (known as LWS or linear white space in the RFC)
+int32_t norm_remove_lws(const uint8_t* in_buf, int32_t in_length, uint8_t* out_buf,
+    HttpInfractions&, HttpEventGen&)
+{
+    return remove_chars(lws_chars, in_buf, in_length, out_buf, false);
+}
+
 int32_t norm_remove_quotes_lws(const uint8_t* in_buf, int32_t in_length, uint8_t* out_buf,
     HttpInfractions&, HttpEventGen&)
 {
-    int32_t length = 0;
-    for (int32_t k=0; k < in_length; k++)
-    {
-        if (in_buf[k] == '\'' || in_buf[k] == '\"' || is_sp_tab[in_buf[k]])
-            continue;
-        out_buf[length++] = in_buf[k];
-    }
-    return length;
+    return remove_chars(quotes_lws_chars, in_buf, in_length, out_buf, false);
+}
+
+// Remove LWS and convert to lower case in a single pass
+int32_t norm_remove_lws_to_lower(const uint8_t* in_buf, int32_t in_length, uint8_t* out_buf,
+    HttpInfractions&, HttpEventGen&)
+{
+    return remove_chars(lws_chars, in_buf, in_length, out_buf, true);
 }
 
 // Other header-value processing functions (not using the standard normalization signature)
@@ -35,6 +35,7 @@ typedef int32_t (NormFunc)(const uint8_t*, int32_t, uint8_t*, HttpInfractions&,
 NormFunc norm_to_lower;
 NormFunc norm_remove_lws;
 NormFunc norm_remove_quotes_lws;
+NormFunc norm_remove_lws_to_lower;
 
 // Other normalization-related utilities
 void get_last_token(const Field& input, Field& last_token, char ichar);
@@ -20,6 +20,7 @@
 #include <assert.h>
 #include <sys/types.h>
 
+#include "decompress/inflate_pool.h"
 #include "file_api/file_flows.h"
 #include "http_enum.h"
 #include "http_field.h"
@@ -129,6 +130,9 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
 
         if ((ret_val == Z_OK) || (ret_val == Z_STREAM_END))
         {
+            HttpModule::add_peg_counts(PEG_COMPRESSED_OCTETS, length - compress_stream->avail_in);
+            HttpModule::add_peg_counts(PEG_DECOMPRESSED_OCTETS,
+                (MAX_OCTETS - compress_stream->avail_out) - offset);
             offset = MAX_OCTETS - compress_stream->avail_out;
             if (compress_stream->avail_in > 0)
             {
@@ -152,8 +156,7 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
                     events.create_event(EVENT_GZIP_OVERRUN);
                 }
                 compression = CMP_NONE;
-                inflateEnd(compress_stream);
-                delete compress_stream;
+                InflatePool::release(compress_stream);
                 compress_stream = nullptr;
             }
             return;
@@ -179,8 +182,7 @@ void HttpStreamSplitter::decompress_copy(uint8_t* buffer, uint32_t& offset, cons
             infractions += INF_GZIP_FAILURE;
             events.create_event(EVENT_GZIP_FAILURE);
             compression = CMP_NONE;
-            inflateEnd(compress_stream);
-            delete compress_stream;
+            InflatePool::release(compress_stream);
             compress_stream = nullptr;
             // Since we failed to uncompress the data, fall through
         }
@@ -385,6 +385,12 @@ const PegInfo HttpModule::peg_names[PEG_COUNT_MAX+1] =
     { "URI normalizations", "URIs needing to be normalization" },
     { "URI path", "URIs with path problems" },
     { "URI coding", "URIs with character coding problems" },
+    { "arena high water", "most work product memory used by one message section" },
+    { "arena overflows", "work product allocations too large for a standard arena block" },
+    { "inflate reuses", "decompression streams taken from the per-thread pool" },
+    { "inflate inits", "decompression streams initialized from scratch" },
+    { "compressed octets", "compressed message body octets consumed by inflate" },
+    { "decompressed octets", "message body octets produced by inflate" },
     { nullptr, nullptr }
 };
 
@@ -28,12 +28,6 @@
 
 using namespace HttpEnums;
 
-HttpUri::~HttpUri()
-{
-    if (classic_norm_allocated)
-        delete[] classic_norm.start;
-}
-
 void HttpUri::parse_uri()
 {
     // Four basic types of HTTP URI
@@ -226,7 +220,7 @@ void HttpUri::normalize()
 
     // Create a new buffer containing the normalized URI by normalizing each individual piece.
     const uint32_t total_length = uri.length + UriNormalizer::URI_NORM_EXPANSION;
-    uint8_t* const new_buf = new uint8_t[total_length];
+    uint8_t* const new_buf = arena.alloc(total_length);
     uint8_t* current = new_buf;
     if (scheme.length >= 0)
     {
@@ -316,6 +310,5 @@ void HttpUri::normalize()
     check_oversize_dir(path_norm);
 
     classic_norm.set(current - new_buf, new_buf);
-    classic_norm_allocated = true;
 }
 
@@ -20,6 +20,7 @@
 #ifndef HTTP_URI_H
 #define HTTP_URI_H
 
+#include "http_arena.h"
 #include "http_str_to_code.h"
 #include "http_module.h"
 #include "http_uri_norm.h"
@@ -36,11 +37,10 @@ class HttpUri
 public:
     HttpUri(const uint8_t* start, int32_t length, HttpEnums::MethodId method_id_,
         const HttpParaList::UriParam& uri_param_, HttpInfractions& infractions_,
-        HttpEventGen& events_) :
+        HttpEventGen& events_, HttpArena& arena_) :
         uri(length, start), method_id(method_id_), uri_param(uri_param_),
-        infractions(infractions_), events(events_)
+        infractions(infractions_), events(events_), arena(arena_)
         { normalize(); }
-    ~HttpUri();
     const Field& get_uri() const { return uri; }
     HttpEnums::UriType get_uri_type() { return uri_type; }
     const Field& get_scheme() { return scheme; }
@@ -64,6 +64,7 @@ private:
     const HttpParaList::UriParam& uri_param;
     HttpInfractions& infractions;
     HttpEventGen& events;
+    HttpArena& arena;
 
     Field scheme;
     Field authority;
@@ -80,7 +81,6 @@ private:
     Field query_norm;
     Field fragment_norm;
     Field classic_norm;
-    bool classic_norm_allocated = false;
 
     void normalize();
     void parse_uri();
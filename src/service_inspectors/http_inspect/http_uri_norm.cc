@@ -71,14 +71,7 @@ bool UriNormalizer::need_norm_no_path(const Field& uri_component,
     const HttpParaList::UriParam& uri_param)
 {
     const int32_t& length = uri_component.length;
-    const uint8_t* const & buf = uri_component.start;
-    for (int32_t k = 0; k < length; k++)
-    {
-        if ((uri_param.uri_char[buf[k]] == CHAR_PERCENT) ||
-            (uri_param.uri_char[buf[k]] == CHAR_SUBSTIT))
-            return true;
-    }
-    return false;
+    return uri_param.norm_chars.find_first(uri_component.start, length) < length;
 }
 
 bool UriNormalizer::need_norm_path(const Field& uri_component,
@@ -86,8 +79,12 @@ bool UriNormalizer::need_norm_path(const Field& uri_component,
 {
     const int32_t& length = uri_component.length;
     const uint8_t* const & buf = uri_component.start;
+    // Skip quickly over ordinary characters and only examine the ones that may need work
     for (int32_t k = 0; k < length; k++)
     {
+        k += uri_param.norm_path_chars.find_first(buf + k, length - k);
+        if (k >= length)
+            break;
         switch (uri_param.uri_char[buf[k]])
         {
         case CHAR_NORMAL:
@@ -342,14 +339,11 @@ void UriNormalizer::detect_bad_char(const Field& uri_component,
     if (uri_param.bad_characters.count() == 0)
         return;
 
-    for (int32_t k = 0; k < uri_component.length; k++)
+    if (uri_param.bad_chars.find_first(uri_component.start, uri_component.length) <
+        uri_component.length)
     {
-        if (uri_param.bad_characters[uri_component.start[k]])
-        {
-            infractions += INF_URI_BAD_CHAR;
-            events.create_event(EVENT_NON_RFC_CHAR);
-            return;
-        }
+        infractions += INF_URI_BAD_CHAR;
+        events.create_event(EVENT_NON_RFC_CHAR);
     }
 }
 
@@ -0,0 +1,114 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// http_arena_test.cc
+// unit test main
+
+#include "service_inspectors/http_inspect/http_arena.h"
+#include "service_inspectors/http_inspect/http_enum.h"
+#include "service_inspectors/http_inspect/http_module.h"
+
+#include <string.h>
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace HttpEnums;
+
+THREAD_LOCAL PegCount HttpModule::peg_counts[PEG_COUNT_MAX];
+
+TEST_GROUP(http_arena)
+{
+    void setup()
+    {
+        for (unsigned k = 0; k < PEG_COUNT_MAX; HttpModule::set_peg_count((PEG_COUNT)k++, 0));
+    }
+
+    void teardown()
+    {
+        HttpArena::term();
+    }
+};
+
+TEST(http_arena, small_section)
+{
+    HttpArena arena;
+    uint8_t* const ptr = arena.alloc(100);
+    CHECK(ptr != nullptr);
+    CHECK(((uintptr_t)ptr & 7) == 0);
+    CHECK(arena.get_footprint() == 104);
+    CHECK(arena.get_capacity() == 256);
+}
+
+TEST(http_arena, first_block_fits_request)
+{
+    HttpArena arena;
+    arena.alloc(1000);
+    CHECK(arena.get_capacity() == 1024);
+    CHECK(HttpModule::get_peg_count(PEG_ARENA_OVERFLOW) == 0);
+}
+
+TEST(http_arena, geometric_growth)
+{
+    HttpArena arena;
+    for (unsigned k = 0; k < 200; k++)
+    {
+        uint8_t* const ptr = arena.alloc(40);
+        memset(ptr, k, 40);
+    }
+    CHECK(arena.get_footprint() == 200 * 40);
+    CHECK(arena.get_capacity() == 256 + 512 + 1024 + 2048 + 4096 + 8192);
+    CHECK(arena.get_capacity() <= 2 * arena.get_footprint() + 256);
+}
+
+TEST(http_arena, oversize)
+{
+    HttpArena arena;
+    arena.alloc(100);
+    uint8_t* const big = arena.alloc(20000);
+    memset(big, 0, 20000);
+    CHECK(HttpModule::get_peg_count(PEG_ARENA_OVERFLOW) == 1);
+    CHECK(arena.get_capacity() > 20256);
+
+    // The oversize block goes behind the first one which still has room
+    const uint32_t capacity = arena.get_capacity();
+    arena.alloc(100);
+    CHECK(arena.get_capacity() == capacity);
+}
+
+TEST(http_arena, reset)
+{
+    HttpArena arena;
+    arena.alloc(3000);
+    arena.alloc(3000);
+    arena.reset();
+    CHECK(arena.get_footprint() == 0);
+    CHECK(arena.get_capacity() == 0);
+    CHECK(HttpModule::get_peg_count(PEG_ARENA_HIGH_WATER) == 6000);
+
+    // After a reset the arena starts over with a small block
+    arena.alloc(100);
+    CHECK(arena.get_capacity() == 256);
+    arena.reset();
+    CHECK(HttpModule::get_peg_count(PEG_ARENA_HIGH_WATER) == 6000);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
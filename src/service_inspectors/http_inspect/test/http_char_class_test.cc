@@ -0,0 +1,179 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// http_char_class_test.cc
+// unit test main
+
+#include "service_inspectors/http_inspect/http_char_class.h"
+
+#include <chrono>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+// A long cookie header with a single space just before the end
+static std::string make_cookie()
+{
+    std::string cookie;
+    for (int k = 0; cookie.length() < 4000; k++)
+        cookie += "SessionToken" + std::to_string(k) + "=AbCdEfGhIjKlMnOpQrStUvWxYz0123456789;";
+    cookie += " final=1";
+    return cookie;
+}
+
+// A long URI that needs no normalization
+static std::string make_uri()
+{
+    std::string uri = "/static/assets";
+    for (int k = 0; uri.length() < 2000; k++)
+        uri += "/component" + std::to_string(k) + "?query=value_" + std::to_string(k);
+    return uri;
+}
+
+static void check_all_offsets(const CharClass& cc, const std::string& text)
+{
+    const uint8_t* const buf = (const uint8_t*)text.data();
+    const int32_t length = text.length();
+    for (int32_t start = 0; start < 64; start++)
+    {
+        for (int32_t end = length - 64; end <= length; end++)
+        {
+            CHECK(cc.find_first(buf + start, end - start) ==
+                CharClass::find_first_scalar(cc, buf + start, end - start));
+        }
+    }
+}
+
+TEST_GROUP(http_char_class) { };
+
+TEST(http_char_class, membership)
+{
+    CharClass cc("%+\\\x80\xff");
+    for (unsigned k = 0; k < 256; k++)
+    {
+        const bool expected = (k == '%') || (k == '+') || (k == '\\') || (k == 0x80) ||
+            (k == 0xff);
+        CHECK(cc.contains(k) == expected);
+    }
+    cc.clear();
+    for (unsigned k = 0; k < 256; k++)
+        CHECK(!cc.contains(k));
+}
+
+TEST(http_char_class, find_first_every_position)
+{
+    CharClass::init();
+    for (unsigned octet = 0; octet < 256; octet++)
+    {
+        CharClass cc;
+        cc.add(octet);
+        uint8_t buf[100];
+        memset(buf, octet ^ 0x01, sizeof(buf));
+        CHECK(cc.find_first(buf, sizeof(buf)) == sizeof(buf));
+        for (int32_t k = 0; k < (int32_t)sizeof(buf); k++)
+        {
+            buf[k] = octet;
+            CHECK(cc.find_first(buf, sizeof(buf)) == k);
+            buf[k] = octet ^ 0x01;
+        }
+    }
+}
+
+TEST(http_char_class, long_headers)
+{
+    CharClass::init();
+    const CharClass lws(" \t");
+    const CharClass uri_norm("%+\\");
+    const CharClass uri_path("%+\\/.");
+    check_all_offsets(lws, make_cookie());
+    check_all_offsets(uri_norm, make_uri());
+    check_all_offsets(uri_norm, make_uri() + "%20");
+    check_all_offsets(uri_path, make_uri());
+}
+
+TEST(http_char_class, to_lower)
+{
+    CharClass::init();
+    uint8_t in[300];
+    uint8_t out[300];
+    uint8_t expected[300];
+    for (unsigned k = 0; k < sizeof(in); k++)
+        in[k] = k;
+    for (int32_t start = 0; start < 40; start++)
+    {
+        copy_to_lower(in + start, sizeof(in) - start, out);
+        copy_to_lower_scalar(in + start, sizeof(in) - start, expected);
+        CHECK(memcmp(out, expected, sizeof(in) - start) == 0);
+    }
+
+    const char* const mixed = "Content-Type: TEXT/HTML; Charset=UTF-8 [@Z`a]";
+    copy_to_lower((const uint8_t*)mixed, strlen(mixed), out);
+    CHECK(memcmp(out, "content-type: text/html; charset=utf-8 [@z`a]", strlen(mixed)) == 0);
+}
+
+// Not a pass/fail test. Reports the vectorized and scalar scan rates on the fast reject path.
+TEST(http_char_class, benchmark)
+{
+    CharClass::init();
+    const std::string cookie = make_cookie();
+    const std::string uri = make_uri();
+    const CharClass lws(" \t");
+    const CharClass uri_norm("%+\\");
+    const int iterations = 20000;
+
+    struct
+    {
+        const char* name;
+        const CharClass& cc;
+        const std::string& text;
+    }
+    cases[] = { { "cookie", lws, cookie }, { "uri", uri_norm, uri } };
+
+    for (auto& c : cases)
+    {
+        const uint8_t* const buf = (const uint8_t*)c.text.data();
+        const int32_t length = c.text.length();
+        int64_t simd_total = 0;
+        int64_t scalar_total = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < iterations; k++)
+            simd_total += c.cc.find_first(buf, length - (k & 1));
+        auto middle = std::chrono::steady_clock::now();
+        for (int k = 0; k < iterations; k++)
+            scalar_total += CharClass::find_first_scalar(c.cc, buf, length - (k & 1));
+        auto end = std::chrono::steady_clock::now();
+
+        CHECK(simd_total == scalar_total);
+        const double bytes = (double)length * iterations;
+        const double simd_ns = std::chrono::duration<double, std::nano>(middle - start).count();
+        const double scalar_ns = std::chrono::duration<double, std::nano>(end - middle).count();
+        printf("\n%s %d octets: %.0f MB/s vectorized, %.0f MB/s scalar", c.name, length,
+            bytes * 1000 / simd_ns, bytes * 1000 / scalar_ns);
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
@@ -23,6 +23,7 @@
 #include "service_inspectors/http_inspect/http_module.h"
 #include "service_inspectors/http_inspect/http_flow_data.h"
 #include "service_inspectors/http_inspect/http_enum.h"
+#include "decompress/inflate_pool.h"
 
 #include <CppUTest/CommandLineTestRunner.h>
 #include <CppUTest/TestHarness.h>
@@ -36,6 +37,7 @@ FlowData::FlowData(unsigned, Inspector*) {}
 FlowData::~FlowData() {}
 int SnortEventqAdd(unsigned int, unsigned int, RuleType) { return 0; }
 THREAD_LOCAL PegCount HttpModule::peg_counts[1];
+void InflatePool::release(z_stream*) {}
 
 class HttpUnitTestSetup
 {
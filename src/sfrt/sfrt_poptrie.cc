@@ -0,0 +1,465 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// sfrt_poptrie.cc
+
+#include "sfrt_poptrie.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <vector>
+
+#include "utils/util.h"
+
+#define TBL24_SIZE (1 << 24)
+#define DIRECT_BITS 16
+#define STRIDE 6
+
+// set in tbl24 and direct entries that refer to a tbl8 group or node
+// instead of holding a data index
+#define EXTENDED 0x80000000
+
+struct PoptrieNode
+{
+    uint64_t vector;   // slots that are child nodes
+    uint64_t leafvec;  // leaf slots that start a run of a new value
+    uint32_t base0;    // first leaf of this node
+    uint32_t base1;    // first child of this node
+};
+
+struct poptrie_table_t
+{
+    const uint8_t* base;  // the flat table and its segment
+    const INFO* data;
+
+    uint32_t* tbl24;
+    std::vector<uint32_t> tbl8;
+
+    std::vector<uint32_t> direct;
+    std::vector<PoptrieNode> nodes;
+    std::vector<uint32_t> leaves;
+};
+
+//-------------------------------------------------------------------------
+// keys are addresses in network order, ie as ip8[], and bits are taken
+// msb first.  bits past the end of the key are zero.
+//-------------------------------------------------------------------------
+
+struct Key
+{
+    uint8_t b[16];
+    unsigned size;  // in bits
+};
+
+static inline uint32_t get_bits(const Key& k, unsigned pos, unsigned n)
+{
+    uint32_t v = 0;
+
+    for ( unsigned i = pos; i < pos + n; ++i )
+    {
+        unsigned bit = (i < k.size) ? (k.b[i >> 3] >> (7 - (i & 7))) & 1 : 0;
+        v = (v << 1) | bit;
+    }
+    return v;
+}
+
+static inline void set_bits(Key& k, unsigned pos, unsigned n, uint32_t v)
+{
+    for ( unsigned i = pos + n; i-- > pos; v >>= 1 )
+    {
+        if ( i >= k.size )
+            continue;
+
+        uint8_t m = 1 << (7 - (i & 7));
+
+        if ( v & 1 )
+            k.b[i >> 3] |= m;
+        else
+            k.b[i >> 3] &= ~m;
+    }
+}
+
+//-------------------------------------------------------------------------
+// flat dir walker
+//-------------------------------------------------------------------------
+
+static inline const dir_sub_table_flat_t* get_sub(const uint8_t* base, MEM_OFFSET off)
+{ return (const dir_sub_table_flat_t*)(base + off); }
+
+static inline const DIR_Entry* get_entries(const uint8_t* base, const dir_sub_table_flat_t* st)
+{ return (const DIR_Entry*)(base + st->entries); }
+
+static inline bool is_leaf(const DIR_Entry& e)
+{ return !e.value or e.length; }
+
+// true if all the leaves under entries [lo, lo+n) have the same value
+static bool entries_uniform(
+    const uint8_t* base, MEM_OFFSET sub, uint32_t lo, uint32_t n, bool& set, uint32_t& value)
+{
+    const dir_sub_table_flat_t* st = get_sub(base, sub);
+    const DIR_Entry* e = get_entries(base, st);
+
+    for ( uint32_t i = lo; i < lo + n; ++i )
+    {
+        if ( !is_leaf(e[i]) )
+        {
+            if ( !entries_uniform(base, e[i].value, 0, get_sub(base, e[i].value)->num_entries,
+                set, value) )
+                return false;
+        }
+        else if ( set and value != e[i].value )
+            return false;
+
+        else
+        {
+            set = true;
+            value = e[i].value;
+        }
+    }
+    return true;
+}
+
+// true if all addresses starting with the first depth bits of the key
+// map to the same data index, which is returned in value
+static bool prefix_uniform(
+    const uint8_t* base, MEM_OFFSET sub, const Key& k, unsigned depth, uint32_t& value)
+{
+    unsigned bc = 0;
+
+    if ( depth > k.size )
+        depth = k.size;
+
+    while ( true )
+    {
+        const dir_sub_table_flat_t* st = get_sub(base, sub);
+        unsigned w = st->width;
+
+        if ( depth < bc + w )
+        {
+            unsigned fixed = depth - bc;
+            uint32_t lo = get_bits(k, bc, fixed) << (w - fixed);
+            bool set = false;
+            return entries_uniform(base, sub, lo, 1 << (w - fixed), set, value);
+        }
+
+        const DIR_Entry& e = get_entries(base, st)[get_bits(k, bc, w)];
+
+        if ( is_leaf(e) )
+        {
+            value = e.value;
+            return true;
+        }
+        sub = e.value;
+        bc += w;
+    }
+}
+
+//-------------------------------------------------------------------------
+// build
+//-------------------------------------------------------------------------
+
+static void build_tbl24(poptrie_table_t* pt, MEM_OFFSET root, Key& k, unsigned depth)
+{
+    uint32_t value;
+
+    if ( prefix_uniform(pt->base, root, k, depth, value) )
+    {
+        uint32_t lo = get_bits(k, 0, depth) << (24 - depth);
+        uint32_t n = 1 << (24 - depth);
+
+        for ( uint32_t i = lo; i < lo + n; ++i )
+            pt->tbl24[i] = value;
+        return;
+    }
+
+    if ( depth < 24 )
+    {
+        set_bits(k, depth, 1, 0);
+        build_tbl24(pt, root, k, depth + 1);
+        set_bits(k, depth, 1, 1);
+        build_tbl24(pt, root, k, depth + 1);
+        set_bits(k, depth, 1, 0);
+        return;
+    }
+
+    uint32_t group = pt->tbl8.size() >> 8;
+    pt->tbl24[get_bits(k, 0, 24)] = EXTENDED | group;
+    pt->tbl8.resize(pt->tbl8.size() + 256);
+
+    for ( uint32_t i = 0; i < 256; ++i )
+    {
+        set_bits(k, 24, 8, i);
+        prefix_uniform(pt->base, root, k, 32, value);
+        pt->tbl8[(group << 8) + i] = value;
+    }
+    set_bits(k, 24, 8, 0);
+}
+
+// fill the node at index ni for the key prefix of length bc
+static void build_node(poptrie_table_t* pt, MEM_OFFSET root, Key& k, unsigned bc, uint32_t ni)
+{
+    uint32_t leaf[1 << STRIDE];
+    uint64_t vector = 0, leafvec = 0;
+    bool have_leaf = false;
+    uint32_t last = 0;
+    unsigned depth = bc + STRIDE;
+
+    for ( uint32_t i = 0; i < (1 << STRIDE); ++i )
+    {
+        set_bits(k, bc, STRIDE, i);
+
+        if ( !prefix_uniform(pt->base, root, k, depth, leaf[i]) )
+        {
+            vector |= (uint64_t)1 << i;
+            continue;
+        }
+        if ( !have_leaf or leaf[i] != last )
+        {
+            leafvec |= (uint64_t)1 << i;
+            pt->leaves.push_back(leaf[i]);
+            last = leaf[i];
+            have_leaf = true;
+        }
+    }
+
+    // children are contiguous so they are allocated before building any
+    uint32_t base1 = pt->nodes.size();
+    pt->nodes.resize(base1 + __builtin_popcountll(vector));
+
+    PoptrieNode& n = pt->nodes[ni];
+    n.vector = vector;
+    n.leafvec = leafvec;
+    n.base0 = pt->leaves.size() - __builtin_popcountll(leafvec);
+    n.base1 = base1;
+
+    for ( uint32_t i = 0, c = base1; i < (1 << STRIDE); ++i )
+    {
+        if ( vector & ((uint64_t)1 << i) )
+        {
+            set_bits(k, bc, STRIDE, i);
+            build_node(pt, root, k, depth, c++);
+        }
+    }
+    set_bits(k, bc, STRIDE, 0);
+}
+
+static void build_direct(poptrie_table_t* pt, MEM_OFFSET root, Key& k, unsigned depth)
+{
+    uint32_t value;
+
+    if ( prefix_uniform(pt->base, root, k, depth, value) )
+    {
+        uint32_t lo = get_bits(k, 0, depth) << (DIRECT_BITS - depth);
+        uint32_t n = 1 << (DIRECT_BITS - depth);
+
+        for ( uint32_t i = lo; i < lo + n; ++i )
+            pt->direct[i] = EXTENDED | value;
+        return;
+    }
+
+    if ( depth < DIRECT_BITS )
+    {
+        set_bits(k, depth, 1, 0);
+        build_direct(pt, root, k, depth + 1);
+        set_bits(k, depth, 1, 1);
+        build_direct(pt, root, k, depth + 1);
+        set_bits(k, depth, 1, 0);
+        return;
+    }
+
+    uint32_t ni = pt->nodes.size();
+    pt->nodes.resize(ni + 1);
+    pt->direct[get_bits(k, 0, DIRECT_BITS)] = ni;
+    build_node(pt, root, k, DIRECT_BITS, ni);
+}
+
+poptrie_table_t* sfrt_poptrie_new(table_flat_t* table)
+{
+    if ( !table or !table->rt )
+        return nullptr;
+
+    poptrie_table_t* pt = new poptrie_table_t;
+    pt->base = (const uint8_t*)table;
+    pt->data = (const INFO*)(pt->base + table->data);
+
+    Key k;
+    memset(&k, 0, sizeof(k));
+
+    const dir_table_flat_t* rt = (const dir_table_flat_t*)(pt->base + table->rt);
+    pt->tbl24 = (uint32_t*)snort_calloc(TBL24_SIZE, sizeof(uint32_t));
+    k.size = 32;
+    build_tbl24(pt, rt->sub_table, k, 0);
+
+    pt->direct.assign(1 << DIRECT_BITS, EXTENDED);
+
+    if ( table->rt6 )
+    {
+        const dir_table_flat_t* rt6 = (const dir_table_flat_t*)(pt->base + table->rt6);
+        k.size = 128;
+        build_direct(pt, rt6->sub_table, k, 0);
+    }
+    return pt;
+}
+
+void sfrt_poptrie_free(poptrie_table_t* pt)
+{
+    if ( !pt )
+        return;
+
+    snort_free(pt->tbl24);
+    delete pt;
+}
+
+size_t sfrt_poptrie_usage(const poptrie_table_t* pt)
+{
+    return sizeof(*pt) + TBL24_SIZE * sizeof(uint32_t) +
+        pt->tbl8.capacity() * sizeof(uint32_t) +
+        pt->direct.capacity() * sizeof(uint32_t) +
+        pt->nodes.capacity() * sizeof(PoptrieNode) +
+        pt->leaves.capacity() * sizeof(uint32_t);
+}
+
+//-------------------------------------------------------------------------
+// lookup
+//-------------------------------------------------------------------------
+
+static inline uint64_t load_be64(const uint8_t* p)
+{
+    uint64_t v = 0;
+
+    for ( int i = 0; i < 8; ++i )
+        v = (v << 8) | p[i];
+
+    return v;
+}
+
+// STRIDE bits of the 128 bit key hi:lo at pos, zero padded
+static inline uint32_t stride_bits(uint64_t hi, uint64_t lo, unsigned pos)
+{
+    if ( pos + STRIDE <= 64 )
+        return (hi >> (64 - STRIDE - pos)) & ((1 << STRIDE) - 1);
+
+    if ( pos >= 64 )
+    {
+        pos -= 64;
+
+        if ( pos + STRIDE <= 64 )
+            return (lo >> (64 - STRIDE - pos)) & ((1 << STRIDE) - 1);
+
+        return (lo << (pos + STRIDE - 64)) & ((1 << STRIDE) - 1);
+    }
+    return ((hi << (pos + STRIDE - 64)) | (lo >> (128 - STRIDE - pos))) & ((1 << STRIDE) - 1);
+}
+
+static inline uint64_t below(uint32_t i)
+{ return ((uint64_t)2 << i) - 1; }
+
+static inline GENERIC get_data(const poptrie_table_t* pt, uint32_t index)
+{
+    INFO info = pt->data[index];
+    return info ? (GENERIC)(pt->base + info) : nullptr;
+}
+
+static inline uint32_t first4(const sfip_t* ip, const poptrie_table_t* pt)
+{ return pt->tbl24[(ip->ip8[0] << 16) | (ip->ip8[1] << 8) | ip->ip8[2]]; }
+
+static inline uint32_t next4(const sfip_t* ip, const poptrie_table_t* pt, uint32_t e)
+{
+    if ( e & EXTENDED )
+        e = pt->tbl8[((e & ~EXTENDED) << 8) | ip->ip8[3]];
+
+    return e;
+}
+
+static inline uint32_t first6(const sfip_t* ip, const poptrie_table_t* pt)
+{ return pt->direct[(ip->ip8[0] << 8) | ip->ip8[1]]; }
+
+static inline uint32_t next6(const sfip_t* ip, const poptrie_table_t* pt, uint32_t d)
+{
+    if ( d & EXTENDED )
+        return d & ~EXTENDED;
+
+    uint64_t hi = load_be64(ip->ip8);
+    uint64_t lo = load_be64(ip->ip8 + 8);
+    const PoptrieNode* n = &pt->nodes[d];
+    unsigned pos = DIRECT_BITS;
+
+    while ( true )
+    {
+        uint32_t i = stride_bits(hi, lo, pos);
+
+        if ( !(n->vector & ((uint64_t)1 << i)) )
+            return pt->leaves[n->base0 + __builtin_popcountll(n->leafvec & below(i)) - 1];
+
+        n = &pt->nodes[n->base1 + __builtin_popcountll(n->vector & below(i)) - 1];
+        pos += STRIDE;
+    }
+}
+
+GENERIC sfrt_poptrie_lookup(const sfip_t* ip, const poptrie_table_t* pt)
+{
+    if ( ip->family == AF_INET )
+        return get_data(pt, next4(ip, pt, first4(ip, pt)));
+
+    if ( ip->family == AF_INET6 )
+        return get_data(pt, next6(ip, pt, first6(ip, pt)));
+
+    return nullptr;
+}
+
+#define BATCH_MAX 16
+
+void sfrt_poptrie_lookup_batch(
+    const sfip_t* const* ips, GENERIC* results, unsigned n, const poptrie_table_t* pt)
+{
+    uint32_t first[BATCH_MAX];
+
+    while ( n )
+    {
+        unsigned m = n < BATCH_MAX ? n : BATCH_MAX;
+
+        // issue the independent first level loads of all addresses
+        // before following any of them
+        for ( unsigned i = 0; i < m; ++i )
+        {
+            if ( ips[i]->family == AF_INET )
+                first[i] = first4(ips[i], pt);
+
+            else if ( ips[i]->family == AF_INET6 )
+                first[i] = first6(ips[i], pt);
+        }
+
+        for ( unsigned i = 0; i < m; ++i )
+        {
+            if ( ips[i]->family == AF_INET )
+                results[i] = get_data(pt, next4(ips[i], pt, first[i]));
+
+            else if ( ips[i]->family == AF_INET6 )
+                results[i] = get_data(pt, next6(ips[i], pt, first[i]));
+
+            else
+                results[i] = nullptr;
+        }
+        ips += m;
+        results += m;
+        n -= m;
+    }
+}
+
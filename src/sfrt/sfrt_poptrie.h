@@ -0,0 +1,52 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// sfrt_poptrie.h
+
+#ifndef SFRT_POPTRIE_H
+#define SFRT_POPTRIE_H
+
+// Read only lookup structure compiled from a flat table.  IPv4 uses a
+// DIR-24-8 array (one or two memory references per lookup) and IPv6 uses
+// a 16 bit direct index followed by poptrie nodes with 6 bit strides whose
+// children and leaves are compressed with bitmaps and found with popcount.
+//
+// The poptrie maps addresses to the same data table entries as the flat
+// table it was compiled from, so lookups return exactly what
+// sfrt_flat_dir8x_lookup() would.  It must be rebuilt if the flat table
+// changes.  Like sfrt_flat_dir8x_lookup(), the flat table must be at the
+// start of its segment.
+
+#include "sfrt/sfrt_flat.h"
+
+struct poptrie_table_t;
+
+poptrie_table_t* sfrt_poptrie_new(table_flat_t*);
+void sfrt_poptrie_free(poptrie_table_t*);
+
+GENERIC sfrt_poptrie_lookup(const sfip_t*, const poptrie_table_t*);
+
+// resolves n addresses at once, overlapping the memory references of
+// the individual lookups
+void sfrt_poptrie_lookup_batch(
+    const sfip_t* const* ips, GENERIC* results, unsigned n, const poptrie_table_t*);
+
+// bytes allocated for the poptrie, not including the flat table
+size_t sfrt_poptrie_usage(const poptrie_table_t*);
+
+#endif
+
@@ -28,8 +28,15 @@
 #include "utils/util.h"
 
 #include "sfrt/sfrt.h"
+#include "sfrt/sfrt_flat.h"
+#include "sfrt/sfrt_poptrie.h"
 #include "sfip/sf_ip.h"
 
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
 #define NUM_IPS 32
 #define NUM_DATA 4
 
@@ -264,3 +271,225 @@ TEST_CASE("sfrt", "[sfrt]")
     }
 }
 
+
+//---------------------------------------------------------------
+// poptrie vs flat dir
+//---------------------------------------------------------------
+
+static int64_t flat_update(INFO* current, INFO new_entry, SaveDest, uint8_t*)
+{
+    *current = new_entry;
+    return 0;
+}
+
+// the flat insert takes host order words like the reputation parser
+static void flat_insert(table_flat_t* table, sfip_t ip, int value)
+{
+    for ( int i = 0; i < (ip.family == AF_INET ? 1 : 4); i++ )
+        ip.ip32[i] = ntohl(ip.ip32[i]);
+
+    MEM_OFFSET info = segment_snort_calloc(1, sizeof(int));
+    REQUIRE(info);
+    *(int*)((uint8_t*)table + info) = value;
+
+    CHECK(sfrt_flat_insert(&ip, ip.bits, info, RT_FAVOR_SPECIFIC, table, flat_update) ==
+        RT_SUCCESS);
+}
+
+static table_flat_t* flat_new(uint8_t* seg, size_t size, long entries)
+{
+    segment_meminit(seg, size);
+    table_flat_t* table = sfrt_flat_new(DIR_8x16, IPv6, entries, size >> 20);
+    REQUIRE(table);
+    REQUIRE((uint8_t*)table == seg);
+    return table;
+}
+
+static void random_ip(std::mt19937& rng, sfip_t& ip, bool v6)
+{
+    memset(&ip, 0, sizeof(ip));
+    ip.family = v6 ? AF_INET6 : AF_INET;
+    ip.bits = v6 ? 128 : 32;
+
+    for ( int i = 0; i < (v6 ? 4 : 1); i++ )
+        ip.ip32[i] = rng();
+}
+
+// random prefixes, less specific first as the notes above require
+static void random_table(table_flat_t* table, std::mt19937& rng, unsigned num,
+    unsigned v6_pct, std::vector<sfip_t>& probes)
+{
+    std::vector<sfip_t> prefixes(num);
+
+    for ( auto& ip : prefixes )
+    {
+        bool v6 = rng() % 100 < v6_pct;
+        random_ip(rng, ip, v6);
+        ip.bits = v6 ? 16 + rng() % 113 : 8 + rng() % 25;
+        probes.push_back(ip);
+    }
+    std::sort(prefixes.begin(), prefixes.end(),
+        [](const sfip_t& a, const sfip_t& b) { return a.bits < b.bits; });
+
+    int value = 0;
+
+    for ( auto& ip : prefixes )
+        flat_insert(table, ip, ++value);
+}
+
+static void check_same(table_flat_t* table, poptrie_table_t* pt, const sfip_t& ip)
+{
+    sfip_t tmp = ip;
+    GENERIC a = sfrt_flat_dir8x_lookup(&tmp, table);
+    GENERIC b = sfrt_poptrie_lookup(&ip, pt);
+    CHECK(a == b);
+}
+
+TEST_CASE("sfrt poptrie", "[sfrt]")
+{
+    const size_t size = 64 << 20;
+    uint8_t* seg = (uint8_t*)snort_calloc(size);
+    std::mt19937 rng(42);
+
+    SECTION("ip list")
+    {
+        unsigned num_entries = sizeof(ip_lists)/sizeof(ip_lists[0]);
+        table_flat_t* table = flat_new(seg, size, num_entries + 1);
+        std::vector<sfip_t> ips(num_entries);
+
+        for ( unsigned i = 0; i < num_entries; i++ )
+        {
+            sfip_pton(ip_lists[i].ip_str, &ips[i]);
+            flat_insert(table, ips[i], ip_lists[i].value);
+        }
+
+        poptrie_table_t* pt = sfrt_poptrie_new(table);
+        REQUIRE(pt);
+
+        for ( unsigned i = 0; i < num_entries; i++ )
+        {
+            GENERIC r = sfrt_poptrie_lookup(&ips[i], pt);
+            REQUIRE(r);
+            CHECK(*(int*)r == ip_lists[i].value);
+        }
+
+        sfip_t miss;
+        sfip_pton("10.1.2.3", &miss);
+        CHECK(!sfrt_poptrie_lookup(&miss, pt));
+
+        sfip_pton("ffee:ddcd::1", &miss);
+        CHECK(!sfrt_poptrie_lookup(&miss, pt));
+
+        sfrt_poptrie_free(pt);
+    }
+
+    SECTION("random")
+    {
+        std::vector<sfip_t> probes;
+        table_flat_t* table = flat_new(seg, size, 4001);
+        random_table(table, rng, 4000, 50, probes);
+
+        poptrie_table_t* pt = sfrt_poptrie_new(table);
+        REQUIRE(pt);
+
+        // inside and at the edges of each prefix and elsewhere
+        for ( auto& ip : probes )
+        {
+            sfip_t tmp = ip;
+            tmp.bits = (ip.family == AF_INET) ? 32 : 128;
+            check_same(table, pt, tmp);
+
+            for ( int i = 0; i < (ip.family == AF_INET ? 1 : 4); i++ )
+                tmp.ip32[i] = ~ip.ip32[i];
+            check_same(table, pt, tmp);
+        }
+        for ( int i = 0; i < 100000; i++ )
+        {
+            sfip_t ip;
+            random_ip(rng, ip, i & 1);
+            check_same(table, pt, ip);
+        }
+
+        const sfip_t* batch[16];
+        GENERIC results[16];
+
+        for ( unsigned i = 0; i < 16; i++ )
+            batch[i] = &probes[i];
+
+        sfrt_poptrie_lookup_batch(batch, results, 16, pt);
+
+        for ( unsigned i = 0; i < 16; i++ )
+            CHECK(results[i] == sfrt_poptrie_lookup(batch[i], pt));
+
+        sfrt_poptrie_free(pt);
+    }
+
+    snort_free(seg);
+}
+
+// hidden; run with -T "[sfrt_bench]"
+TEST_CASE("sfrt poptrie benchmark", "[.][sfrt_bench]")
+{
+    const size_t size = 1024 << 20;
+    const unsigned lookups = 4000000;
+    uint8_t* seg = (uint8_t*)snort_calloc(size);
+    std::mt19937 rng(7);
+
+    for ( unsigned num : { 1000, 10000, 100000 } )
+    {
+        std::vector<sfip_t> probes;
+        table_flat_t* table = flat_new(seg, size, num + 1);
+        random_table(table, rng, num, 5, probes);
+
+        auto start = std::chrono::steady_clock::now();
+        poptrie_table_t* pt = sfrt_poptrie_new(table);
+        auto stop = std::chrono::steady_clock::now();
+        double build = std::chrono::duration<double, std::milli>(stop - start).count();
+
+        std::vector<sfip_t> ips(lookups);
+
+        for ( unsigned i = 0; i < lookups; i++ )
+        {
+            ips[i] = probes[rng() % probes.size()];
+            ips[i].bits = ips[i].family == AF_INET ? 32 : 128;
+        }
+
+        uintptr_t sink = 0;
+
+        start = std::chrono::steady_clock::now();
+        for ( auto& ip : ips )
+            sink += (uintptr_t)sfrt_flat_dir8x_lookup(&ip, table);
+        stop = std::chrono::steady_clock::now();
+        double dir = std::chrono::duration<double, std::nano>(stop - start).count() / lookups;
+
+        start = std::chrono::steady_clock::now();
+        for ( auto& ip : ips )
+            sink += (uintptr_t)sfrt_poptrie_lookup(&ip, pt);
+        stop = std::chrono::steady_clock::now();
+        double pop = std::chrono::duration<double, std::nano>(stop - start).count() / lookups;
+
+        const unsigned b = 2;
+        const sfip_t* batch[b];
+        GENERIC results[b];
+
+        start = std::chrono::steady_clock::now();
+        for ( unsigned i = 0; i + b <= lookups; i += b )
+        {
+            for ( unsigned j = 0; j < b; j++ )
+                batch[j] = &ips[i + j];
+
+            sfrt_poptrie_lookup_batch(batch, results, b, pt);
+            sink += (uintptr_t)results[0] + (uintptr_t)results[1];
+        }
+        stop = std::chrono::steady_clock::now();
+        double pair = std::chrono::duration<double, std::nano>(stop - start).count() / lookups;
+
+        printf("%6u prefixes: dir %.1f ns, poptrie %.1f ns, pairs %.1f ns; "
+            "dir %u bytes, poptrie %zu bytes, build %.0f ms\n", num, dir, pop, pair,
+            sfrt_flat_usage(table), sfrt_poptrie_usage(pt), build);
+
+        CHECK(sink);
+        sfrt_poptrie_free(pt);
+    }
+    snort_free(seg);
+}
@@ -39,6 +39,9 @@ static const Parameter name[] = \
  \
     { "idle_timeout", Parameter::PT_INT, "1:", idle, \
       "maximum inactive time before retiring session tracker" }, \
+ \
+    { "hash_table", Parameter::PT_ENUM, "zhash | clock", "zhash", \
+      "flow table with exact LRU or open addressed with approximate LRU" }, \
  \
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr } \
 }
@@ -126,6 +129,9 @@ bool StreamModule::set(const char* fqn, Value& v, SnortConfig*)
     else if ( v.is("idle_timeout") )
         fc->nominal_timeout = v.get_long();
 
+    else if ( v.is("hash_table") )
+        fc->hash_type = v.get_long() ? FlowHashType::CLOCK : FlowHashType::ZHASH;
+
     else
         return false;
 
@@ -339,11 +339,12 @@ void Stream::purge_flows()
     flow_con->purge_flows(PktType::FILE);
 }
 
-void Stream::timeout_flows(time_t cur_time)
+unsigned Stream::timeout_flows(time_t cur_time, unsigned max_flows)
 {
-    if ( flow_con )
-        // FIXIT-M batch here or loop vs looping over idle?
-        flow_con->timeout_flows(cur_time);
+    if ( !flow_con )
+        return 0;
+
+    return flow_con->timeout_flows(cur_time, max_flows);
 }
 
 void Stream::prune_flows()
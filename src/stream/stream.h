@@ -70,7 +70,7 @@ public:
     // for shutdown only
     static void purge_flows();
 
-    static void timeout_flows(time_t cur_time);
+    static unsigned timeout_flows(time_t cur_time, unsigned max_flows = 1);
     static void prune_flows();
     static bool expected_flow(Flow*, Packet*);
     static Flow* new_flow(FlowKey*);
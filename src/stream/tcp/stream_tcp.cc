@@ -25,6 +25,7 @@
 #include "stream_tcp.h"
 #include "tcp_ha.h"
 #include "tcp_module.h"
+#include "tcp_segment_pool.h"
 #include "tcp_session.h"
 
 #include "stream/flush_bucket.h"
@@ -77,6 +78,7 @@ void StreamTcp::tinit()
 {
     TcpHAManager::tinit();
     FlushBucket::set(config->footprint);
+    TcpSegmentPool::tinit((size_t)config->segment_pool << 20);
 }
 
 void StreamTcp::tterm()
@@ -133,6 +135,7 @@ static void tcp_tterm()
 {
     TcpSession::sterm();
     FlushBucket::clear();
+    TcpSegmentPool::tterm();
 }
 
 static const InspectApi tcp_api =
@@ -71,6 +71,10 @@ const PegInfo tcp_pegs[] =
     { "initializing", "number of sessions currently initializing" },
     { "established", "number of sessions currently established" },
     { "closing", "number of sessions currently closing" },
+    { "pool slabs", "segment pool slabs allocated" },
+    { "pool memory", "segment pool memory reserved" },
+    { "pool segs", "segments currently allocated from the segment pool" },
+    { "pool misses", "segments allocated from the heap because the pool was full or the segment too large" },
     { nullptr, nullptr }
 };
 
@@ -180,6 +184,9 @@ static const Parameter s_params[] =
     { "footprint", Parameter::PT_INT, "0:", "0",
       "use zero for production, non-zero for testing at given size" },
 
+    { "segment_pool", Parameter::PT_INT, "0:4095", "0",
+      "maximum megabytes per packet thread pooled for queued segments; 0 uses the heap" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -291,6 +298,9 @@ bool StreamTcpModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("footprint") )
         config->footprint = v.get_long();
 
+    else if ( v.is("segment_pool") )
+        config->segment_pool = v.get_long();
+
     else if ( v.is("ignore_any_rules") )
         config->flags |= STREAM_CONFIG_IGNORE_ANY;
 
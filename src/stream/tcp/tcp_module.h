@@ -96,6 +96,10 @@ struct TcpStats
     PegCount sessions_initializing;
     PegCount sessions_established;
     PegCount sessions_closing;
+    PegCount pool_slabs;
+    PegCount pool_memory;
+    PegCount pool_segs;
+    PegCount pool_misses;
 };
 
 extern THREAD_LOCAL struct TcpStats tcpStats;
@@ -664,6 +664,10 @@ int TcpReassembler::_flush_to_seq(uint32_t bytes, Packet* p, uint32_t pkt_flags)
         ((DAQ_PktHdr_t*)s5_pkt->pkth)->ts.tv_sec = seglist.next->tv.tv_sec;
         ((DAQ_PktHdr_t*)s5_pkt->pkth)->ts.tv_usec = seglist.next->tv.tv_usec;
 
+        // the rebuilt packet's seq is that of its first payload byte so
+        // detection can tell whether consecutive flushes are contiguous
+        ((tcp::TCPHdr*)s5_pkt->ptrs.tcph)->th_seq = htonl(seglist.next->seq);
+
         /* setup the pseudopacket payload */
         s5_pkt->dsize = 0;
         s5_pkt->data = nullptr;
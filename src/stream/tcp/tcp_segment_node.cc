@@ -21,14 +21,18 @@
 
 #include "tcp_segment_node.h"
 
+#include <new>
+
 #include "flow/flow_control.h"
 #include "protocols/packet.h"
 #include "utils/util.h"
 #include "tcp_module.h"
+#include "tcp_segment_pool.h"
 
 TcpSegmentNode::TcpSegmentNode() :
     prev(nullptr), next(nullptr), tv({ 0, 0 }), ts(0), seq(0), orig_dsize(0),
-    payload_size(0), urg_offset(0), buffered(false), data(nullptr), payload(nullptr)
+    payload_size(0), urg_offset(0), buffered(false), pool_class(TcpSegmentPool::NO_POOL),
+    data(nullptr), payload(nullptr)
 {
 }
 
@@ -52,22 +56,48 @@ TcpSegmentNode* TcpSegmentNode::init(TcpSegmentNode& tsn)
 
 TcpSegmentNode* TcpSegmentNode::init(const struct timeval& tv, const uint8_t* data, unsigned dsize)
 {
-    TcpSegmentNode* ss = new TcpSegmentNode;
-    ss->data = ( uint8_t* )snort_alloc(dsize);
+    TcpSegmentNode* ss;
+    uint8_t pool_class;
+    size_t charge = dsize;
+
+    // node and payload share one pooled block when possible
+    if ( void* block = TcpSegmentPool::allocate(sizeof(TcpSegmentNode) + dsize, pool_class) )
+    {
+        ss = new (block) TcpSegmentNode;
+        ss->pool_class = pool_class;
+        ss->data = (uint8_t*)(ss + 1);
+        charge = TcpSegmentPool::block_size(pool_class);
+    }
+    else
+    {
+        ss = new TcpSegmentNode;
+        ss->data = ( uint8_t* )snort_alloc(dsize);
+    }
+
     ss->payload = ss->data;
     ss->tv = tv;
     memcpy(ss->payload, data, dsize);
     ss->orig_dsize = dsize;
     ss->payload_size = ss->orig_dsize;
-    tcpStats.mem_in_use += dsize;
+    tcpStats.mem_in_use += charge;
     return ss;
 }
 
 void TcpSegmentNode::term()
 {
-    snort_free(data);
     tcpStats.segs_released++;
+
+    if ( pool_class != TcpSegmentPool::NO_POOL )
+    {
+        uint8_t c = pool_class;
+        tcpStats.mem_in_use -= TcpSegmentPool::block_size(c);
+        this->~TcpSegmentNode();
+        TcpSegmentPool::release(this, c);
+        return;
+    }
+
     tcpStats.mem_in_use -= orig_dsize;
+    snort_free(data);
     delete this;
 }
 
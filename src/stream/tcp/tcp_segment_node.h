@@ -57,6 +57,7 @@ public:
     uint16_t payload_size;
     uint16_t urg_offset;
     bool buffered;
+    uint8_t pool_class;
 
     uint8_t* data;
     uint8_t* payload;
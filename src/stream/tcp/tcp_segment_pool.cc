@@ -0,0 +1,282 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// tcp_segment_pool.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "tcp_segment_pool.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "main/thread.h"
+#include "memory/memory_cap.h"
+#include "tcp_module.h"
+
+//-------------------------------------------------------------------------
+// private stuff
+//-------------------------------------------------------------------------
+
+// block sizes include the TcpSegmentNode header; the largest covers a
+// jumbo frame
+static const unsigned s_class_size[] = { 256, 512, 1024, 2048, 4096, 10240 };
+static const unsigned NUM_CLASSES = sizeof(s_class_size) / sizeof(s_class_size[0]);
+
+// slabs are aligned to their size so a block finds its slab by masking
+static const size_t SLAB_SIZE = 256 * 1024;
+static const size_t SLAB_HEADER = 64;
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+// a slab is carved into blocks of one class while any of them are in use.
+// once all are released it goes back to the empty list and can be carved
+// for any class.
+struct Slab
+{
+    Slab* prev;
+    Slab* next;
+    FreeBlock* free_list;
+    unsigned size_class;
+    unsigned in_use;
+};
+
+static_assert(sizeof(Slab) <= SLAB_HEADER, "slab header too large");
+
+struct SlabList
+{
+    Slab* head = nullptr;
+
+    void push(Slab*);
+    void remove(Slab*);
+};
+
+void SlabList::push(Slab* s)
+{
+    s->prev = nullptr;
+    s->next = head;
+
+    if ( head )
+        head->prev = s;
+
+    head = s;
+}
+
+void SlabList::remove(Slab* s)
+{
+    if ( s->prev )
+        s->prev->next = s->next;
+    else
+        head = s->next;
+
+    if ( s->next )
+        s->next->prev = s->prev;
+}
+
+struct SegmentPool
+{
+    SlabList partial[NUM_CLASSES];  // carved slabs with free blocks
+    SlabList empty;                 // slabs with no blocks in use
+    size_t max_bytes = 0;
+    size_t reserved = 0;
+    size_t in_use = 0;
+
+    bool grow();
+    void trim();
+    void carve(Slab*, unsigned c);
+    ~SegmentPool();
+};
+
+static THREAD_LOCAL SegmentPool* s_pool = nullptr;
+
+bool SegmentPool::grow()
+{
+    if ( reserved + SLAB_SIZE > max_bytes )
+        return false;
+
+    if ( !memory::MemoryCap::free_space(SLAB_SIZE) )
+        return false;
+
+    void* p;
+
+    if ( posix_memalign(&p, SLAB_SIZE, SLAB_SIZE) )
+        return false;
+
+    memory::MemoryCap::update_allocations(SLAB_SIZE);
+    reserved += SLAB_SIZE;
+    empty.push((Slab*)p);
+
+    tcpStats.pool_slabs++;
+    tcpStats.pool_memory += SLAB_SIZE;
+    return true;
+}
+
+// release empty slabs beyond a reduced cap
+void SegmentPool::trim()
+{
+    while ( reserved > max_bytes and empty.head )
+    {
+        Slab* s = empty.head;
+        empty.remove(s);
+        free(s);
+
+        memory::MemoryCap::update_deallocations(SLAB_SIZE);
+        reserved -= SLAB_SIZE;
+        tcpStats.pool_memory -= SLAB_SIZE;
+    }
+}
+
+void SegmentPool::carve(Slab* s, unsigned c)
+{
+    const unsigned size = s_class_size[c];
+    uint8_t* base = (uint8_t*)s;
+
+    s->free_list = nullptr;
+    s->size_class = c;
+    s->in_use = 0;
+
+    for ( size_t off = SLAB_HEADER; off + size <= SLAB_SIZE; off += size )
+    {
+        FreeBlock* fb = (FreeBlock*)(base + off);
+        fb->next = s->free_list;
+        s->free_list = fb;
+    }
+    partial[c].push(s);
+}
+
+SegmentPool::~SegmentPool()
+{
+    assert(!in_use);
+    max_bytes = 0;
+    trim();
+}
+
+//-------------------------------------------------------------------------
+// public stuff
+//-------------------------------------------------------------------------
+
+// the configured size is reserved up front so that allocation doesn't
+// depend on what else the thread has allocated in the meantime
+void TcpSegmentPool::tinit(size_t max_bytes)
+{
+    // on reload the pool is kept since queued segments may still use it
+    if ( !max_bytes and !s_pool )
+        return;
+
+    if ( !s_pool )
+        s_pool = new SegmentPool;
+
+    s_pool->max_bytes = max_bytes;
+    s_pool->trim();
+
+    while ( s_pool->grow() );
+}
+
+// segments are still queued if flows were not purged (dirty pig) so the
+// slabs are left for process exit in that case
+void TcpSegmentPool::tterm()
+{
+    if ( s_pool and s_pool->in_use )
+        return;
+
+    delete s_pool;
+    s_pool = nullptr;
+}
+
+void* TcpSegmentPool::allocate(size_t n, uint8_t& size_class)
+{
+    size_class = NO_POOL;
+
+    // a reload may have disabled the pool while segments are still queued
+    if ( !s_pool or !s_pool->max_bytes )
+        return nullptr;
+
+    unsigned c = 0;
+
+    while ( c < NUM_CLASSES and s_class_size[c] < n )
+        ++c;
+
+    if ( c == NUM_CLASSES )
+    {
+        tcpStats.pool_misses++;
+        return nullptr;
+    }
+
+    Slab* s = s_pool->partial[c].head;
+
+    if ( !s )
+    {
+        if ( !s_pool->empty.head and !s_pool->grow() )
+        {
+            tcpStats.pool_misses++;
+            return nullptr;
+        }
+        s = s_pool->empty.head;
+        s_pool->empty.remove(s);
+        s_pool->carve(s, c);
+    }
+
+    FreeBlock* fb = s->free_list;
+    s->free_list = fb->next;
+    s->in_use++;
+
+    if ( !s->free_list )
+        s_pool->partial[c].remove(s);
+
+    size_class = c;
+    s_pool->in_use++;
+    tcpStats.pool_segs++;
+    return fb;
+}
+
+void TcpSegmentPool::release(void* p, uint8_t size_class)
+{
+    assert(s_pool and size_class < NUM_CLASSES);
+
+    Slab* s = (Slab*)((uintptr_t)p & ~(uintptr_t)(SLAB_SIZE - 1));
+    assert(s->size_class == size_class and s->in_use);
+
+    FreeBlock* fb = (FreeBlock*)p;
+
+    if ( !s->free_list )
+        s_pool->partial[size_class].push(s);
+
+    fb->next = s->free_list;
+    s->free_list = fb;
+
+    if ( !--s->in_use )
+    {
+        s_pool->partial[size_class].remove(s);
+        s_pool->empty.push(s);
+        s_pool->trim();
+    }
+
+    s_pool->in_use--;
+    tcpStats.pool_segs--;
+}
+
+size_t TcpSegmentPool::block_size(uint8_t size_class)
+{
+    assert(size_class < NUM_CLASSES);
+    return s_class_size[size_class];
+}
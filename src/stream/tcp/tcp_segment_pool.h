@@ -0,0 +1,52 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// tcp_segment_pool.h
+
+#ifndef TCP_SEGMENT_POOL_H
+#define TCP_SEGMENT_POOL_H
+
+// TcpSegmentPool is a per packet thread allocator for queued segments.
+// each block holds a TcpSegmentNode followed by its payload and comes from
+// a size class free list carved out of fixed size slabs.  the configured
+// size is reserved when the thread starts and a slab whose blocks are all
+// released can be carved again for any class, so steady state allocation
+// is a list pop.  requests too large for a class or beyond the configured
+// cap return null and the caller falls back to the heap.
+
+#include <cstddef>
+#include <cstdint>
+
+class TcpSegmentPool
+{
+public:
+    static const uint8_t NO_POOL = 0xff;
+
+    // max_bytes == 0 disables the pool for this thread
+    static void tinit(size_t max_bytes);
+    static void tterm();
+
+    static void* allocate(size_t, uint8_t& size_class);
+    static void release(void*, uint8_t size_class);
+
+    // bytes charged for a block of the given class
+    static size_t block_size(uint8_t size_class);
+};
+
+#endif
+
@@ -56,6 +56,9 @@ void TcpStreamConfig::show_config(TcpStreamConfig* config)
         LogMessage("    Maximum number of segs to queue per session: %d\n",
             config->max_queued_segs);
 
+    if ( config->segment_pool != 0 )
+        LogMessage("    Segment pool per packet thread: %u MB\n", config->segment_pool);
+
     if ( config->flags )
     {
         LogMessage("    Options:\n");
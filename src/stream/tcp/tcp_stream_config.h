@@ -79,6 +79,7 @@ public:
 
     int hs_timeout = -1;
     int footprint = 0;
+    uint32_t segment_pool = 0;
     uint32_t paf_max = 16384;
 };
 
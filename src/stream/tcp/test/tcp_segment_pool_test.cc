@@ -0,0 +1,191 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016-2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// tcp_segment_pool_test.cc
+// unit test main
+
+#include "stream/tcp/tcp_segment_pool.h"
+#include "stream/tcp/tcp_module.h"
+#include "memory/memory_cap.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+THREAD_LOCAL TcpStats tcpStats;
+
+static bool s_mem_ok = true;
+static size_t s_mem_used = 0;
+
+bool memory::MemoryCap::free_space(size_t)
+{ return s_mem_ok; }
+
+void memory::MemoryCap::update_allocations(size_t n)
+{ s_mem_used += n; }
+
+void memory::MemoryCap::update_deallocations(size_t n)
+{ s_mem_used -= n; }
+
+static const size_t SLAB = 256 * 1024;
+
+TEST_GROUP(tcp_segment_pool)
+{
+    void setup()
+    {
+        memset(&tcpStats, 0, sizeof(tcpStats));
+        s_mem_ok = true;
+    }
+
+    void teardown()
+    {
+        TcpSegmentPool::tterm();
+        CHECK(s_mem_used == 0);
+    }
+};
+
+TEST(tcp_segment_pool, reserve_at_tinit)
+{
+    TcpSegmentPool::tinit(4 * SLAB);
+    CHECK(tcpStats.pool_slabs == 4);
+    CHECK(tcpStats.pool_memory == 4 * SLAB);
+    CHECK(s_mem_used == 4 * SLAB);
+}
+
+TEST(tcp_segment_pool, allocate_release)
+{
+    TcpSegmentPool::tinit(SLAB);
+    uint8_t c;
+
+    void* p = TcpSegmentPool::allocate(100, c);
+    CHECK(p != nullptr);
+    CHECK(c == 0);
+    CHECK(TcpSegmentPool::block_size(c) == 256);
+    CHECK(tcpStats.pool_segs == 1);
+    memset(p, 0, 256);
+
+    TcpSegmentPool::release(p, c);
+    CHECK(tcpStats.pool_segs == 0);
+
+    // the released block is reused
+    CHECK(TcpSegmentPool::allocate(200, c) == p);
+    TcpSegmentPool::release(p, c);
+}
+
+TEST(tcp_segment_pool, class_selection)
+{
+    TcpSegmentPool::tinit(4 * SLAB);
+    const size_t sizes[] = { 1, 256, 257, 1500, 4096, 9000, 10240 };
+    const unsigned classes[] = { 0, 0, 1, 3, 4, 5, 5 };
+
+    for ( unsigned i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i )
+    {
+        uint8_t c;
+        void* p = TcpSegmentPool::allocate(sizes[i], c);
+        CHECK(p != nullptr);
+        CHECK(c == classes[i]);
+        CHECK(TcpSegmentPool::block_size(c) >= sizes[i]);
+        TcpSegmentPool::release(p, c);
+    }
+
+    // too big for any class
+    uint8_t c;
+    CHECK(TcpSegmentPool::allocate(10241, c) == nullptr);
+    CHECK(c == TcpSegmentPool::NO_POOL);
+    CHECK(tcpStats.pool_misses == 1);
+}
+
+TEST(tcp_segment_pool, cap)
+{
+    TcpSegmentPool::tinit(SLAB);
+    std::vector<void*> blocks;
+    uint8_t c;
+
+    while ( void* p = TcpSegmentPool::allocate(256, c) )
+        blocks.push_back(p);
+
+    CHECK(blocks.size() == (SLAB - 64) / 256);
+    CHECK(tcpStats.pool_slabs == 1);
+    CHECK(tcpStats.pool_misses == 1);
+
+    // the only slab is carved for the small class
+    CHECK(TcpSegmentPool::allocate(1000, c) == nullptr);
+    CHECK(tcpStats.pool_misses == 2);
+
+    for ( auto* p : blocks )
+        TcpSegmentPool::release(p, 0);
+
+    // once empty it can be carved for another class
+    void* p = TcpSegmentPool::allocate(1000, c);
+    CHECK(p != nullptr);
+    CHECK(c == 2);
+    TcpSegmentPool::release(p, c);
+    CHECK(tcpStats.pool_slabs == 1);
+}
+
+TEST(tcp_segment_pool, heap_fallback)
+{
+    TcpSegmentPool::tinit(0);
+    uint8_t c;
+
+    CHECK(TcpSegmentPool::allocate(100, c) == nullptr);
+    CHECK(c == TcpSegmentPool::NO_POOL);
+    CHECK(s_mem_used == 0);
+}
+
+TEST(tcp_segment_pool, memcap)
+{
+    s_mem_ok = false;
+    TcpSegmentPool::tinit(SLAB);
+    CHECK(tcpStats.pool_slabs == 0);
+
+    uint8_t c;
+    CHECK(TcpSegmentPool::allocate(100, c) == nullptr);
+    CHECK(c == TcpSegmentPool::NO_POOL);
+    CHECK(tcpStats.pool_misses == 1);
+
+    // reserved later once there is room
+    s_mem_ok = true;
+    void* p = TcpSegmentPool::allocate(100, c);
+    CHECK(p != nullptr);
+    CHECK(tcpStats.pool_slabs == 1);
+    TcpSegmentPool::release(p, c);
+}
+
+TEST(tcp_segment_pool, reload_shrinks)
+{
+    TcpSegmentPool::tinit(2 * SLAB);
+    uint8_t c;
+    void* p = TcpSegmentPool::allocate(100, c);
+
+    // the slab in use is kept until released
+    TcpSegmentPool::tinit(0);
+    CHECK(tcpStats.pool_memory == SLAB);
+    CHECK(TcpSegmentPool::allocate(100, c) == nullptr);
+
+    TcpSegmentPool::release(p, 0);
+    CHECK(tcpStats.pool_memory == 0);
+    CHECK(s_mem_used == 0);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
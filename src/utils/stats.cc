@@ -23,6 +23,8 @@
 #include "config.h"
 #endif
 
+#include <algorithm>
+
 #include "util.h"
 #include "main/snort_config.h"
 #include "helpers/process.h"
@@ -183,6 +185,9 @@ const PegInfo daq_names[] =
     { "internal whitelist", "packets whitelisted internally due to lack of DAQ support" },
     { "skipped", "packets skipped at startup" },
     { "idle", "attempts to acquire from DAQ without available packets" },
+    { "batches", "non-empty packet batches acquired from DAQ" },
+    { "idle slices", "housekeeping slices run while packets were available" },
+    { "idle slice usecs", "total time spent in housekeeping slices" },
     { nullptr, nullptr }
 };
 
@@ -198,6 +203,11 @@ const PegInfo pc_names[] =
     { "header searches", "fast pattern searches in header buffer" },
     { "body searches", "fast pattern searches in body buffer" },
     { "file searches", "fast pattern searches in file buffer" },
+    { "stream searches", "fast pattern searches resumed from prior reassembled data" },
+    { "stream restarts", "fast pattern streams restarted by noncontiguous reassembled data" },
+    { "stream memory", "peak bytes of fast pattern stream state on any packet thread" },
+    { "batch searches", "fast pattern searches of multiple buffers at once" },
+    { "header screens", "non-fast pattern rule classes skipped by header options" },
     { "alerts", "alerts not including IP reputation" },
     { "total alerts", "alerts including IP reputation" },
     { "logged", "logged packets" },
@@ -245,7 +255,10 @@ void pc_sum()
 
 void pc_accum()
 {
+    // stream memory is a per thread peak so keep the largest, not the sum
+    PegCount stream_memory = std::max(gpc.stream_memory, pc.stream_memory);
     sum_stats((PegCount*)&gpc, (PegCount*)&pc, array_size(pc_names)-1);
+    gpc.stream_memory = stream_memory;
 }
 
 //-------------------------------------------------------------------------
@@ -276,6 +289,9 @@ void get_daq_stats(DAQStats& daq_stats)
     daq_stats.internal_whitelist = gaux.internal_whitelist;
     daq_stats.skipped = snort_conf->pkt_skip;
     daq_stats.idle = gaux.idle;
+    daq_stats.batches = gaux.batches;
+    daq_stats.idle_slices = gaux.idle_slices;
+    daq_stats.idle_slice_usecs = gaux.idle_slice_usecs;
 }
 
 void DropStats()
@@ -50,6 +50,11 @@ struct PacketCount
     PegCount header_searches;
     PegCount body_searches;
     PegCount file_searches;
+    PegCount stream_searches;
+    PegCount stream_restarts;
+    PegCount stream_memory;
+    PegCount batch_searches;
+    PegCount header_screens;
     PegCount alert_pkts;
     PegCount total_alert_pkts;
     PegCount log_pkts;
@@ -76,6 +81,9 @@ struct AuxCount
     PegCount internal_blacklist;
     PegCount internal_whitelist;
     PegCount idle;
+    PegCount batches;
+    PegCount idle_slices;
+    PegCount idle_slice_usecs;
 };
 
 //-------------------------------------------------------------------------
@@ -100,6 +108,9 @@ struct DAQStats
     PegCount internal_whitelist;
     PegCount skipped;
     PegCount idle;
+    PegCount batches;
+    PegCount idle_slices;
+    PegCount idle_slice_usecs;
 };
 
 extern ProcessCount proc_stats;